@@ -0,0 +1,27 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+
+// Minimal helpers for the on-device benchmarks in bench/ (env:bench in
+// platformio.ini). Results are printed over serial, one line per measurement.
+
+// Run fn the given number of times and return the elapsed microseconds
+template <typename Fn>
+uint32_t benchmark_us(uint32_t iterations, Fn fn) {
+  uint32_t start = micros();
+  for (uint32_t i = 0; i < iterations; i++) {
+    fn();
+  }
+  return micros() - start;
+}
+
+// Print "name: value unit"
+inline void benchmark_report(const char* name, double value, const char* unit) {
+  Serial.printf("%-40s %12.2f %s\n", name, value, unit);
+}
+
+void run_font_benchmark();
+void run_render_benchmark();
+
+#endif // BENCHMARK_H
@@ -0,0 +1,20 @@
+#include <Arduino.h>
+#include "Benchmark.h"
+
+// Entry point for env:bench; replaces src/main.cpp
+void setup() {
+  Serial.begin(115200);
+  delay(2000);
+
+  Serial.println("--- Font rendering ---");
+  run_font_benchmark();
+
+  Serial.println("--- Frame composition ---");
+  run_render_benchmark();
+
+  Serial.println("Benchmarks complete.");
+}
+
+void loop() {
+  delay(1000);
+}
@@ -0,0 +1,55 @@
+#include <Fonts/FreeSansBold12pt7b.h>
+#include "Benchmark.h"
+#include "CompactFont.h"
+#include "MonoRaster.h"
+#include "fonts/TemperatureFont48.h"
+
+// Compares the temperature text drawn with FreeSansBold12pt7b scaled by
+// setTextSize(3) (the previous path) against the generated 48 px CompactFont.
+
+#define FONT_BENCH_ITERATIONS 200
+#define FONT_BENCH_TEXT "-12.5"
+
+namespace {
+
+// Bytes a GFX font spends on the given characters: packed bitmaps plus glyph records
+size_t gfx_subset_bytes(const GFXfont& font, const char* chars) {
+  size_t bytes = 0;
+  for (const char* c = chars; *c; c++) {
+    const GFXglyph& glyph = font.glyph[*c - font.first];
+    bytes += (glyph.width * glyph.height + 7) / 8 + sizeof(GFXglyph);
+  }
+  return bytes;
+}
+
+}  // namespace
+
+void run_font_benchmark() {
+  GFXcanvas1 canvas(250, 122);
+  const size_t glyphs = strlen(FONT_BENCH_TEXT) * FONT_BENCH_ITERATIONS;
+
+  canvas.setFont(&FreeSansBold12pt7b);
+  canvas.setTextSize(3);
+  canvas.setTextColor(1);
+  uint32_t gfx_us = benchmark_us(FONT_BENCH_ITERATIONS, [&]() {
+    canvas.setCursor(16, 61);
+    canvas.print(FONT_BENCH_TEXT);
+  });
+
+  MonoRaster raster(250, 122);
+  uint32_t compact_us = benchmark_us(FONT_BENCH_ITERATIONS, [&]() {
+    CompactFontRenderer::draw_text(raster, TemperatureFont48, 16, 61, FONT_BENCH_TEXT, 1);
+  });
+
+  benchmark_report("GFX 12pt x3 glyphs/ms", glyphs * 1000.0 / gfx_us, "glyphs/ms");
+  benchmark_report("CompactFont 48px glyphs/ms", glyphs * 1000.0 / compact_us, "glyphs/ms");
+  benchmark_report("Speedup", (double)gfx_us / compact_us, "x");
+
+  // Flash: the whole GFX font is linked in, but compare the same subset too
+  size_t gfx_font = sizeof(FreeSansBold12pt7bBitmaps) + sizeof(FreeSansBold12pt7bGlyphs) + sizeof(GFXfont);
+  size_t gfx_subset = gfx_subset_bytes(FreeSansBold12pt7b, "0123456789.-");
+  size_t compact = sizeof(TemperatureFont48Data) + sizeof(TemperatureFont48Glyphs) + sizeof(CompactFont);
+  benchmark_report("GFX FreeSansBold12pt7b flash", gfx_font, "bytes");
+  benchmark_report("GFX digits subset flash", gfx_subset, "bytes");
+  benchmark_report("CompactFont 48px digits+deg flash", compact, "bytes");
+}
@@ -0,0 +1,140 @@
+#include "BenchHarness.h"
+#include <chrono>
+#include <cstdio>
+#include <malloc.h>
+
+// Allocation accounting. The malloc family is replaced for the whole process
+// and forwards to glibc's implementation, so allocations made inside the C++
+// runtime (operator new, std::string) are seen too. Sizes come from
+// malloc_usable_size, which needs no per-block header. Linux/glibc only.
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* pointer);
+}
+
+namespace {
+
+HeapStats stats = {0, 0, 0};
+
+void note_allocation(void* pointer) {
+  if (!pointer) return;
+  stats.allocations++;
+  stats.current_bytes += malloc_usable_size(pointer);
+  if (stats.current_bytes > stats.peak_bytes) {
+    stats.peak_bytes = stats.current_bytes;
+  }
+}
+
+void note_free(void* pointer) {
+  if (pointer) {
+    stats.current_bytes -= malloc_usable_size(pointer);
+  }
+}
+
+}  // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+  void* pointer = __libc_malloc(size);
+  note_allocation(pointer);
+  return pointer;
+}
+
+void* calloc(size_t count, size_t size) {
+  void* pointer = __libc_calloc(count, size);
+  note_allocation(pointer);
+  return pointer;
+}
+
+void* realloc(void* pointer, size_t size) {
+  note_free(pointer);
+  void* result = __libc_realloc(pointer, size);
+  note_allocation(result ? result : (size ? pointer : nullptr));
+  return result;
+}
+
+void* memalign(size_t alignment, size_t size) {
+  void* pointer = __libc_memalign(alignment, size);
+  note_allocation(pointer);
+  return pointer;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  return memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) {
+  *result = memalign(alignment, size);
+  return *result ? 0 : 12;  // ENOMEM
+}
+
+void free(void* pointer) {
+  note_free(pointer);
+  __libc_free(pointer);
+}
+
+}  // extern "C"
+
+HeapStats heap_stats() {
+  return stats;
+}
+
+void reset_heap_peak() {
+  stats.peak_bytes = stats.current_bytes;
+}
+
+BenchHarness::BenchHarness(const char* filter) : _filter(filter ? filter : "") {
+}
+
+void BenchHarness::run(const char* name, uint32_t iterations, const std::function<void()>& body) {
+  if (!_filter.empty() && std::string(name).find(_filter) == std::string::npos) {
+    return;
+  }
+
+  // Warm up caches and any lazily allocated state outside the measurement
+  body();
+
+  HeapStats before = heap_stats();
+  reset_heap_peak();
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < iterations; i++) {
+    body();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  HeapStats after = heap_stats();
+
+  BenchResult result;
+  result.name = name;
+  result.iterations = iterations;
+  result.time_ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+  result.allocations = (double)(after.allocations - before.allocations) / iterations;
+  result.peak_heap_bytes = after.peak_bytes - before.current_bytes;
+  _results.push_back(result);
+
+  printf("%-44s %12.0f ns %10.1f allocs %10lld B peak\n", name, result.time_ns, result.allocations,
+         (long long)result.peak_heap_bytes);
+}
+
+bool BenchHarness::write_json(const char* path) const {
+  FILE* file = fopen(path, "w");
+  if (!file) {
+    fprintf(stderr, "Cannot write %s\n", path);
+    return false;
+  }
+
+  fprintf(file, "{\n  \"benchmarks\": {\n");
+  for (size_t i = 0; i < _results.size(); i++) {
+    const BenchResult& result = _results[i];
+    fprintf(file, "    \"%s\": {\"iterations\": %u, \"time_ns\": %.1f, \"allocations\": %.2f, \"peak_heap_bytes\": %lld}%s\n",
+            result.name.c_str(), result.iterations, result.time_ns, result.allocations,
+            (long long)result.peak_heap_bytes, i + 1 < _results.size() ? "," : "");
+  }
+  fprintf(file, "  }\n}\n");
+  fclose(file);
+  return true;
+}
@@ -0,0 +1,48 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Heap activity since the process started. Every malloc family call in the
+// process is counted (see BenchHarness.cpp), including those made by the C++
+// runtime on behalf of new/delete.
+struct HeapStats {
+  uint64_t allocations;
+  int64_t current_bytes;
+  int64_t peak_bytes;
+};
+
+HeapStats heap_stats();
+
+// Raise the peak watermark to the current level so a benchmark only sees its own peak
+void reset_heap_peak();
+
+struct BenchResult {
+  std::string name;
+  uint32_t iterations;
+  double time_ns;            // Per iteration
+  double allocations;        // Per iteration
+  int64_t peak_heap_bytes;   // Above the level at the start of the benchmark
+};
+
+class BenchHarness {
+public:
+  // Only benchmarks whose name contains filter run (all if null or empty)
+  explicit BenchHarness(const char* filter = nullptr);
+
+  // Run body once to warm up, then time it for the given number of iterations
+  // and print one result line
+  void run(const char* name, uint32_t iterations, const std::function<void()>& body);
+
+  bool write_json(const char* path) const;
+
+private:
+  std::string _filter;
+  std::vector<BenchResult> _results;
+};
+
+#endif // BENCH_HARNESS_H
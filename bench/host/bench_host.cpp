@@ -0,0 +1,338 @@
+// Host benchmark suite (env:native_bench). Builds the display, websocket and
+// configuration modules against the shims in bench/host/shims and reports time,
+// heap allocations and peak heap per call. Run from the project root:
+//
+//   pio run -e native_bench -t exec -a "--json .pio/bench_results.json"
+//   python3 scripts/compare_bench.py bench/host/baseline.json .pio/bench_results.json
+//
+// Options: --json <path> writes the results, --filter <text> runs only
+// benchmarks whose name contains the text.
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <zlib.h>
+#include <ArduinoJson.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include "BenchHarness.h"
+#include "ConfigManager.h"
+#include "EPaper213MonoDisplayManager.h"
+#include "HassWebsocketManager.h"
+#include "RequestData.h"
+
+// Normally defined in src/main.cpp
+const char* DATA_TEMPERATURE = "temperature";
+const char* DATA_CONDITIONS = "conditions";
+const char* DATA_ALARM = "alarm";
+
+#define PAYLOAD_DIR "bench/host/payloads/"
+
+namespace {
+
+// Recorded Home Assistant websocket messages, in the order a wake sees them
+const char* const PAYLOADS[] = {
+  "auth_required",
+  "result_success",
+  "render_template_event",
+  "subscribe_entities_snapshot",
+  "subscribe_entities_change",
+  "trigger_event_weather",
+  "state_changed_alarm",
+};
+
+// Events and results a wake with several data points and subscriptions can
+// receive at once, replayed as a burst
+const char* const BURST_PAYLOADS[] = {
+  "result_success",
+  "render_template_event",
+  "subscribe_entities_change",
+  "trigger_event_weather",
+  "state_changed_alarm",
+};
+
+const char* const WEATHER_CONDITIONS[] = {
+  "clear-night", "cloudy", "fog", "lightning", "lightning-rainy", "partlycloudy", "pouring",
+  "rainy", "snowy", "snowy-rainy", "sunny", "windy", "windy-variant", "exceptional",
+};
+
+std::array<RequestData, 3> data_points;
+String last_event_value;
+
+String read_payload(const char* name) {
+  std::ifstream file(std::string(PAYLOAD_DIR) + name + ".json");
+  std::stringstream contents;
+  contents << file.rdbuf();
+  if (!file) {
+    fprintf(stderr, "Missing payload %s (run from the project root)\n", name);
+    exit(1);
+  }
+  return String(contents.str().c_str());
+}
+
+// Same lookups as data_callback() in main.cpp
+void data_callback(int request_id, String type, JsonObjectConst doc) {
+  if (type != "event") return;
+  String value = doc["event"]["result"] | "";
+  if (value.length() == 0) {
+    value = doc["event"]["variables"]["trigger"]["to_state"]["state"] | "";
+  }
+  last_event_value = value;
+}
+
+void error_callback(int request_id, String message) {
+}
+
+// Whether the fake server accepts permessage-deflate
+bool deflate_server = false;
+
+// Fake Home Assistant end of the loopback connection: answers the upgrade
+// request and drops the client's frames
+void fake_server(WiFiClient& client, const uint8_t* data, size_t length) {
+  std::string request(reinterpret_cast<const char*>(data), length);
+  if (request.compare(0, 4, "GET ") != 0) return;
+
+  size_t start = request.find("Sec-WebSocket-Key: ") + 19;
+  std::string key = request.substr(start, request.find("\r\n", start) - start) + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+  unsigned char digest[20], accept[29];
+  size_t accept_length;
+  mbedtls_sha1(reinterpret_cast<const unsigned char*>(key.data()), key.size(), digest);
+  mbedtls_base64_encode(accept, sizeof(accept), &accept_length, digest, sizeof(digest));
+
+  std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: " + std::string(reinterpret_cast<char*>(accept)) + "\r\n";
+  if (deflate_server) {
+    // No context takeover, so one recorded compressed frame can be replayed
+    response += "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=12; server_no_context_takeover\r\n";
+  }
+  client.deliver(response + "\r\n");
+}
+
+// A message as the server would send it, in one unmasked frame
+std::string server_frame(const String& text, bool compress) {
+  std::string payload(text.c_str(), text.length());
+  if (compress) {
+    // Raw deflate with a 4 KB window, sync flushed, without the 00 00 ff ff tail
+    z_stream stream = {};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -12, 8, Z_DEFAULT_STRATEGY);
+    std::string compressed(deflateBound(&stream, payload.size()) + 16, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(&payload[0]);
+    stream.avail_in = payload.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+    stream.avail_out = compressed.size();
+    deflate(&stream, Z_SYNC_FLUSH);
+    compressed.resize(compressed.size() - stream.avail_out - 4);
+    deflateEnd(&stream);
+    payload = compressed;
+  }
+
+  std::string frame(1, static_cast<char>(compress ? 0xC1 : 0x81));
+  if (payload.size() < 126) {
+    frame += static_cast<char>(payload.size());
+  } else if (payload.size() > 0xFFFF) {
+    frame += static_cast<char>(127);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      frame += static_cast<char>((static_cast<uint64_t>(payload.size()) >> shift) & 0xFF);
+    }
+  } else {
+    frame += static_cast<char>(126);
+    frame += static_cast<char>(payload.size() >> 8);
+    frame += static_cast<char>(payload.size() & 0xFF);
+  }
+  return frame + payload;
+}
+
+void bench_display(BenchHarness& harness) {
+  EPaper213MonoDisplayManager display;
+  display.begin();
+
+  data_points[0].name = DATA_TEMPERATURE;
+  data_points[1].name = DATA_CONDITIONS;
+  data_points[2].name = DATA_ALARM;
+  data_points[1].update_value("partlycloudy");
+  data_points[2].update_value("armed_home");
+  ConfigManager::set_string(config_manager.alarm_entity_id, "alarm_control_panel.home_alarm");
+
+  // Alternate the temperature so every frame differs and reaches the panel
+  uint32_t frame = 0;
+  harness.run("display/update_display", 200, [&]() {
+    data_points[0].update_value((frame++ & 1) ? "72.5" : "-3.4");
+    display.update_display(data_points, true, "87.0%");
+  });
+
+  harness.run("display/draw_bitmap_from_path", 500, [&]() {
+    display.draw_bitmap_from_path("/day/partly-cloudy.bmp", 176, 12);
+  });
+
+  size_t condition = 0;
+  harness.run("display/determine_weather_icon_path", 20000, [&]() {
+    String path = EPaper213MonoDisplayManager::determine_weather_icon_path(
+      WEATHER_CONDITIONS[condition++ % (sizeof(WEATHER_CONDITIONS) / sizeof(WEATHER_CONDITIONS[0]))]);
+  });
+}
+
+void connect_websocket(HassWebsocketManager& websocket) {
+  websocket.setMessageCallback(data_callback);
+  websocket.setErrorCallback(error_callback);
+  websocket.connect("ws://homeassistant.local:8123/api/websocket", "benchmark-token");
+
+  // Request ID 2 (after supported_features), matching the recorded subscribe_entities payloads
+  websocket.entity_cache().track("weather.home", "temperature");
+  websocket.entity_cache().track("weather.home");
+  websocket.entity_cache().track("alarm_control_panel.home_alarm");
+  websocket.subscribe_entities();
+
+  // Requests wait for auth_ok; release them
+  WiFiClient::last_instance()->deliver(server_frame("{\"type\":\"auth_ok\",\"ha_version\":\"2025.1.4\"}", deflate_server));
+  websocket.loop();
+}
+
+void bench_websocket(BenchHarness& harness) {
+  WiFiClient::set_peer(fake_server);
+  deflate_server = false;
+  HassWebsocketManager websocket;
+  connect_websocket(websocket);
+
+  harness.run("websocket/send_message/ping", 20000, [&]() {
+    websocket.ping();
+  });
+
+  harness.run("websocket/send_message/render_template", 20000, [&]() {
+    websocket.render_template("{{ states('sensor.outdoor_temperature') }}");
+  });
+
+  harness.run("websocket/send_message/subscribe_trigger", 20000, [&]() {
+    websocket.subscribe_to_trigger("{\"platform\": \"state\", \"entity_id\": \"alarm_control_panel.home_alarm\"}");
+  });
+
+  // Recorded messages arrive as frames and are read by loop(), plain and
+  // compressed with permessage-deflate
+  for (bool compress : { false, true }) {
+    deflate_server = compress;
+    HassWebsocketManager receiver;
+    connect_websocket(receiver);
+    WiFiClient* client = WiFiClient::last_instance();
+
+    for (const char* name : PAYLOADS) {
+      String payload = read_payload(name);
+      std::string frame = server_frame(payload, compress);
+      printf("  %s: %u bytes, %zu on the wire%s\n", name, payload.length(), frame.size(), compress ? " (deflate)" : "");
+
+      String label = String(compress ? "websocket/receive_deflate/" : "websocket/receive/") + name;
+      harness.run(label.c_str(), 20000, [&]() {
+        client->deliver(frame);
+        receiver.loop();
+      });
+    }
+
+    // The same burst as one frame per message, and coalesced into a single
+    // JSON array frame as the server sends it with coalesce_messages
+    std::string frames;
+    String coalesced = "[";
+    for (int round = 0; round < 2; round++) {
+      for (const char* name : BURST_PAYLOADS) {
+        String payload = read_payload(name);
+        frames += server_frame(payload, compress);
+        if (coalesced.length() > 1) {
+          coalesced += ",";
+        }
+        coalesced += payload;
+      }
+    }
+    coalesced += "]";
+    std::string coalesced_frame = server_frame(coalesced, compress);
+    printf("  burst: %zu bytes on the wire as separate frames, %zu coalesced%s\n",
+           frames.size(), coalesced_frame.size(), compress ? " (deflate)" : "");
+
+    harness.run(compress ? "websocket/burst_deflate/frames" : "websocket/burst/frames", 5000, [&]() {
+      client->deliver(frames);
+      receiver.loop();
+    });
+
+    harness.run(compress ? "websocket/burst_deflate/coalesced" : "websocket/burst/coalesced", 5000, [&]() {
+      client->deliver(coalesced_frame);
+      receiver.loop();
+    });
+
+    // A burst past the 16 KB single-message limit (snapshot, results and
+    // events queued together) must be taken in one frame, not closed with 1009
+    String large = "[";
+    size_t large_count = 0;
+    while (large.length() <= 16384) {
+      for (const char* name : BURST_PAYLOADS) {
+        if (large_count++ > 0) {
+          large += ",";
+        }
+        large += read_payload(name);
+      }
+    }
+    large += "]";
+    std::string large_frame = server_frame(large, compress);
+    printf("  large burst: %zu messages, %u bytes, %zu on the wire%s\n",
+           large_count, large.length(), large_frame.size(), compress ? " (deflate)" : "");
+
+    uint32_t dispatched = receiver.connection_stats().dispatched;
+    client->deliver(large_frame);
+    receiver.loop();
+    if (!receiver.available() || receiver.connection_stats().dispatched - dispatched != large_count) {
+      fprintf(stderr, "Large coalesced burst was not delivered%s\n", compress ? " (deflate)" : "");
+      exit(1);
+    }
+
+    harness.run(compress ? "websocket/burst_deflate/coalesced_large" : "websocket/burst/coalesced_large", 1000, [&]() {
+      client->deliver(large_frame);
+      receiver.loop();
+    });
+  }
+}
+
+void bench_config(BenchHarness& harness) {
+  config_manager.reset_to_defaults();
+  ConfigManager::set_string(config_manager.wifi_ssid, "benchmark-network");
+  ConfigManager::set_string(config_manager.hass_url, "homeassistant.local");
+  config_manager.save_config();
+
+  harness.run("config/save_config", 20000, [&]() {
+    config_manager.save_config();
+  });
+
+  harness.run("config/load_config", 20000, [&]() {
+    config_manager.load_config();
+  });
+
+  // Web UI round trip: export, then validate and import the same values
+  harness.run("config/json_round_trip", 5000, [&]() {
+    JsonDocument doc;
+    config_manager.to_json(doc);
+    config_manager.from_json(doc);
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const char* json_path = nullptr;
+  const char* filter = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json_path = argv[++i];
+    } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else {
+      fprintf(stderr, "Usage: %s [--json <path>] [--filter <text>]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  LittleFS.set_host_root("data");
+
+  BenchHarness harness(filter);
+  bench_display(harness);
+  bench_websocket(harness);
+  bench_config(harness);
+
+  if (json_path && !harness.write_json(json_path)) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,242 @@
+// Definitions behind bench/host/shims: clock, serial, file system, NVS, CRC,
+// SHA-1 and base64
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <SPI.h>
+#include <WiFi.h>
+#include <esp_rom_crc.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+
+HardwareSerial Serial;
+Logging Log;
+WiFiClass WiFi;
+SPIClass SPI;
+LittleFSFS LittleFS;
+
+namespace {
+
+const auto boot_time = std::chrono::steady_clock::now();
+
+// NVS contents, keyed by "namespace/key"
+std::map<std::string, std::vector<uint8_t>>& nvs() {
+  static std::map<std::string, std::vector<uint8_t>> storage;
+  return storage;
+}
+
+}  // namespace
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - boot_time).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot_time).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void yield() {}
+
+uint32_t esp_random() {
+  // Deterministic, so runs are repeatable
+  static uint32_t state = 0x12345678;
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+size_t bench_strlcpy(char* dest, const char* source, size_t size) {
+  size_t length = strlen(source);
+  if (size) {
+    size_t count = length < size - 1 ? length : size - 1;
+    memcpy(dest, source, count);
+    dest[count] = 0;
+  }
+  return length;
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buffer, uint32_t length) {
+  // Table driven, like the ROM implementation
+  static uint32_t table[256];
+  if (!table[1]) {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t value = i;
+      for (int bit = 0; bit < 8; bit++) {
+        value = (value >> 1) ^ (0xEDB88320 & -(value & 1));
+      }
+      table[i] = value;
+    }
+  }
+
+  crc = ~crc;
+  while (length--) {
+    crc = (crc >> 8) ^ table[(crc ^ *buffer++) & 0xFF];
+  }
+  return ~crc;
+}
+
+int mbedtls_sha1(const unsigned char* input, size_t length, unsigned char output[20]) {
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+  auto rotate = [](uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); };
+
+  // Message plus 0x80, zero padding and the 64-bit bit length, in 64-byte blocks
+  std::vector<uint8_t> message(input, input + length);
+  message.push_back(0x80);
+  while (message.size() % 64 != 56) message.push_back(0);
+  for (int i = 7; i >= 0; i--) message.push_back((uint64_t)length * 8 >> (i * 8));
+
+  for (size_t block = 0; block < message.size(); block += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t* p = &message[block + i * 4];
+      w[i] = (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+    }
+    for (int i = 16; i < 80; i++) w[i] = rotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+      else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+      else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+      else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+      uint32_t temp = rotate(a, 5) + f + e + k + w[i];
+      e = d; d = c; c = rotate(b, 30); b = a; a = temp;
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+  }
+
+  for (int i = 0; i < 20; i++) output[i] = h[i / 4] >> (24 - (i % 4) * 8);
+  return 0;
+}
+
+int mbedtls_base64_encode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen) {
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  *olen = (slen + 2) / 3 * 4;
+  if (dlen < *olen + 1) return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+
+  for (size_t i = 0, o = 0; i < slen; i += 3, o += 4) {
+    uint32_t group = src[i] << 16 | (i + 1 < slen ? src[i + 1] << 8 : 0) | (i + 2 < slen ? src[i + 2] : 0);
+    dst[o] = ALPHABET[group >> 18 & 63];
+    dst[o + 1] = ALPHABET[group >> 12 & 63];
+    dst[o + 2] = i + 1 < slen ? ALPHABET[group >> 6 & 63] : '=';
+    dst[o + 3] = i + 2 < slen ? ALPHABET[group & 63] : '=';
+  }
+  dst[*olen] = 0;
+  return 0;
+}
+
+// File
+
+File::File(FILE* file, const char* path) : _file(file, fclose), _name(path) {
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  return _file ? fread(buffer, 1, size, _file.get()) : 0;
+}
+
+int File::read() {
+  return _file ? fgetc(_file.get()) : -1;
+}
+
+int File::peek() {
+  if (!_file) return -1;
+  int c = fgetc(_file.get());
+  if (c != EOF) ungetc(c, _file.get());
+  return c;
+}
+
+int File::available() {
+  return _file ? (int)(size() - position()) : 0;
+}
+
+size_t File::write(uint8_t c) {
+  return _file ? fwrite(&c, 1, 1, _file.get()) : 0;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  return _file ? fwrite(buffer, 1, size, _file.get()) : 0;
+}
+
+bool File::seek(uint32_t position) {
+  return _file && fseek(_file.get(), position, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+  return _file ? ftell(_file.get()) : 0;
+}
+
+size_t File::size() const {
+  if (!_file) return 0;
+  long current = ftell(_file.get());
+  fseek(_file.get(), 0, SEEK_END);
+  long end = ftell(_file.get());
+  fseek(_file.get(), current, SEEK_SET);
+  return end;
+}
+
+// LittleFS
+
+bool LittleFSFS::exists(const char* path) {
+  FILE* file = fopen(host_path(path).c_str(), "rb");
+  if (file) fclose(file);
+  return file != nullptr;
+}
+
+File LittleFSFS::open(const char* path, const char* mode) {
+  String binary_mode = String(mode) + "b";
+  FILE* file = fopen(host_path(path).c_str(), binary_mode.c_str());
+  return file ? File(file, path) : File();
+}
+
+bool LittleFSFS::remove(const char* path) {
+  return ::remove(host_path(path).c_str()) == 0;
+}
+
+// Preferences
+
+bool Preferences::begin(const char* name, bool read_only) {
+  _namespace = name;
+  return true;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(value);
+  nvs()[std::string(_namespace.c_str()) + "/" + key].assign(bytes, bytes + length);
+  return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  auto entry = nvs().find(std::string(_namespace.c_str()) + "/" + key);
+  return entry == nvs().end() ? 0 : entry->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+  auto entry = nvs().find(std::string(_namespace.c_str()) + "/" + key);
+  if (entry == nvs().end() || entry->second.size() > length) return 0;
+  memcpy(buffer, entry->second.data(), entry->second.size());
+  return entry->second.size();
+}
+
+bool Preferences::remove(const char* key) {
+  return nvs().erase(std::string(_namespace.c_str()) + "/" + key) > 0;
+}
+
+bool Preferences::clear() {
+  std::string prefix = std::string(_namespace.c_str()) + "/";
+  for (auto entry = nvs().begin(); entry != nvs().end();) {
+    entry = entry->first.compare(0, prefix.size(), prefix) == 0 ? nvs().erase(entry) : std::next(entry);
+  }
+  return true;
+}
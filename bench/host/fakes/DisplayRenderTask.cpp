@@ -0,0 +1,75 @@
+// Synchronous DisplayRenderTask for the host benchmarks: same interface and
+// hashing as src/DisplayRenderTask.cpp, but submit() uploads on the calling
+// thread instead of handing the frame to a FreeRTOS task.
+#include "DisplayRenderTask.h"
+#include <esp_rom_crc.h>
+
+DisplayRenderTask::DisplayRenderTask(size_t frame_size, UploadFunction upload)
+  : _frame_size(frame_size), _upload(upload), _pending(nullptr), _front(nullptr),
+    _has_pending(false), _refreshing(false), _front_valid(false), _readers(0),
+    _pending_hash(0), _displayed_hash(0), _lock(nullptr), _task(nullptr),
+    _frames_rendered(0), _frames_replaced(0), _frames_skipped(0), _last_refresh_ms(0) {
+}
+
+DisplayRenderTask::~DisplayRenderTask() {
+  free(_pending);
+  free(_front);
+}
+
+bool DisplayRenderTask::begin(BaseType_t core) {
+  _pending = static_cast<uint8_t*>(malloc(_frame_size));
+  _front = static_cast<uint8_t*>(malloc(_frame_size));
+  return _pending && _front;
+}
+
+uint32_t DisplayRenderTask::frame_hash(const uint8_t* frame) const {
+  return esp_rom_crc32_le(0, frame, _frame_size);
+}
+
+bool DisplayRenderTask::submit(const uint8_t* frame) {
+  uint32_t hash = frame_hash(frame);
+  if (hash == _displayed_hash) {
+    if (!_front_valid) {
+      memcpy(_front, frame, _frame_size);
+      _front_valid = true;
+    }
+    _frames_skipped++;
+    return false;
+  }
+
+  memcpy(_front, frame, _frame_size);
+  _front_valid = true;
+  _displayed_hash = hash;
+  _upload(_front);
+  _frames_rendered++;
+  return true;
+}
+
+const uint8_t* DisplayRenderTask::acquire_displayed_frame(uint32_t& hash) {
+  if (!_front_valid) {
+    return nullptr;
+  }
+  _readers++;
+  hash = _displayed_hash;
+  return _front;
+}
+
+void DisplayRenderTask::release_displayed_frame() {
+  if (_readers > 0) {
+    _readers--;
+  }
+}
+
+bool DisplayRenderTask::wait_until_idle(uint32_t timeout_ms) {
+  return true;
+}
+
+bool DisplayRenderTask::is_busy() const {
+  return false;
+}
+
+void DisplayRenderTask::task_entry(void* arg) {
+}
+
+void DisplayRenderTask::run() {
+}
@@ -0,0 +1,30 @@
+// TlsClient for the host benchmarks: there is no mbedtls on the host, so
+// wss:// connections always fail. The websocket benchmarks use ws:// only.
+#include "TlsClient.h"
+#include <ArduinoLog.h>
+
+TlsClient::TlsClient(WiFiClient& tcp)
+  : _tcp(tcp), _context(nullptr), _pinned(false), _peer_closed(false),
+    _timeout_ms(0), _handshake_ms(0), _resumed(false) {
+  memset(_fingerprint, 0, sizeof(_fingerprint));
+}
+
+TlsClient::~TlsClient() {
+}
+
+bool TlsClient::set_fingerprint(const String& fingerprint) {
+  _pinned = fingerprint.length() > 0;
+  return true;
+}
+
+bool TlsClient::connect(const char* host, const IPAddress& address, uint16_t port, uint32_t timeout_ms) {
+  Log.errorln("TLS is not available in the host benchmarks");
+  return false;
+}
+
+size_t TlsClient::write(const uint8_t* data, size_t length) { return 0; }
+int TlsClient::read(uint8_t* buffer, size_t length) { return -1; }
+int TlsClient::available() { return 0; }
+bool TlsClient::connected() { return false; }
+void TlsClient::stop() { _tcp.stop(); }
+void TlsClient::forget_session() {}
@@ -0,0 +1,6 @@
+#ifndef BENCH_SHIM_ADAFRUIT_I2CDEVICE_H
+#define BENCH_SHIM_ADAFRUIT_I2CDEVICE_H
+
+// Included by Adafruit_GFX.h; the benchmarks only use canvases
+
+#endif // BENCH_SHIM_ADAFRUIT_I2CDEVICE_H
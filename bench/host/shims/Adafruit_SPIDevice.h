@@ -0,0 +1,6 @@
+#ifndef BENCH_SHIM_ADAFRUIT_SPIDEVICE_H
+#define BENCH_SHIM_ADAFRUIT_SPIDEVICE_H
+
+// Included by Adafruit_GFX.h; the benchmarks only use canvases
+
+#endif // BENCH_SHIM_ADAFRUIT_SPIDEVICE_H
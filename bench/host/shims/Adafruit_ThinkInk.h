@@ -0,0 +1,23 @@
+#ifndef BENCH_SHIM_ADAFRUIT_THINKINK_H
+#define BENCH_SHIM_ADAFRUIT_THINKINK_H
+
+#include <Adafruit_GFX.h>
+#include <SPI.h>
+
+#define EPD_WHITE 0
+#define EPD_BLACK 1
+
+// Panel stand-in: a 250x122 canvas in place of the SRAM-backed EPD driver.
+// Refreshes are free, so only composition and the upload copy are measured.
+class ThinkInk_213_Mono_GDEY0213B74 : public GFXcanvas1 {
+public:
+  ThinkInk_213_Mono_GDEY0213B74(int16_t dc, int16_t rst, int16_t cs, int16_t sram_cs, int16_t busy, SPIClass* spi)
+    : GFXcanvas1(250, 122) {}
+
+  void begin() {}
+  void clearBuffer() { fillScreen(EPD_WHITE); }
+  void display() {}
+  void powerDown() {}
+};
+
+#endif // BENCH_SHIM_ADAFRUIT_THINKINK_H
@@ -0,0 +1,60 @@
+#ifndef BENCH_SHIM_ARDUINO_H
+#define BENCH_SHIM_ARDUINO_H
+
+// Minimal Arduino core for the host benchmarks (env:native_bench). Only what
+// the benchmarked modules and their libraries touch is provided.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+
+#define PROGMEM
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+#define F(text) (reinterpret_cast<const __FlashStringHelper*>(text))
+
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_pointer(addr) (*(void* const*)(addr))
+#endif
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::max;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+uint32_t esp_random();
+
+// strlcpy is not in every host libc
+size_t bench_strlcpy(char* dest, const char* source, size_t size);
+#define strlcpy bench_strlcpy
+
+// Serial writes to stdout
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  operator bool() const { return true; }
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { return fwrite(buffer, 1, size, stdout); }
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // BENCH_SHIM_ARDUINO_H
@@ -0,0 +1,39 @@
+#ifndef BENCH_SHIM_ARDUINO_LOG_H
+#define BENCH_SHIM_ARDUINO_LOG_H
+
+// Logging is compiled out of the host benchmarks so results measure the code
+// itself, not serial output.
+
+#define LOG_LEVEL_SILENT 0
+#define LOG_LEVEL_FATAL 1
+#define LOG_LEVEL_ERROR 2
+#define LOG_LEVEL_WARNING 3
+#define LOG_LEVEL_INFO 4
+#define LOG_LEVEL_NOTICE 4
+#define LOG_LEVEL_TRACE 5
+#define LOG_LEVEL_VERBOSE 6
+
+class Print;
+
+class Logging {
+public:
+  void begin(int, Print*, bool = true) {}
+  template <class... Args> void fatalln(Args...) {}
+  template <class... Args> void errorln(Args...) {}
+  template <class... Args> void warningln(Args...) {}
+  template <class... Args> void infoln(Args...) {}
+  template <class... Args> void noticeln(Args...) {}
+  template <class... Args> void traceln(Args...) {}
+  template <class... Args> void verboseln(Args...) {}
+  template <class... Args> void fatal(Args...) {}
+  template <class... Args> void error(Args...) {}
+  template <class... Args> void warning(Args...) {}
+  template <class... Args> void info(Args...) {}
+  template <class... Args> void notice(Args...) {}
+  template <class... Args> void trace(Args...) {}
+  template <class... Args> void verbose(Args...) {}
+};
+
+extern Logging Log;
+
+#endif // BENCH_SHIM_ARDUINO_LOG_H
@@ -0,0 +1,39 @@
+#ifndef BENCH_SHIM_FS_H
+#define BENCH_SHIM_FS_H
+
+#include <memory>
+#include "Arduino.h"
+
+// File on the host file system; LittleFS paths are resolved under the
+// directory given to LittleFS.set_host_root() (the project's data/ folder).
+class File : public Stream {
+public:
+  File() {}
+  explicit File(FILE* file, const char* path);
+
+  explicit operator bool() const { return _file != nullptr; }
+
+  size_t read(uint8_t* buffer, size_t size);
+  int read() override;
+  int peek() override;
+  int available() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  bool seek(uint32_t position);
+  size_t position() const;
+  size_t size() const;
+  const char* name() const { return _name.c_str(); }
+  void close() { _file.reset(); }
+
+private:
+  std::shared_ptr<FILE> _file;
+  String _name;
+};
+
+namespace fs {
+typedef ::File File;
+}
+
+#endif // BENCH_SHIM_FS_H
@@ -0,0 +1,25 @@
+#ifndef BENCH_SHIM_LITTLEFS_H
+#define BENCH_SHIM_LITTLEFS_H
+
+#include "FS.h"
+
+class LittleFSFS {
+public:
+  bool begin(bool format_on_fail = false) { return true; }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  File open(const char* path, const char* mode = "r");
+  File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+  bool remove(const char* path);
+
+  // Host only: directory that stands in for the flash file system root
+  void set_host_root(const char* root) { _root = root; }
+
+private:
+  String _root = "data";
+  String host_path(const char* path) const { return _root + path; }
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // BENCH_SHIM_LITTLEFS_H
@@ -0,0 +1,22 @@
+#ifndef BENCH_SHIM_PREFERENCES_H
+#define BENCH_SHIM_PREFERENCES_H
+
+#include "Arduino.h"
+
+// NVS stand-in: namespaces and keys live in process memory
+class Preferences {
+public:
+  bool begin(const char* name, bool read_only = false);
+  void end() {}
+
+  size_t putBytes(const char* key, const void* value, size_t length);
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buffer, size_t length);
+  bool remove(const char* key);
+  bool clear();
+
+private:
+  String _namespace;
+};
+
+#endif // BENCH_SHIM_PREFERENCES_H
@@ -0,0 +1,8 @@
+#ifndef BENCH_SHIM_SPI_H
+#define BENCH_SHIM_SPI_H
+
+class SPIClass {};
+
+extern SPIClass SPI;
+
+#endif // BENCH_SHIM_SPI_H
@@ -0,0 +1,182 @@
+#ifndef BENCH_SHIM_WSTRING_H
+#define BENCH_SHIM_WSTRING_H
+
+// Host stand-in for the Arduino String class: the subset the firmware and its
+// libraries use, backed by std::string (heap behaviour is close enough for
+// counting allocations, not identical to the ESP32 core).
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+class __FlashStringHelper;
+
+class String {
+public:
+  String() {}
+  String(const char* text) : _s(text ? text : "") {}
+  String(const char* text, size_t length) : _s(text, length) {}
+  String(const String& other) = default;
+  String(String&& other) = default;
+  explicit String(char c) : _s(1, c) {}
+  explicit String(int value, unsigned char base = 10) { from_long(value, base); }
+  explicit String(unsigned int value, unsigned char base = 10) { from_unsigned(value, base); }
+  explicit String(long value, unsigned char base = 10) { from_long(value, base); }
+  explicit String(unsigned long value, unsigned char base = 10) { from_unsigned(value, base); }
+  explicit String(float value, unsigned int decimals = 2) { from_double(value, decimals); }
+  explicit String(double value, unsigned int decimals = 2) { from_double(value, decimals); }
+
+  String& operator=(const String& other) = default;
+  String& operator=(String&& other) = default;
+  String& operator=(const char* text) {
+    _s = text ? text : "";
+    return *this;
+  }
+
+  unsigned int length() const { return _s.size(); }
+  bool isEmpty() const { return _s.empty(); }
+  const char* c_str() const { return _s.c_str(); }
+  bool reserve(unsigned int size) {
+    _s.reserve(size);
+    return true;
+  }
+
+  bool concat(const String& other) {
+    _s += other._s;
+    return true;
+  }
+  bool concat(const char* text) {
+    if (!text) return false;
+    _s += text;
+    return true;
+  }
+  bool concat(const char* text, unsigned int length) {
+    if (!text) return false;
+    _s.append(text, length);
+    return true;
+  }
+  bool concat(char c) {
+    _s += c;
+    return true;
+  }
+  bool concat(int value) { return concat(String(value)); }
+  bool concat(unsigned int value) { return concat(String(value)); }
+  bool concat(long value) { return concat(String(value)); }
+  bool concat(unsigned long value) { return concat(String(value)); }
+  bool concat(double value) { return concat(String(value)); }
+
+  template <typename T>
+  String& operator+=(const T& value) {
+    concat(value);
+    return *this;
+  }
+
+  bool equals(const String& other) const { return _s == other._s; }
+  bool equals(const char* text) const { return _s == (text ? text : ""); }
+  bool operator==(const String& other) const { return equals(other); }
+  bool operator==(const char* text) const { return equals(text); }
+  bool operator!=(const String& other) const { return !equals(other); }
+  bool operator!=(const char* text) const { return !equals(text); }
+  bool operator<(const String& other) const { return _s < other._s; }
+
+  char charAt(unsigned int index) const { return index < _s.size() ? _s[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index) { return _s[index]; }
+
+  int indexOf(char c, unsigned int from = 0) const { return position(_s.find(c, from)); }
+  int indexOf(const String& text, unsigned int from = 0) const { return position(_s.find(text._s, from)); }
+  int lastIndexOf(char c) const { return position(_s.rfind(c)); }
+  bool startsWith(const String& prefix) const { return _s.compare(0, prefix._s.size(), prefix._s) == 0; }
+  bool endsWith(const String& suffix) const {
+    return _s.size() >= suffix._s.size() && _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+  }
+
+  String substring(unsigned int from) const { return from < _s.size() ? String(_s.c_str() + from) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= _s.size()) return String();
+    return String(_s.c_str() + from, std::min<size_t>(to, _s.size()) - from);
+  }
+
+  void trim() {
+    size_t start = _s.find_first_not_of(" \t\r\n");
+    size_t end = _s.find_last_not_of(" \t\r\n");
+    _s = start == std::string::npos ? std::string() : _s.substr(start, end - start + 1);
+  }
+  void toLowerCase() {
+    for (char& c : _s) c = tolower(c);
+  }
+  void replace(const String& find, const String& replacement) {
+    if (find._s.empty()) return;
+    for (size_t at = _s.find(find._s); at != std::string::npos; at = _s.find(find._s, at + replacement._s.size())) {
+      _s.replace(at, find._s.size(), replacement._s);
+    }
+  }
+
+  long toInt() const { return atol(_s.c_str()); }
+  float toFloat() const { return atof(_s.c_str()); }
+
+private:
+  std::string _s;
+
+  static int position(size_t at) { return at == std::string::npos ? -1 : (int)at; }
+
+  void from_unsigned(unsigned long value, unsigned char base) {
+    char buffer[34];
+    char* p = buffer + sizeof(buffer) - 1;
+    *p = 0;
+    do {
+      unsigned digit = value % base;
+      *--p = digit < 10 ? '0' + digit : 'a' + digit - 10;
+      value /= base;
+    } while (value);
+    _s = p;
+  }
+
+  void from_long(long value, unsigned char base) {
+    if (value < 0 && base == 10) {
+      from_unsigned(-(unsigned long)value, base);
+      _s.insert(_s.begin(), '-');
+    } else {
+      from_unsigned((unsigned long)value, base);
+    }
+  }
+
+  void from_double(double value, unsigned int decimals) {
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    _s = buffer;
+  }
+};
+
+inline String operator+(const String& a, const String& b) {
+  String result(a);
+  result.concat(b);
+  return result;
+}
+inline String operator+(const String& a, const char* b) {
+  String result(a);
+  result.concat(b);
+  return result;
+}
+inline String operator+(const char* a, const String& b) {
+  String result(a);
+  result.concat(b);
+  return result;
+}
+inline String operator+(const String& a, char b) {
+  String result(a);
+  result.concat(b);
+  return result;
+}
+inline String operator+(const String& a, int b) {
+  String result(a);
+  result.concat(b);
+  return result;
+}
+inline bool operator==(const char* a, const String& b) { return b.equals(a); }
+inline bool operator!=(const char* a, const String& b) { return !b.equals(a); }
+
+#endif // BENCH_SHIM_WSTRING_H
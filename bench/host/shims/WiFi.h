@@ -0,0 +1,103 @@
+#ifndef BENCH_SHIM_WIFI_H
+#define BENCH_SHIM_WIFI_H
+
+#include <functional>
+#include <string>
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _octets{a, b, c, d} {}
+  IPAddress(uint32_t address) { memcpy(_octets, &address, 4); }
+  operator uint32_t() const {
+    uint32_t address;
+    memcpy(&address, _octets, 4);
+    return address;
+  }
+  bool fromString(const String& text) {
+    unsigned int a, b, c, d;
+    char end;
+    if (sscanf(text.c_str(), "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+      return false;
+    }
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+  String toString() const {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", _octets[0], _octets[1], _octets[2], _octets[3]);
+    return String(buffer);
+  }
+
+private:
+  uint8_t _octets[4];
+};
+
+// Loopback stand-in for the TCP client. Bytes written go to the peer (the
+// benchmark's fake server), which answers with deliver(); read() returns the
+// delivered bytes in order.
+class WiFiClient {
+public:
+  typedef std::function<void(WiFiClient& client, const uint8_t* data, size_t length)> Peer;
+
+  int connect(const IPAddress& address, uint16_t port) { return connect(address.toString().c_str(), port); }
+  int connect(const char* host, uint16_t port) {
+    _last_instance = this;
+    _connected = true;
+    _received.clear();
+    _read_position = 0;
+    return 1;
+  }
+
+  size_t write(const uint8_t* data, size_t length) {
+    if (!_connected) return 0;
+    if (_peer) _peer(*this, data, length);
+    return length;
+  }
+
+  int available() { return _received.size() - _read_position; }
+
+  int read(uint8_t* buffer, size_t length) {
+    size_t count = std::min<size_t>(length, available());
+    memcpy(buffer, _received.data() + _read_position, count);
+    _read_position += count;
+    if (_read_position == _received.size()) {
+      _received.clear();
+      _read_position = 0;
+    }
+    return count;
+  }
+
+  uint8_t connected() { return _connected || available() > 0; }
+  void stop() { _connected = false; }
+  void setNoDelay(bool) {}
+  // No real socket behind the loopback
+  int fd() const { return -1; }
+
+  // Host only
+  static void set_peer(Peer peer) { _peer = peer; }
+  static WiFiClient* last_instance() { return _last_instance; }
+  void deliver(const uint8_t* data, size_t length) { _received.append(reinterpret_cast<const char*>(data), length); }
+  void deliver(const std::string& data) { _received.append(data); }
+
+private:
+  bool _connected = false;
+  std::string _received;
+  size_t _read_position = 0;
+  static inline Peer _peer;
+  static inline WiFiClient* _last_instance = nullptr;
+};
+
+class WiFiClass {
+public:
+  IPAddress localIP() const { return IPAddress(192, 168, 1, 123); }
+  // Every host resolves to the loopback peer
+  int hostByName(const char* host, IPAddress& address) {
+    address = IPAddress(127, 0, 0, 1);
+    return 1;
+  }
+};
+
+extern WiFiClass WiFi;
+
+#endif // BENCH_SHIM_WIFI_H
@@ -0,0 +1,9 @@
+#ifndef BENCH_SHIM_ESP_ROM_CRC_H
+#define BENCH_SHIM_ESP_ROM_CRC_H
+
+#include <cstdint>
+
+// Same result as the ROM routine (zlib CRC-32 with the running value passed in)
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buffer, uint32_t length);
+
+#endif // BENCH_SHIM_ESP_ROM_CRC_H
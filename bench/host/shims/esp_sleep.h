@@ -0,0 +1,15 @@
+#ifndef BENCH_SHIM_ESP_SLEEP_H
+#define BENCH_SHIM_ESP_SLEEP_H
+
+// The host always behaves like a cold boot
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+} esp_sleep_wakeup_cause_t;
+
+inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return ESP_SLEEP_WAKEUP_UNDEFINED; }
+
+#endif // BENCH_SHIM_ESP_SLEEP_H
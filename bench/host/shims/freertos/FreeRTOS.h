@@ -0,0 +1,18 @@
+#ifndef BENCH_SHIM_FREERTOS_H
+#define BENCH_SHIM_FREERTOS_H
+
+#include <cstdint>
+
+// Types only: the host benchmarks run single threaded and link a synchronous
+// DisplayRenderTask (bench/host/fakes) instead of the FreeRTOS one.
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void* SemaphoreHandle_t;
+typedef void* TaskHandle_t;
+
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define pdTRUE 1
+#define pdFALSE 0
+
+#endif // BENCH_SHIM_FREERTOS_H
@@ -0,0 +1,11 @@
+#ifndef BENCH_SHIM_MBEDTLS_BASE64_H
+#define BENCH_SHIM_MBEDTLS_BASE64_H
+
+#include <cstddef>
+
+#define MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL -0x002A
+
+// Same result as the mbedtls routine, including the terminating NUL
+int mbedtls_base64_encode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen);
+
+#endif // BENCH_SHIM_MBEDTLS_BASE64_H
@@ -0,0 +1,9 @@
+#ifndef BENCH_SHIM_MBEDTLS_SHA1_H
+#define BENCH_SHIM_MBEDTLS_SHA1_H
+
+#include <cstddef>
+
+// Same result as the mbedtls routine (see fakes/ArduinoShims.cpp)
+int mbedtls_sha1(const unsigned char* input, size_t length, unsigned char output[20]);
+
+#endif // BENCH_SHIM_MBEDTLS_SHA1_H
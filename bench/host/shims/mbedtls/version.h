@@ -0,0 +1,7 @@
+#ifndef BENCH_SHIM_MBEDTLS_VERSION_H
+#define BENCH_SHIM_MBEDTLS_VERSION_H
+
+// The shims follow the mbedtls 3 API
+#define MBEDTLS_VERSION_NUMBER 0x03000000
+
+#endif // BENCH_SHIM_MBEDTLS_VERSION_H
@@ -0,0 +1,88 @@
+#include <Fonts/FreeSansBold12pt7b.h>
+#include "Benchmark.h"
+#include "CompactFont.h"
+#include "MonoRaster.h"
+#include "fonts/TemperatureFont48.h"
+
+// Composes the same frame as EPaper213MonoDisplayManager::update_display()
+// (temperature, 64x64 icon, armed alarm banner, IP address and battery) on a
+// plain GFXcanvas1 and on MonoRaster. The icon comes from memory, so file
+// system reads are not part of the measurement.
+
+#define RENDER_BENCH_ITERATIONS 100
+#define RENDER_BENCH_WIDTH 250
+#define RENDER_BENCH_HEIGHT 122
+
+namespace {
+
+uint8_t icon[8 * 64];
+
+template <typename BlitFn>
+void compose(GFXcanvas1& canvas, BlitFn blit) {
+  canvas.fillScreen(0);
+  int16_t unit_x = CompactFontRenderer::draw_text(canvas, TemperatureFont48, 16, RENDER_BENCH_HEIGHT / 2,
+                                                  "72.5°", 1);
+  canvas.setCursor(unit_x, RENDER_BENCH_HEIGHT / 2);
+  canvas.setFont(&FreeSansBold12pt7b);
+  canvas.setTextSize(1);
+  canvas.setTextColor(1, 0);
+  canvas.print("F");
+
+  blit(176, 12);
+
+  canvas.fillRect(0, 88, RENDER_BENCH_WIDTH, 122 - 88, 1);
+  canvas.setTextColor(0, 1);
+  canvas.setCursor(16, 108);
+  canvas.print("ARMED - HOME");
+
+  canvas.setFont();
+  canvas.setTextColor(1, 0);
+  canvas.setCursor(16, RENDER_BENCH_HEIGHT - 9);
+  canvas.print("192.168.1.123");
+  canvas.setCursor(RENDER_BENCH_WIDTH - 40, RENDER_BENCH_HEIGHT - 9);
+  canvas.print("87%");
+}
+
+}  // namespace
+
+void run_render_benchmark() {
+  // Checkerboard of 8x8 blocks; roughly half the pixels are set, like an icon
+  for (int row = 0; row < 64; row++) {
+    for (int column = 0; column < 8; column++) {
+      icon[row * 8 + column] = ((row / 8 + column) & 1) ? 0xFF : 0x00;
+    }
+  }
+
+  GFXcanvas1 gfx(RENDER_BENCH_WIDTH, RENDER_BENCH_HEIGHT);
+  uint32_t gfx_us = benchmark_us(RENDER_BENCH_ITERATIONS, [&]() {
+    compose(gfx, [&](int16_t x, int16_t y) { gfx.drawBitmap(x, y, icon, 64, 64, 1); });
+  });
+
+  MonoRaster raster(RENDER_BENCH_WIDTH, RENDER_BENCH_HEIGHT);
+  uint32_t raster_us = benchmark_us(RENDER_BENCH_ITERATIONS, [&]() {
+    compose(raster, [&](int16_t x, int16_t y) { raster.draw_bitmap(x, y, icon, 64, 64, 1); });
+  });
+
+  // Both paths must produce the same frame
+  size_t frame_size = ((RENDER_BENCH_WIDTH + 7) / 8) * RENDER_BENCH_HEIGHT;
+  bool identical = memcmp(gfx.getBuffer(), raster.getBuffer(), frame_size) == 0;
+
+  benchmark_report("GFXcanvas1 update_display() frame", (double)gfx_us / RENDER_BENCH_ITERATIONS, "us");
+  benchmark_report("MonoRaster update_display() frame", (double)raster_us / RENDER_BENCH_ITERATIONS, "us");
+  benchmark_report("Speedup", (double)gfx_us / raster_us, "x");
+  Serial.printf("Frames identical: %s\n", identical ? "yes" : "NO");
+
+  // Rotated panels exercise the per-operation transform
+  raster.setRotation(1);
+  uint32_t rotated_us = benchmark_us(RENDER_BENCH_ITERATIONS, [&]() {
+    raster.fillRect(0, 0, RENDER_BENCH_HEIGHT, 40, 1);
+    raster.draw_bitmap(20, 60, icon, 64, 64, 1);
+  });
+  gfx.setRotation(1);
+  uint32_t rotated_gfx_us = benchmark_us(RENDER_BENCH_ITERATIONS, [&]() {
+    gfx.fillRect(0, 0, RENDER_BENCH_HEIGHT, 40, 1);
+    gfx.drawBitmap(20, 60, icon, 64, 64, 1);
+  });
+  benchmark_report("GFXcanvas1 rotated fill + icon", (double)rotated_gfx_us / RENDER_BENCH_ITERATIONS, "us");
+  benchmark_report("MonoRaster rotated fill + icon", (double)rotated_us / RENDER_BENCH_ITERATIONS, "us");
+}
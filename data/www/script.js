@@ -14,66 +14,65 @@ document.addEventListener('DOMContentLoaded', function() {
   });
 });
 
+// Field descriptions from /api/schema - the device's config schema is the
+// single source of truth for field names, types and bounds
+let configFields = [];
+
 function fetchConfig() {
-  fetch('/api/config')
-    .then(response => {
-      if (!response.ok) {
-        throw new Error('Failed to fetch configuration');
-      }
-      return response.json();
-    })
-    .then(config => {
-      // Populate form fields with current values
-      document.getElementById('wifi_ssid').value = config.wifi_ssid || '';
-      document.getElementById('wifi_password').value = config.wifi_password || '';
-      
-      document.getElementById('hass_url').value = config.hass_url || '';
-      document.getElementById('hass_token').value = config.hass_token || '';
-      
-      document.getElementById('weather_entity_id').value = config.weather_entity_id || '';
-      document.getElementById('alarm_entity_id').value = config.alarm_entity_id || '';
-      document.getElementById('temperature_unit').value = config.temperature_unit || '';
-      
-      document.getElementById('data_refresh_seconds').value = config.data_refresh_seconds || 300;
-      document.getElementById('data_wait_ms').value = config.data_wait_ms || 250;
+  Promise.all([fetchJson('/api/schema'), fetchJson('/api/config')])
+    .then(([schema, config]) => {
+      configFields = schema.fields;
       
-      document.getElementById('listen_for_events').checked = config.listen_for_events || false;
-      document.getElementById('wait_for_serial').checked = config.wait_for_serial || false;
-      
-      // Power management settings
-      document.getElementById('enable_deep_sleep').checked = config.enable_deep_sleep || false;
-      document.getElementById('sleep_duration_minutes').value = config.sleep_duration_minutes || 5;
-      document.getElementById('disable_wifi_between_updates').checked = config.disable_wifi_between_updates || false;
+      // Populate form fields with current values and apply schema bounds
+      configFields.forEach(field => {
+        const element = document.getElementById(field.name);
+        if (!element) {
+          return;
+        }
+        
+        if (field.type === 'bool') {
+          element.checked = config[field.name] || false;
+        } else if (field.type === 'int') {
+          element.min = field.min;
+          element.max = field.max;
+          element.value = config[field.name];
+        } else {
+          element.maxLength = field.max;
+          element.value = config[field.name] || '';
+        }
+      });
     })
     .catch(error => {
       showStatus('Error loading configuration: ' + error.message, false);
     });
 }
 
+function fetchJson(url) {
+  return fetch(url).then(response => {
+    if (!response.ok) {
+      throw new Error('Failed to fetch ' + url);
+    }
+    return response.json();
+  });
+}
+
 function saveConfig(restart) {
-  // Collect form data
-  const config = {
-    wifi_ssid: document.getElementById('wifi_ssid').value,
-    wifi_password: document.getElementById('wifi_password').value,
-    
-    hass_url: document.getElementById('hass_url').value,
-    hass_token: document.getElementById('hass_token').value,
-    
-    weather_entity_id: document.getElementById('weather_entity_id').value,
-    alarm_entity_id: document.getElementById('alarm_entity_id').value,
-    temperature_unit: document.getElementById('temperature_unit').value,
-    
-    data_refresh_seconds: parseInt(document.getElementById('data_refresh_seconds').value),
-    data_wait_ms: parseInt(document.getElementById('data_wait_ms').value),
-    
-    listen_for_events: document.getElementById('listen_for_events').checked,
-    wait_for_serial: document.getElementById('wait_for_serial').checked,
+  // Collect form data for every field in the schema
+  const config = {};
+  configFields.forEach(field => {
+    const element = document.getElementById(field.name);
+    if (!element) {
+      return;
+    }
     
-    // Power management settings
-    enable_deep_sleep: document.getElementById('enable_deep_sleep').checked,
-    sleep_duration_minutes: parseInt(document.getElementById('sleep_duration_minutes').value),
-    disable_wifi_between_updates: document.getElementById('disable_wifi_between_updates').checked
-  };
+    if (field.type === 'bool') {
+      config[field.name] = element.checked;
+    } else if (field.type === 'int') {
+      config[field.name] = parseInt(element.value);
+    } else {
+      config[field.name] = element.value;
+    }
+  });
   
   // Send to the server
   fetch('/api/config', {
@@ -86,7 +85,11 @@ function saveConfig(restart) {
   .then(response => response.json())
   .then(data => {
     if (data.status === 'success') {
-      showStatus('Configuration saved successfully!', true);
+      if (data.restart_required && !restart) {
+        showStatus('Configuration saved. WiFi changes take effect after a restart.', true);
+      } else {
+        showStatus('Configuration saved and applied!', true);
+      }
       
       if (restart) {
         showStatus('Restarting device...', true);
@@ -4,30 +4,42 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <DNSServer.h>
-#include <WebServer.h>
+#include <ArduinoJson.h>
 #include <ArduinoLog.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "ConfigManager.h"
 #include "DisplayManager.h"
+#include "HtmlTemplate.h"
+#include "HttpServer.h"
 
 class CaptivePortal {
 public:
   // Constructor
   CaptivePortal(ConfigManager& config_manager, DisplayManager* display);
+  ~CaptivePortal();
   
   // Start the captive portal with a custom AP name
   void begin(const String& ap_name = "EInkMonitor");
   
-  // Process DNS and web server requests (call in loop)
+  // Process DNS requests and the portal timeout (call in loop). Web requests
+  // are served on the HTTP server task.
   void handle_client();
   
-  // Check if a wifi network was configured and we should restart
-  bool should_restart() const;
+  // Check if a wifi network was configured and saved
+  bool config_saved() const;
+  
+  // Stop the DNS and web servers and shut down the access point (also done
+  // by the destructor)
+  void end();
   
 private:
   // Constants
   static const int DNS_PORT = 53;
   static const int WEB_PORT = 80;
   static const int TIMEOUT_MS = 10 * 60 * 1000; // 10 minutes timeout
+  static const int SCAN_INTERVAL_MS = 20 * 1000; // Time between background scans
+  static const int SETUP_SAVE_TIMEOUT_MS = 10 * 1000; // How long /save waits for the loop
   
   // Reference to configuration manager
   ConfigManager& _config_manager;
@@ -37,32 +49,66 @@ private:
   
   // Servers
   DNSServer _dns_server;
-  WebServer _web_server;
+  HttpServer _web_server;
   
-  // State
-  bool _restart_requested;
+  // State (set on the HTTP server task)
+  volatile bool _config_saved;
   unsigned long _portal_start_time;
+  bool _running;                 // Between begin() and end()
+  
+  // Settings posted to /save, handed to the loop under _setup_lock
+  enum SetupState : uint8_t { SETUP_NONE, SETUP_PENDING, SETUP_SAVED, SETUP_FAILED };
+  String _pending_ssid;
+  String _pending_password;
+  String _pending_hass_url;
+  String _pending_hass_token;
+  volatile SetupState _setup_state;
+  SemaphoreHandle_t _setup_lock;
+  SemaphoreHandle_t _setup_done;
+  
+  // Apply and save the posted settings (main loop, from handle_client())
+  void apply_pending_setup();
   
   // Setup routes
   void setup_routes();
   
   // Handler methods
-  void handle_root();
-  void handle_static_files();
-  void handle_save_config();
-  void handle_not_found();
+  void handle_root(HttpRequest& request);
+  void handle_save_config(HttpRequest& request);
+  void handle_not_found(HttpRequest& request);
+  void handle_get_networks(HttpRequest& request);
   
   // Helper to serve files from LittleFS
-  bool serve_file_from_fs(const String& path, const String& content_type);
+  bool serve_file_from_fs(HttpRequest& request, const String& path, const char* content_type);
+  
+  // WiFi scan results, strongest first, one entry per SSID
+  struct PortalNetwork {
+    char ssid[33];
+    int8_t rssi;
+    bool secure;
+  };
+  static const uint8_t MAX_NETWORKS = 16;
+  
+  // Helper to write the networks list HTML into the page
+  void write_networks_html(HtmlTemplate& page) const;
+  
+  // Background scanning, driven from handle_client()
+  void start_scan();
+  void update_scan();
+  void store_scan_results(int16_t found);
   
-  // Helper to generate networks list HTML
-  String generate_networks_html();
+  // Copy the current results (safe from the HTTP server task)
+  uint8_t copy_networks(PortalNetwork (&networks)[MAX_NETWORKS]) const;
   
-  // Helper to scan for available WiFi networks
-  void scan_networks();
+  // Human readable signal strength
+  static const char* signal_label(int8_t rssi);
   
-  // Store for WiFi scan results
-  String _networks_list;
+  // Latest scan results, guarded by _networks_lock
+  PortalNetwork _networks[MAX_NETWORKS];
+  uint8_t _network_count;
+  bool _scan_completed;
+  unsigned long _last_scan_time;
+  SemaphoreHandle_t _networks_lock;
 };
 
 #endif // CAPTIVE_PORTAL_H
\ No newline at end of file
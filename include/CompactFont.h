@@ -0,0 +1,48 @@
+#ifndef COMPACT_FONT_H
+#define COMPACT_FONT_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+// Run-length encoded font generated at a fixed pixel size by
+// scripts/generate_font.py. Glyph data is a sequence of row groups:
+// [row count][run count][runs...], runs alternating background and ink,
+// starting with background.
+struct CompactGlyph {
+  uint16_t offset;     // Into CompactFont::data
+  uint16_t codepoint;  // Unicode (BMP)
+  uint8_t width;
+  uint8_t height;
+  uint8_t x_advance;
+  int8_t x_offset;     // From the cursor to the left edge
+  int8_t y_offset;     // From the baseline to the top edge
+};
+
+struct CompactFont {
+  const uint8_t* data;
+  const CompactGlyph* glyphs;  // Sorted by codepoint
+  uint16_t glyph_count;
+  uint8_t y_advance;
+};
+
+// Draws CompactFont text by decoding runs straight into horizontal spans
+// (drawFastHLine), which MonoRaster fills a word at a time.
+class CompactFontRenderer {
+public:
+  // Draw UTF-8 text with its baseline at y. Returns the cursor x after the text.
+  static int16_t draw_text(Adafruit_GFX& canvas, const CompactFont& font, int16_t x, int16_t y,
+                           const char* text, uint16_t color);
+
+  // Advance width of UTF-8 text in pixels
+  static int16_t text_width(const CompactFont& font, const char* text);
+
+  // Glyph for a codepoint, or nullptr if the font does not include it
+  static const CompactGlyph* find_glyph(const CompactFont& font, uint16_t codepoint);
+
+private:
+  static void draw_glyph(Adafruit_GFX& canvas, const CompactFont& font, const CompactGlyph& glyph,
+                         int16_t x, int16_t y, uint16_t color);
+  static uint16_t next_codepoint(const char*& text);
+};
+
+#endif // COMPACT_FONT_H
@@ -5,62 +5,142 @@
 #include <ArduinoJson.h>
 #include <LittleFS.h>
 #include <ArduinoLog.h>
+#include <Preferences.h>
 
-// Default configuration file path
+// Legacy JSON configuration file, imported once into NVS if present
 #define CONFIG_FILE_PATH "/config.json"
 
-class ConfigManager {
-public:
-  // Constructor
-  ConfigManager();
-  
-  // Initialize the configuration manager
-  bool begin();
-  
-  // Save current configuration to file
-  bool save_config();
-  
-  // Load configuration from file
-  bool load_config();
-  
-  // Reset to default values
-  void reset_to_defaults();
+// NVS namespace and key holding the binary configuration record
+#define CONFIG_NVS_NAMESPACE "config"
+#define CONFIG_NVS_KEY "record"
+
+// Binary record identification. Bump CONFIG_VERSION when ConfigData changes.
+// New fields must be appended to the end of ConfigData (starting with a 4-byte
+// aligned member) so records written by older firmware still load.
+#define CONFIG_MAGIC 0x45434647  // "ECFG"
+#define CONFIG_VERSION 4
 
+// Plain-old-data configuration with fixed-capacity strings. This is the exact
+// layout stored in NVS and cached in RTC memory across deep sleep.
+struct ConfigData {
   // WiFi settings
-  String wifi_ssid;
-  String wifi_password;
-  
+  char wifi_ssid[33];
+  char wifi_password[65];
+
   // Home Assistant settings
-  String hass_url;
-  String hass_token;
-  
+  char hass_url[128];
+  char hass_token[256];
+
   // Data refresh settings
-  int data_refresh_seconds;
-  int data_wait_ms;
-  
+  int32_t data_refresh_seconds;
+  int32_t data_wait_ms;
+
   // Entity IDs
-  String weather_entity_id;
-  String alarm_entity_id;
-  String temperature_unit;
-  
+  char weather_entity_id[64];
+  char alarm_entity_id[64];
+  char temperature_unit[4];
+
   // Feature flags
-  bool listen_for_events;
+  bool listen_for_events;    // Redraw for changes pushed between refreshes
   bool wait_for_serial;
-  
+
   // Power management settings
   bool enable_deep_sleep;
-  int sleep_duration_minutes;
+  int32_t sleep_duration_minutes;
   bool disable_wifi_between_updates;
-  
+
+  // Adaptive sleep bounds (version 2)
+  int32_t sleep_min_minutes;
+  int32_t sleep_max_minutes;
+  bool adaptive_sleep;
+
+  // Connected low-power mode (version 3)
+  int32_t low_power_poll_ms;
+  bool connected_low_power;
+
+  // TLS certificate pin for wss:// (version 4)
+  alignas(4) char hass_cert_fingerprint[96];
+};
+
+// Header stored in front of ConfigData. The CRC covers the first `size` bytes of data.
+struct ConfigHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  uint32_t crc;
+};
+
+struct ConfigRecord {
+  ConfigHeader header;
+  ConfigData data;
+};
+
+class ConfigManager : public ConfigData {
+public:
+  // Constructor
+  ConfigManager();
+
+  // Initialize the configuration manager. Loads from RTC memory after a deep
+  // sleep wake, otherwise from NVS, falling back to the legacy JSON file.
+  bool begin();
+
+  // Save current configuration to NVS (and refresh the RTC copy)
+  bool save_config();
+
+  // Load configuration from NVS
+  bool load_config();
+
+  // Reset to default values
+  void reset_to_defaults();
+
+  // Export the configuration as JSON (web UI)
+  void to_json(JsonDocument& doc) const;
+
+  // Import any known fields present in a JSON document (web UI, legacy file).
+  // Values are validated against the schema bounds. Returns nullptr on success or
+  // the name of the first invalid field, in which case nothing is changed unless
+  // skip_invalid is set (invalid fields are then ignored and the rest applied).
+  const char* from_json(const JsonDocument& doc, bool skip_invalid = false);
+
+  // ConfigApplyFlags for every field that differs from `previous`
+  uint8_t changes_since(const ConfigData& previous) const;
+
+  // Describe every field (name, type, bounds) for the web UI
+  static void schema_json(JsonDocument& doc);
+
+  // Copy a string into a fixed-capacity field. Returns false if it was truncated.
+  template <size_t N>
+  static bool set_string(char (&dest)[N], const char* value) {
+    size_t length = strlcpy(dest, value ? value : "", N);
+    return length < N;
+  }
+
+  template <size_t N>
+  static bool set_string(char (&dest)[N], const String& value) {
+    return set_string(dest, value.c_str());
+  }
+
 private:
-  // Configuration file path
+  // Legacy configuration file path
   const char* _config_file_path;
-  
-  // JSON document size
-  const size_t _json_capacity = 2048;
+
+  // Fill in header and CRC for the current data
+  void build_record(ConfigRecord& record) const;
+
+  // Validate a record read from storage; `length` is the number of bytes read
+  static bool validate_record(const ConfigRecord& record, size_t length);
+
+  // Load from the copy kept in RTC memory across deep sleep
+  bool load_from_rtc();
+
+  // Refresh the RTC copy from the current values
+  void store_to_rtc() const;
+
+  // One-time import of the legacy /config.json file
+  bool import_legacy_file();
 };
 
 // Global configuration instance
 extern ConfigManager config_manager;
 
-#endif // CONFIG_MANAGER_H
\ No newline at end of file
+#endif // CONFIG_MANAGER_H
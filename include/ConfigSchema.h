@@ -0,0 +1,115 @@
+#ifndef CONFIG_SCHEMA_H
+#define CONFIG_SCHEMA_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include "ConfigManager.h"
+
+// Single description of every configuration field. Load, save, validation,
+// defaults and the web API are all driven from CONFIG_FIELDS below, so adding
+// a field means adding it to ConfigData and one line here.
+
+enum class ConfigFieldType : uint8_t {
+  String = 0,
+  Int = 1,
+  Bool = 2
+};
+
+// Maps the C++ type of a ConfigData member to its schema type at compile time
+template <typename T> struct ConfigFieldTraits;
+
+template <size_t N> struct ConfigFieldTraits<char[N]> {
+  static constexpr ConfigFieldType type = ConfigFieldType::String;
+};
+
+template <> struct ConfigFieldTraits<int32_t> {
+  static constexpr ConfigFieldType type = ConfigFieldType::Int;
+};
+
+template <> struct ConfigFieldTraits<bool> {
+  static constexpr ConfigFieldType type = ConfigFieldType::Bool;
+};
+
+// What has to happen for a changed field to take effect without a restart.
+// Fields with CONFIG_APPLY_NONE are read where they are used and apply immediately.
+enum ConfigApplyFlags : uint8_t {
+  CONFIG_APPLY_NONE = 0,
+  CONFIG_APPLY_TIMERS = 1 << 0,       // Rebuild timer intervals
+  CONFIG_APPLY_WEBSOCKET = 1 << 1,    // Reconnect the Home Assistant websocket
+  CONFIG_APPLY_DATA_POINTS = 1 << 2,  // Rebuild data point templates and re-request data
+  CONFIG_APPLY_DISPLAY = 1 << 4,      // Redraw the screen
+  CONFIG_APPLY_POWER_MODE = 1 << 5,   // Switch WiFi modem sleep and light sleep on or off
+  CONFIG_APPLY_REBOOT = 1 << 7        // Only takes effect after a restart
+};
+
+struct ConfigField {
+  const char* name;
+  ConfigFieldType type;
+  uint16_t offset;          // offsetof(ConfigData, field)
+  uint16_t size;            // Capacity including terminator for strings, sizeof for scalars
+  int32_t min_value;        // Minimum value (Int) or minimum length (String)
+  int32_t max_value;        // Maximum value (Int) or maximum length (String)
+  int32_t default_value;    // Default for Int and Bool fields
+  const char* default_text; // Default for String fields
+  uint8_t apply;            // ConfigApplyFlags needed when the value changes
+};
+
+#define CONFIG_FIELD_TYPE(field) ConfigFieldTraits<decltype(ConfigData::field)>::type
+
+#define CONFIG_STRING(field, min_length, default_text, apply) \
+  { #field, CONFIG_FIELD_TYPE(field), offsetof(ConfigData, field), sizeof(ConfigData::field), \
+    min_length, sizeof(ConfigData::field) - 1, 0, default_text, apply }
+
+#define CONFIG_INT(field, min_value, max_value, default_value, apply) \
+  { #field, CONFIG_FIELD_TYPE(field), offsetof(ConfigData, field), sizeof(ConfigData::field), \
+    min_value, max_value, default_value, nullptr, apply }
+
+#define CONFIG_BOOL(field, default_value, apply) \
+  { #field, CONFIG_FIELD_TYPE(field), offsetof(ConfigData, field), sizeof(ConfigData::field), \
+    0, 1, default_value, nullptr, apply }
+
+constexpr ConfigField CONFIG_FIELDS[] = {
+  // WiFi settings - re-associating would drop the web UI connection, so these apply on restart
+  CONFIG_STRING(wifi_ssid, 0, "", CONFIG_APPLY_REBOOT),
+  CONFIG_STRING(wifi_password, 0, "", CONFIG_APPLY_REBOOT),
+
+  // Home Assistant settings
+  CONFIG_STRING(hass_url, 1, "ws://homeassistant.local:8123/api/websocket", CONFIG_APPLY_WEBSOCKET),
+  CONFIG_STRING(hass_token, 0, "", CONFIG_APPLY_WEBSOCKET),
+
+  // Data refresh settings
+  CONFIG_INT(data_refresh_seconds, 10, 86400, 300, CONFIG_APPLY_TIMERS),
+  CONFIG_INT(data_wait_ms, 100, 60000, 250, CONFIG_APPLY_TIMERS),
+
+  // Entity IDs
+  CONFIG_STRING(weather_entity_id, 0, "weather.accuweather", CONFIG_APPLY_DATA_POINTS),
+  CONFIG_STRING(alarm_entity_id, 0, "", CONFIG_APPLY_DATA_POINTS),
+  CONFIG_STRING(temperature_unit, 0, "F", CONFIG_APPLY_DISPLAY),
+
+  // Feature flags (wait_for_serial is only consulted during boot)
+  CONFIG_BOOL(listen_for_events, true, CONFIG_APPLY_NONE),
+  CONFIG_BOOL(wait_for_serial, false, CONFIG_APPLY_NONE),
+
+  // Power management settings (enabled by default), read live by loop()
+  CONFIG_BOOL(enable_deep_sleep, true, CONFIG_APPLY_NONE),
+  CONFIG_INT(sleep_duration_minutes, 1, 60, 5, CONFIG_APPLY_NONE),
+  CONFIG_BOOL(disable_wifi_between_updates, true, CONFIG_APPLY_NONE),
+
+  // Adaptive sleep: scale sleep_duration_minutes by data volatility and battery level
+  CONFIG_INT(sleep_min_minutes, 1, 1440, 2, CONFIG_APPLY_NONE),
+  CONFIG_INT(sleep_max_minutes, 1, 1440, 60, CONFIG_APPLY_NONE),
+  CONFIG_BOOL(adaptive_sleep, true, CONFIG_APPLY_NONE),
+
+  // Connected low-power mode: stay connected with modem sleep and automatic light sleep
+  // instead of deep sleep. low_power_poll_ms bounds how long loop() may block.
+  CONFIG_INT(low_power_poll_ms, 10, 5000, 250, CONFIG_APPLY_NONE),
+  CONFIG_BOOL(connected_low_power, false, CONFIG_APPLY_POWER_MODE),
+
+  // SHA-256 of the Home Assistant certificate for wss://, hex with optional colons.
+  // Empty verifies the server against the CA certificates in /ca.pem instead.
+  CONFIG_STRING(hass_cert_fingerprint, 0, "", CONFIG_APPLY_WEBSOCKET),
+};
+
+constexpr size_t CONFIG_FIELD_COUNT = sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]);
+
+#endif // CONFIG_SCHEMA_H
@@ -22,9 +22,28 @@ public:
   // Image handling
   virtual void draw_bitmap_from_path(const char* path, int x, int y) = 0;
   
+  // Block until every submitted frame has reached the panel
+  virtual void flush() = 0;
+  
   // Power management
   virtual void sleep() = 0;
   
+  // Number of gray levels the panel can show: 2 (black and white) or 4.
+  // Layouts can use the extra levels when they are available.
+  virtual uint8_t gray_levels() const { return 2; }
+  
+  // Screen mirroring: the frame the panel currently shows and its hash. With
+  // 2 gray levels this is a 1bpp bitmap (rows padded to whole bytes, MSB
+  // first, set bit = black); with 4 it is two such bit-planes back to back,
+  // holding bit 0 and bit 1 of each pixel's level (0 = white, 3 = black).
+  // The panel is not refreshed until release_screen() is called. Returns
+  // nullptr if the contents are unknown.
+  virtual const uint8_t* acquire_screen(uint32_t& hash) { return nullptr; }
+  virtual void release_screen() {}
+  
+  int width() const { return _width; }
+  int height() const { return _height; }
+  
 protected:
   // Common display properties
   int _width;
@@ -0,0 +1,95 @@
+#ifndef DISPLAY_RENDER_TASK_H
+#define DISPLAY_RENDER_TASK_H
+
+#include <Arduino.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// Owns the physical panel on its own FreeRTOS task. The application composes
+// a frame into its own back buffer and calls submit(); the frame is copied into
+// a pending slot and the task uploads and refreshes it while the caller keeps
+// running. A submission that arrives before the task has picked up the previous
+// one replaces it, so only the newest frame ever reaches the panel. Frames are
+// identified by a CRC32 hash, and a frame identical to what the panel will end
+// up showing is dropped without a refresh.
+class DisplayRenderTask {
+public:
+  // Called on the render task to push a complete frame to the panel and refresh it
+  typedef std::function<void(const uint8_t* frame)> UploadFunction;
+
+  DisplayRenderTask(size_t frame_size, UploadFunction upload);
+  ~DisplayRenderTask();
+
+  // Allocate the frame buffers and start the task (core 0 by default, Arduino loop runs on core 1)
+  bool begin(BaseType_t core = 0);
+
+  // Queue a frame for display, replacing any frame that has not started yet.
+  // Returns false if the frame matches what the panel will show and was skipped.
+  bool submit(const uint8_t* frame);
+
+  // Hash of the frame most recently sent to the panel (0 if none)
+  uint32_t displayed_hash() const { return _displayed_hash; }
+
+  // Tell the task what the panel already shows, e.g. after waking from deep sleep
+  void set_displayed_hash(uint32_t hash) { _displayed_hash = hash; }
+
+  // Pin the frame the panel shows so another task can read it (e.g. stream it to
+  // a client). The render task does not start a new refresh until every reader
+  // has released it. Returns nullptr if the frame contents are not known yet.
+  const uint8_t* acquire_displayed_frame(uint32_t& hash);
+  void release_displayed_frame();
+
+  // Hash a frame the same way submit() does
+  uint32_t frame_hash(const uint8_t* frame) const;
+
+  // Block until no frame is pending or being refreshed. Returns false on timeout.
+  bool wait_until_idle(uint32_t timeout_ms = UINT32_MAX);
+
+  // True while a frame is pending or being refreshed
+  bool is_busy() const;
+
+  // Statistics
+  uint32_t frames_rendered() const { return _frames_rendered; }
+  uint32_t frames_replaced() const { return _frames_replaced; }
+  uint32_t frames_skipped() const { return _frames_skipped; }
+  uint32_t last_refresh_ms() const { return _last_refresh_ms; }
+
+private:
+  static void task_entry(void* arg);
+  void run();
+
+  size_t _frame_size;
+  UploadFunction _upload;
+
+  // Pending frame (submitted, not started) and front frame (owned by the task while refreshing)
+  uint8_t* _pending;
+  uint8_t* _front;
+
+  volatile bool _has_pending;
+  volatile bool _refreshing;
+
+  // _front holds the displayed frame (false until the first frame after boot)
+  bool _front_valid;
+
+  // Tasks currently reading _front via acquire_displayed_frame()
+  uint8_t _readers;
+
+  // Hashes of the pending frame and of the frame last taken by the task
+  uint32_t _pending_hash;
+  volatile uint32_t _displayed_hash;
+
+  SemaphoreHandle_t _lock;
+  TaskHandle_t _task;
+
+  volatile uint32_t _frames_rendered;
+  volatile uint32_t _frames_replaced;
+  volatile uint32_t _frames_skipped;
+  volatile uint32_t _last_refresh_ms;
+
+  static const uint32_t TASK_STACK_SIZE = 4096;
+  static const UBaseType_t TASK_PRIORITY = 1;
+};
+
+#endif // DISPLAY_RENDER_TASK_H
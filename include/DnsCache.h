@@ -0,0 +1,32 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+// Address of the Home Assistant host, kept in RTC memory across deep sleep.
+// Resolving homeassistant.local is an mDNS query, which is slow and loses
+// packets, so a wake connects straight to the cached address. The host is
+// looked up again once the entry is older than DNS_CACHE_TTL_S or when a
+// connection to the cached address fails.
+class DnsCache {
+public:
+  DnsCache();
+
+  // Address for host: IP literals as they are, otherwise the cached address
+  // while it is fresh, otherwise a new lookup
+  bool resolve(const String& host, IPAddress& address);
+
+  // Connecting to the cached address failed; the next resolve() looks it up
+  void invalidate();
+
+  // Last resolve(): time taken and whether the address came from the cache
+  uint32_t resolve_ms() const { return _resolve_ms; }
+  bool cached() const { return _cached; }
+
+private:
+  uint32_t _resolve_ms;
+  bool _cached;
+};
+
+#endif // DNS_CACHE_H
@@ -0,0 +1,78 @@
+#ifndef EPAPER_213_GRAY_DISPLAY_MANAGER_H
+#define EPAPER_213_GRAY_DISPLAY_MANAGER_H
+
+#include "DisplayManager.h"
+#include "Adafruit_ThinkInk.h"
+#include <array>
+#include "RequestData.h"
+#include "DisplayRenderTask.h"
+#include "GrayRaster.h"
+
+// ePaper Display IO details - same wiring as the 2.13" mono display
+#ifndef EPD_DC
+#define EPD_DC 10
+#define EPD_CS 9
+#define EPD_BUSY -1 // can set to -1 to not use a pin (will wait a fixed delay)
+#define EPD_SRCS 6  // SRAM select pin
+#define EPD_RST -1  // can set to -1 and share with microcontroller Reset!
+#define EPD_SPI &SPI // primary SPI
+#endif
+
+// Using data point names from main sketch
+extern const char* DATA_TEMPERATURE;
+extern const char* DATA_CONDITIONS;
+extern const char* DATA_ALARM;
+
+// Forward declaration of ConfigManager
+class ConfigManager;
+extern ConfigManager config_manager;
+
+// 2.13" ThinkInk panel in 4-level grayscale mode. Frames are composed into a
+// GrayRaster (two bit-planes, two bits per pixel) and refreshed by the render
+// task, which hands the panel one row of each level at a time.
+class EPaper213GrayDisplayManager : public DisplayManager {
+public:
+  EPaper213GrayDisplayManager();
+  
+  // Initialize the display
+  void begin() override;
+  
+  // Show a message with optional second line
+  void show_message(const String& message, const String& second_line = "") override;
+  
+  // Update display with all data points
+  void update_display(const std::array<RequestData, 3>& data_points, bool force_refresh = false, String battery_level = "") override;
+  
+  // Draw a 24-bit BMP from the filesystem in gray levels
+  void draw_bitmap_from_path(const char *path, int x, int y) override;
+  
+  // Wait for the render task to finish any pending refresh
+  void flush() override;
+  
+  // Put display into sleep mode to save power
+  void sleep() override;
+  
+  uint8_t gray_levels() const override { return 4; }
+  
+  // Pin the frame (both planes) the render task last sent to the panel
+  const uint8_t* acquire_screen(uint32_t& hash) override;
+  void release_screen() override;
+  
+private:
+  ThinkInk_213_Grayscale4_T5 _display;
+  
+  // Back buffer the application composes into; owned by the caller's task
+  GrayRaster* _canvas;
+  
+  // Render task that owns the panel and refreshes submitted frames
+  DisplayRenderTask* _renderer;
+  
+  // Hand the composed back buffer to the render task. Returns false if it was
+  // identical to the panel contents and skipped.
+  bool submit_frame();
+  
+  // Runs on the render task: copy a frame into the panel buffer and refresh
+  void upload_frame(const uint8_t* frame);
+};
+
+#endif // EPAPER_213_GRAY_DISPLAY_MANAGER_H
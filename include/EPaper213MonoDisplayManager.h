@@ -5,14 +5,18 @@
 #include "Adafruit_ThinkInk.h"
 #include <array>
 #include "RequestData.h"
+#include "DisplayRenderTask.h"
+#include "MonoRaster.h"
 
 // ePaper Display IO details - hardcoded for 2.13" mono display
+#ifndef EPD_DC
 #define EPD_DC 10
 #define EPD_CS 9
 #define EPD_BUSY -1 // can set to -1 to not use a pin (will wait a fixed delay)
 #define EPD_SRCS 6  // SRAM select pin
 #define EPD_RST -1  // can set to -1 and share with microcontroller Reset!
 #define EPD_SPI &SPI // primary SPI
+#endif
 
 // Using data point names from main sketch
 extern const char* DATA_TEMPERATURE;
@@ -39,14 +43,34 @@ public:
   // Draw a bitmap from the filesystem
   void draw_bitmap_from_path(const char *path, int x, int y) override;
   
+  // Wait for the render task to finish any pending refresh
+  void flush() override;
+  
   // Put display into sleep mode to save power
   void sleep() override;
   
+  // Pin the frame the render task last sent to the panel
+  const uint8_t* acquire_screen(uint32_t& hash) override;
+  void release_screen() override;
+  
+  // Icon path for a Home Assistant weather condition
+  static String determine_weather_icon_path(const String& weather_condition);
+  
 private:
   ThinkInk_213_Mono_GDEY0213B74 _display;
   
-  // Helper method to determine weather icon path based on condition
-  String determine_weather_icon_path(const String& weather_condition);
+  // Back buffer the application composes into; owned by the caller's task
+  MonoRaster* _canvas;
+  
+  // Render task that owns the panel and refreshes submitted frames
+  DisplayRenderTask* _renderer;
+  
+  // Hand the composed back buffer to the render task. Returns false if it was
+  // identical to the panel contents and skipped.
+  bool submit_frame();
+  
+  // Runs on the render task: copy a frame into the panel buffer and refresh
+  void upload_frame(const uint8_t* frame);
 };
 
 #endif // EPAPER_213_MONO_DISPLAY_MANAGER_H
\ No newline at end of file
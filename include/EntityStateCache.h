@@ -0,0 +1,57 @@
+#ifndef ENTITY_STATE_CACHE_H
+#define ENTITY_STATE_CACHE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <vector>
+
+// On-device copy of the Home Assistant values the display uses, kept current
+// from subscribe_entities messages. Only tracked values are stored - an
+// entity's state or one of its attributes - so large attributes such as
+// weather forecasts are never kept.
+//
+// subscribe_entities sends a snapshot of every entity once, then compressed
+// diffs:
+//   "a": { entity_id: { "s": state, "a": { attributes } } }     added (full)
+//   "c": { entity_id: { "+": { "s": ..., "a": { changed } },
+//                       "-": { "a": [ removed attribute names ] } } }
+//   "r": [ entity_id, ... ]                                       removed
+class EntityStateCache {
+public:
+  // Keep an entity's state, or one of its attributes if attribute is non-empty
+  void track(const String& entity_id, const String& attribute = "");
+  
+  // Forget all tracked values
+  void clear();
+  
+  // Distinct entity IDs with at least one tracked value
+  std::vector<String> entity_ids() const;
+  
+  // Apply a subscribe_entities event. Returns true if any tracked value changed.
+  bool apply(JsonObjectConst event);
+  
+  // Add the parts of a subscribe_entities event that apply() reads to a
+  // deserializeJson() filter: the state and tracked attributes of tracked
+  // entities, and the removed list
+  void add_to_filter(JsonObject event_filter) const;
+  
+  // Latest value of an entity's state or attribute. Returns false if it is not
+  // tracked or Home Assistant has not reported it.
+  bool get(const String& entity_id, const String& attribute, String& value) const;
+  
+private:
+  struct TrackedValue {
+    String entity_id;
+    String attribute;  // Empty for the entity state
+    String value;
+    bool known = false;
+  };
+  
+  std::vector<TrackedValue> _values;
+  
+  // Set a tracked value, returning true if it changed
+  static bool set(TrackedValue& tracked, JsonVariantConst value);
+  static bool forget(TrackedValue& tracked);
+};
+
+#endif // ENTITY_STATE_CACHE_H
@@ -0,0 +1,59 @@
+#ifndef GRAY_RASTER_H
+#define GRAY_RASTER_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "RasterPlane.h"
+
+// Gray levels, by amount of ink (0 = white, 3 = black)
+#define GRAY_WHITE 0
+#define GRAY_LIGHT 1
+#define GRAY_DARK 2
+#define GRAY_BLACK 3
+
+// 4-level canvas stored as two packed 1bpp bit-planes, exactly two bits per
+// pixel: plane 0 holds bit 0 of each pixel's level and plane 1 holds bit 1.
+// Both planes live back to back in one buffer, so a frame can be hashed and
+// copied as a unit. Colors passed through the Adafruit_GFX API are levels.
+// Fills, blits and GFX font text run once per plane through RasterPlane.
+class GrayRaster : public Adafruit_GFX {
+public:
+  GrayRaster(uint16_t width, uint16_t height);
+  ~GrayRaster();
+
+  // Both planes, plane 0 first; plane_size() bytes each
+  uint8_t* getBuffer() const { return _buffer; }
+  size_t plane_size() const { return _planes[0].size(); }
+  size_t frame_size() const { return 2 * plane_size(); }
+
+  // Nearest level for an 8-bit gray value (0 = black, 255 = white), without dithering
+  static uint8_t level_for_gray(uint8_t gray) { return (3 * (255 - gray) + 127) / 255; }
+
+  // Draw the set bits of a 1bpp bitmap (rows padded to whole bytes, MSB
+  // first) in a level; clear bits are left untouched
+  void draw_bitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t width, int16_t height, uint8_t level);
+
+  // Draw one row of 8-bit gray pixels (opaque), mapped with level_for_gray().
+  // Images are drawn row by row, so no 8-bit copy of the image is needed.
+  void draw_gray_row(int16_t x, int16_t y, const uint8_t* gray, int16_t width);
+
+  // Adafruit_GFX overrides
+  void drawPixel(int16_t x, int16_t y, uint16_t level) override;
+  void fillScreen(uint16_t level) override;
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t level) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t level) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t level) override;
+
+  // GFX (custom) fonts at text size 1 are blitted into both planes; the
+  // built-in font and scaled text fall back to drawPixel/fillRect
+  size_t write(uint8_t c) override;
+
+private:
+  uint8_t* _buffer;
+  RasterPlane _planes[2];
+
+  // Widest row draw_gray_row() handles in one pass, in pixels
+  static const int16_t MAX_ROW_PIXELS = 512;
+};
+
+#endif // GRAY_RASTER_H
@@ -1,27 +1,44 @@
 #ifndef HASS_WEBSOCKET_MANAGER_H
 #define HASS_WEBSOCKET_MANAGER_H
 
-#include <ArduinoWebsockets.h>
 #include <ArduinoJson.h>
 #include <WiFi.h>
+#include "EntityStateCache.h"
+#include "WebsocketClient.h"
 
-using namespace websockets;
+// Connection timing for the wake metrics, reset by each connect()
+struct HassConnectionStats {
+    uint32_t auth_ms;          // connect() until auth_ok
+    uint32_t first_data_ms;    // connect() until the first response to a request
+    uint16_t queued;           // Requests held back until auth_ok
+    uint16_t failed;           // Queued requests failed by auth_invalid or a lost connection
+    uint32_t dispatched;       // Messages handled; more than websocket.messages when frames are coalesced
+};
 
 class HassWebsocketManager {
     public:
     // Function pointer for receiving data back from the websocket. Includes the request ID, response type, and data.
-    typedef void (*DataCallback)(int, String, JsonDocument&);
+    // With coalesce_messages one frame can carry several messages; each is passed on its own.
+    // Messages are parsed through a filter: besides id, type and errors, events
+    // keep only the subscribe_entities fields of tracked values and a
+    // render_template "result", so large attributes are never built in memory.
+    typedef void (*DataCallback)(int, String, JsonObjectConst);
     typedef void (*ErrorCallback)(int, String);
 
     HassWebsocketManager(WiFiClient &wifi_client);
     HassWebsocketManager();
 
     void connect(String url, String auth_token);
+    // SHA-256 of the server certificate for wss:// URLs; empty to use /ca.pem
+    bool set_certificate_fingerprint(String fingerprint);
     void disconnect();
     void loop();
 
-    // Send a request to the websocket, returns the request ID
+    // Send a request to the websocket, returns the request ID. Until Home
+    // Assistant answers auth_ok, requests are queued and then sent together;
+    // auth_invalid or a lost connection fails them through the error callback.
     int send_message(String message);
+    bool authenticated() const { return is_authenticated; }
 
     // Helpers for managing subscriptions
     int subscribe_to_event(String event_type);
@@ -30,6 +47,14 @@ class HassWebsocketManager {
     int subscribe_to_trigger(String trigger);
 
     int render_template(String templateStr);
+
+    // Subscribe to the entities tracked in entity_cache(). Home Assistant sends
+    // a snapshot, then only add/change/remove diffs, which are applied to the
+    // cache before the data callback sees the event. Replaces any previous
+    // entity subscription and is renewed automatically after a reconnect.
+    int subscribe_entities();
+    int entities_subscription() const { return entities_subscription_id; }
+    EntityStateCache& entity_cache() { return entities; }
     int ping();
 
     // Message callbacks
@@ -38,15 +63,44 @@ class HassWebsocketManager {
 
     bool available();
 
+    // Reconnects are held back after Home Assistant sent a message over the
+    // size limit; connect() does nothing until the back-off has passed
+    bool backing_off() const;
+
+    // Block until Home Assistant sends something or timeout_ms passes
+    bool wait_for_data(uint32_t timeout_ms);
+
+    // Bytes on the wire and inflate time, for the wake metrics
+    const WebsocketStats& stats() const { return ws_client.stats(); }
+    const HassConnectionStats& connection_stats() const { return connection; }
+
     private:
     // internal variables
-    WebsocketsClient ws_client;
+    WebsocketClient ws_client;
     int request_id = 1;                         // Next request ID, initialized as 1
     DataCallback data_callback = nullptr;        // Function pointer, initialized as null
     ErrorCallback error_callback = nullptr;      // Function pointer, initialized as null
     void process_websocket_message(String message);
+    void dispatch_message(JsonObjectConst message);
+    JsonDocument message_filter;                 // deserializeJson() filter for a single message
+    JsonDocument batch_filter;                   // The same for a coalesced array of messages
+    void build_message_filters();
     String websocket_url;
     String auth_token;
+    bool closing_intentionally = false;          // Set while disconnect() closes the socket
+    bool coalesce_messages = true;               // Ask for coalesce_messages; off after an oversized batch
+    uint8_t too_big_closes = 0;                  // Connections closed in a row by an oversized message
+    bool holding_reconnect = false;              // Back-off after those is in effect
+    unsigned long reconnect_after = 0;           // millis() when it ends
+    EntityStateCache entities;                   // Values from the subscribe_entities subscription
+    int entities_subscription_id = -1;           // Request ID of that subscription, -1 if none
+    bool is_authenticated = false;               // auth_ok received on this connection
+    std::vector<String> queued_messages;         // Requests waiting for auth_ok
+    std::vector<int> queued_ids;                 // Their request IDs
+    unsigned long connect_started = 0;           // millis() when connect() began
+    HassConnectionStats connection = {};
+    void flush_queued_requests();
+    void fail_queued_requests(const String& reason);
 };    
 
 #endif
\ No newline at end of file
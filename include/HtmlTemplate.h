@@ -0,0 +1,39 @@
+#ifndef HTML_TEMPLATE_H
+#define HTML_TEMPLATE_H
+
+#include <Arduino.h>
+#include <functional>
+#include "HttpServer.h"
+
+// Streams an HTML template stored in flash as a chunked response, replacing
+// {{name}} placeholders as it goes. Output is collected in a fixed buffer and
+// sent whenever it fills, so peak RAM does not depend on the page size. Values
+// written with write_escaped() are HTML-escaped.
+class HtmlTemplate {
+public:
+  // Called for each placeholder; writes the value through `page`
+  typedef std::function<void(const char* name, HtmlTemplate& page)> Resolver;
+
+  explicit HtmlTemplate(HttpRequest& request);
+
+  // Send a complete 200 response for the template
+  bool render(const char* content_type, const char* text, Resolver resolver = nullptr);
+
+  // Output helpers for resolvers
+  void write(const char* data, size_t length);
+  void write(const char* text) { write(text, strlen(text)); }
+  void write_escaped(const char* text);
+
+  static const size_t BUFFER_SIZE = 512;
+  static const size_t MAX_NAME_LENGTH = 32;
+
+private:
+  void flush();
+
+  HttpRequest& _request;
+  char _buffer[BUFFER_SIZE];
+  size_t _length;
+  bool _failed;
+};
+
+#endif // HTML_TEMPLATE_H
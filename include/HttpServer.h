@@ -0,0 +1,137 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <FS.h>
+#include <functional>
+#include <esp_http_server.h>
+
+// One request being handled. Wraps httpd_req_t with the small subset of the
+// Arduino WebServer API the handlers use. Response headers are copied into the
+// request because httpd keeps only pointers until the response is sent.
+class HttpRequest {
+public:
+  explicit HttpRequest(httpd_req_t* req);
+
+  httpd_method_t method() const { return (httpd_method_t)_req->method; }
+  const char* uri() const { return _req->uri; }
+
+  // Request header value, empty if absent
+  String header(const char* name) const;
+
+  // Request body (read on first use, truncated at MAX_BODY_SIZE). If the
+  // client stalls, a 408 is sent and the connection closed; sent() is then true
+  // and later responses are dropped.
+  const String& body();
+
+  // Field from the query string or a url-encoded form body, empty if absent
+  String arg(const char* name);
+
+  // Add a response header. `name` must be a string literal.
+  void send_header(const char* name, const String& value);
+
+  // Send a complete response
+  void send(int code, const char* content_type = nullptr, const String& content = String());
+
+  // Chunked response: begin_chunks() sends the status line and headers, each
+  // send_chunk() goes out as one chunk, end_chunks() terminates the body
+  void begin_chunks(int code, const char* content_type);
+  bool send_chunk(const char* data, size_t length);
+  void end_chunks();
+
+  // Stream a file as a chunked 200 response. Files ending in .gz are sent with Content-Encoding: gzip.
+  bool send_file(File& file, const char* content_type);
+
+  // True once a response has been sent
+  bool sent() const { return _sent; }
+
+  // The connection should be closed after this request
+  bool close_requested() const { return _close; }
+
+  static const size_t MAX_BODY_SIZE = 4096;
+
+  // Receive timeouts (recv_wait_timeout each) tolerated while reading the body
+  static const uint8_t MAX_BODY_TIMEOUTS = 2;
+
+private:
+  static const uint8_t MAX_RESPONSE_HEADERS = 6;
+  static const size_t FILE_CHUNK_SIZE = 1024;
+
+  static const char* status_text(int code);
+  static String find_arg(const String& source, const char* name);
+  static String url_decode(const String& value);
+
+  httpd_req_t* _req;
+  String _header_values[MAX_RESPONSE_HEADERS];
+  uint8_t _header_count;
+  String _body;
+  bool _body_read;
+  bool _sent;
+  bool _close;
+};
+
+// Event-driven HTTP server on the ESP-IDF httpd task. Requests are handled off
+// the Arduino loop, several connections can be open at once (keep-alive, least
+// recently used purged when full), and handlers run one at a time on the httpd
+// task, so they must not touch loop-owned state without synchronisation.
+class HttpServer {
+public:
+  typedef std::function<void(HttpRequest& request)> Handler;
+
+  HttpServer();
+  ~HttpServer();
+
+  // Register a handler; routes must be added before begin()
+  bool on(const char* uri, httpd_method_t method, Handler handler);
+
+  // Handler for requests that match no route (default: plain 404)
+  void on_not_found(Handler handler) { _not_found = handler; }
+
+  bool begin(uint16_t port);
+  void stop();
+
+  // Connection and latency statistics
+  uint8_t active_connections() const { return _active_connections; }
+  uint8_t peak_connections() const { return _peak_connections; }
+  uint32_t requests_handled() const { return _requests; }
+
+  // True while a client has a connection open and sent a request recently.
+  // Idle keep-alive connections stop counting after CLIENT_IDLE_MS.
+  bool is_client_active() const;
+
+  // Statistics for the metrics endpoint
+  void metrics_json(JsonObject object) const;
+
+  static const uint8_t MAX_ROUTES = 16;
+  static const uint8_t MAX_OPEN_SOCKETS = 5;
+  static const uint32_t CLIENT_IDLE_MS = 30000;
+
+private:
+  struct Route {
+    HttpServer* server;
+    Handler handler;
+    httpd_uri_t uri;
+  };
+
+  static esp_err_t route_trampoline(httpd_req_t* req);
+  static esp_err_t not_found_trampoline(httpd_req_t* req, httpd_err_code_t error);
+  static esp_err_t on_open(httpd_handle_t handle, int sockfd);
+  static void on_close(httpd_handle_t handle, int sockfd);
+
+  esp_err_t dispatch(httpd_req_t* req, const Handler& handler);
+
+  httpd_handle_t _handle;
+  Route _routes[MAX_ROUTES];
+  uint8_t _route_count;
+  Handler _not_found;
+
+  volatile uint8_t _active_connections;
+  volatile uint8_t _peak_connections;
+  volatile uint32_t _requests;
+  uint64_t _latency_total_us;
+  volatile uint32_t _latency_max_us;
+  volatile unsigned long _last_request_time;
+};
+
+#endif // HTTP_SERVER_H
@@ -0,0 +1,64 @@
+#ifndef INFLATER_H
+#define INFLATER_H
+
+#include <Arduino.h>
+
+// Raw DEFLATE (RFC 1951) decoder with a fixed-size history window, for
+// permessage-deflate websocket messages. Memory is the window plus two small
+// Huffman tables, whatever the message size; streams that reference further
+// back than the window are rejected.
+//
+// Each call decodes a whole message (a run of complete blocks). The history
+// carries over to the next call, as context takeover requires.
+class Inflater {
+public:
+  // window_bits: log2 of the window size, 8-15
+  explicit Inflater(uint8_t window_bits);
+  ~Inflater();
+  
+  // Forget the history (new connection, or no context takeover)
+  void reset();
+  
+  // Decode data, appending the output to out. Returns false on corrupt input,
+  // references past the window, or more than max_output bytes of output.
+  bool inflate(const uint8_t* data, size_t length, String& out, size_t max_output);
+  
+  size_t window_size() const { return _mask + 1; }
+  
+private:
+  struct Huffman {
+    uint16_t count[16];   // Codes of each length
+    uint16_t symbol[288]; // Symbols ordered by code
+  };
+  
+  uint8_t* _window;
+  size_t _mask;
+  size_t _pos;            // Next write position in the window
+  size_t _history;        // Bytes of valid history, up to the window size
+  
+  // Per-call decoding state
+  const uint8_t* _in;
+  const uint8_t* _end;
+  uint32_t _bit_buffer;
+  uint8_t _bit_count;
+  bool _error;
+  String* _out;
+  size_t _pending;        // Output in the window not yet appended
+  size_t _produced;
+  size_t _max_output;
+  
+  Huffman _lengths;
+  Huffman _distances;
+  
+  uint32_t bits(uint8_t count);
+  int decode(const Huffman& huffman);
+  static bool build(Huffman& huffman, const uint8_t* lengths, int count);
+  bool stored_block();
+  bool fixed_block();
+  bool dynamic_block();
+  bool codes();
+  void put(uint8_t value);
+  void flush();
+};
+
+#endif // INFLATER_H
@@ -0,0 +1,100 @@
+#ifndef LOOP_MONITOR_H
+#define LOOP_MONITOR_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Parts of loop() that are timed separately. Time in a nested section counts
+// only towards the innermost one.
+enum LoopSection : uint8_t {
+  LOOP_WEBSOCKET = 0,   // Connect and poll Home Assistant
+  LOOP_WEB_SERVER,      // Restart requests and applying saved configuration
+  LOOP_TIMERS,          // Data refresh and display timers
+  LOOP_DISPLAY,         // Drawing and uploading a frame
+  LOOP_PORTAL,          // Captive portal requests and hand-over
+  LOOP_IDLE,            // Deliberate waiting; excluded from iteration time
+  LOOP_SECTION_COUNT
+};
+
+// Iteration time histogram bucket upper bounds in ms; the last bucket is open
+#define LOOP_HISTOGRAM_BUCKETS 13
+
+struct LoopSectionStats {
+  uint32_t max_ms;       // Longest single run
+  uint32_t total_ms;
+  uint32_t overruns;     // Runs longer than the section's budget
+};
+
+// Plain data so a wake's numbers can be kept with the wake metrics
+struct LoopStats {
+  uint32_t iterations;
+  uint32_t max_ms;                                // Longest iteration, idle time excluded
+  uint32_t histogram[LOOP_HISTOGRAM_BUCKETS];     // Iterations per duration bucket
+  LoopSectionStats sections[LOOP_SECTION_COUNT];
+  uint8_t last_overrun_section;                   // LOOP_SECTION_COUNT if none yet
+  uint32_t last_overrun_ms;                       // How long that run took
+  uint8_t reset_section;                          // Section still over budget when a watchdog
+                                                  // or panic reset the chip, LOOP_SECTION_COUNT if none
+};
+
+// Times loop() iterations and the sections within them, so blocking calls
+// show up in the metrics. A one-shot timer armed with the section's budget
+// also marks a section that is still running past it, in memory that
+// survives a reset, so a hang that ends in a watchdog reset is attributed on
+// the next boot. The timer is never armed while idling, so light sleep is
+// not interrupted.
+class LoopMonitor {
+public:
+  LoopMonitor();
+
+  // Create the watchdog timer and pick up a hang from before the last reset
+  void begin();
+
+  // Call at the top of loop(); closes the previous iteration
+  void begin_iteration();
+
+  // Bracket a section; sections may nest a few levels deep
+  void begin_section(LoopSection section);
+  void end_section();
+
+  const LoopStats& stats() const { return _stats; }
+
+  // Duration in ms that the given percentile of iterations stayed within
+  // (histogram bucket upper bound, or the maximum for the open bucket)
+  static uint32_t percentile_ms(const LoopStats& stats, uint8_t percent);
+  static uint32_t bucket_limit_ms(uint8_t bucket);
+  static const char* section_name(uint8_t section);
+  static uint32_t section_budget_ms(uint8_t section);
+
+private:
+  struct Frame {
+    LoopSection section;
+    int64_t start_us;
+    int64_t child_us;    // Time spent in nested sections
+  };
+  static const uint8_t MAX_DEPTH = 4;
+
+  LoopStats _stats;
+  Frame _frames[MAX_DEPTH];
+  uint8_t _depth;
+  int64_t _iteration_start_us;
+  int64_t _iteration_idle_us;
+  esp_timer_handle_t _watchdog;
+
+  // Section the watchdog is armed for, and the one it found over budget
+  // (LOOP_SECTION_COUNT for none). Single bytes, so the timer task's
+  // accesses don't tear.
+  volatile uint8_t _armed_section;
+  volatile uint8_t _blocked_section;
+
+  void record_iteration(uint32_t elapsed_ms);
+  void arm(uint8_t section);
+  void disarm();
+  void clear_blocked();
+  static void watchdog_callback(void* monitor);
+};
+
+// Global loop monitor
+extern LoopMonitor loop_monitor;
+
+#endif // LOOP_MONITOR_H
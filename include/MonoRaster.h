@@ -0,0 +1,37 @@
+#ifndef MONO_RASTER_H
+#define MONO_RASTER_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include "RasterPlane.h"
+
+// 1bpp canvas with word-level drawing primitives. The buffer layout is the
+// same as GFXcanvas1 (rows padded to whole bytes, MSB first, set bit = color),
+// but fills, spans, bitmap blits and GFX font text go through RasterPlane,
+// which handles the rotation once per operation and writes whole bytes or
+// 32-bit words, instead of going through drawPixel pixel by pixel.
+class MonoRaster : public GFXcanvas1 {
+public:
+  MonoRaster(uint16_t width, uint16_t height);
+
+  // Horizontal span of width pixels starting at (x, y)
+  void fill_span(int16_t x, int16_t y, int16_t width, uint16_t color);
+
+  // Draw the set bits of a 1bpp bitmap (rows padded to whole bytes, MSB
+  // first) in color; clear bits are left untouched
+  void draw_bitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t width, int16_t height, uint16_t color);
+
+  // Adafruit_GFX overrides
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+
+  // GFX (custom) fonts at text size 1 are blitted a glyph row at a time;
+  // the built-in font and scaled text fall back to GFXcanvas1
+  size_t write(uint8_t c) override;
+
+private:
+  RasterPlane _plane;  // Over the GFXcanvas1 buffer
+};
+
+#endif // MONO_RASTER_H
@@ -0,0 +1,63 @@
+#ifndef PNG_ENCODER_H
+#define PNG_ENCODER_H
+
+#include <Arduino.h>
+#include <functional>
+
+// Streams a 1bpp bitmap or a pair of bit-planes (4 gray levels) as a
+// grayscale PNG without copying the image. Each row
+// is compressed on its own as a fixed-Huffman deflate block, using only runs of
+// the previous byte and matches against the row above, which covers the flat
+// areas and repeated rows of an e-paper UI. Compressed bytes are gathered into
+// fixed-size IDAT chunks and handed to the writer as complete PNG chunks.
+class PngEncoder {
+public:
+  // Receives encoded output; return false to abort (e.g. client went away)
+  typedef std::function<bool(const uint8_t* data, size_t length)> Writer;
+
+  explicit PngEncoder(Writer writer);
+
+  // Encode a bitmap with rows padded to whole bytes, MSB first, set bit = black
+  bool encode_mono(const uint8_t* bitmap, int width, int height);
+
+  // Encode two bit-planes laid out like encode_mono's bitmap, where plane 0
+  // holds bit 0 and plane 1 bit 1 of each pixel's level (0 = white, 3 = black)
+  bool encode_gray2(const uint8_t* plane0, const uint8_t* plane1, int width, int height);
+
+  // Widest row supported, in PNG bytes (250 px at 2 bits per pixel fits)
+  static const size_t MAX_ROW_BYTES = 64;
+
+private:
+  static const size_t IDAT_SIZE = 512;
+
+  // Fills one PNG row (pixels only, without the filter byte)
+  typedef std::function<void(int y, uint8_t* row)> RowSource;
+
+  // Write the whole PNG with rows of row_bytes produced by source
+  bool encode(int width, int height, uint8_t bit_depth, size_t row_bytes, const RowSource& source);
+
+  // Deflate one row (filter byte + pixels) as a fixed-Huffman block
+  void deflate_row(const uint8_t* row, const uint8_t* previous, size_t length, bool last);
+  void write_literal(uint8_t value);
+  void write_match(size_t length, size_t distance);
+  void write_bits(uint32_t value, uint8_t count);
+  void write_huffman(uint16_t code, uint8_t length);
+  void write_byte(uint8_t value);
+
+  // PNG chunk assembly
+  bool write_chunk(const char* type, const uint8_t* data, size_t length);
+  bool flush_idat();
+
+  Writer _writer;
+  bool _failed;
+
+  // Deflate bit accumulator (LSB first)
+  uint32_t _bit_buffer;
+  uint8_t _bit_count;
+
+  // Pending IDAT payload: 8 bytes reserved for length and type, 4 for the CRC
+  uint8_t _chunk[8 + IDAT_SIZE + 4];
+  size_t _idat_length;
+};
+
+#endif // PNG_ENCODER_H
@@ -0,0 +1,41 @@
+#ifndef RASTER_PLANE_H
+#define RASTER_PLANE_H
+
+#include <Arduino.h>
+
+// Word-level drawing on one 1bpp bit-plane (rows padded to whole bytes, MSB
+// first). Coordinates are logical: each operation maps its geometry through
+// the GFX rotation (0-3) once, clips it to the plane, and then fills rows with
+// edge masks and 32-bit stores or shifts source bytes into place. Does not own
+// the buffer; MonoRaster uses one plane, GrayRaster two.
+class RasterPlane {
+public:
+  // width and height are the raw (unrotated) dimensions
+  RasterPlane(uint8_t* buffer, int16_t width, int16_t height);
+
+  uint8_t* buffer() const { return _buffer; }
+  size_t stride() const { return _stride; }
+  size_t size() const { return _stride * _height; }
+
+  // Set (color true) or clear a rectangle
+  void fill_rect(uint8_t rotation, int16_t x, int16_t y, int16_t w, int16_t h, bool color);
+
+  // Set or clear the pixels under the set bits of a w x h bit stream whose
+  // row r starts at bit r * row_bits; clear source bits are left untouched
+  void blit_bits(uint8_t rotation, int16_t x, int16_t y, const uint8_t* bits, uint32_t row_bits,
+                 int16_t w, int16_t h, bool color);
+
+private:
+  uint8_t* _buffer;
+  int16_t _width;
+  int16_t _height;
+  size_t _stride;  // Bytes per raw row
+
+  // Rectangle in raw (unrotated) buffer coordinates, clipped; false if empty
+  bool to_raw_rect(uint8_t rotation, int16_t& x, int16_t& y, int16_t& w, int16_t& h) const;
+
+  // Fill a clipped raw rectangle row by row with edge masks and word stores
+  void fill_raw_rect(int16_t x, int16_t y, int16_t w, int16_t h, bool color);
+};
+
+#endif // RASTER_PLANE_H
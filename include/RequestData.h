@@ -5,32 +5,34 @@
 #include <ArduinoLog.h>
 
 struct RequestData {
-    int pending_request_id;
     String name;
     String latest_value;
     String previous_value;
-    String templateStr;
+    String entity_id;       // Home Assistant entity the value comes from; empty for none
+    String attribute;       // Attribute of that entity, or empty for its state
     bool has_value_changed = false;
 
     // Constructor (optional)
-    RequestData() : pending_request_id(0), name(""), latest_value(""), templateStr("") {}
+    RequestData() : name(""), latest_value(""), entity_id(""), attribute("") {}
 
     // Helper function to display data
     void print() {
-        Serial.println("Request ID: " + String(pending_request_id));
         Serial.println("Name: " + name);
         Serial.println("Latest Value: " + latest_value);
-        Serial.println("Template: " + templateStr);
+        Serial.println("Entity: " + entity_id + (attribute.length() > 0 ? "." + attribute : String("")));
     }
 
-    void update_value(String newValue) {
-      if (previous_value != newValue)
+    // Returns true if the value changed
+    bool update_value(String newValue) {
+      if (latest_value != newValue)
       {
         previous_value = latest_value;
         latest_value = newValue;
         has_value_changed = true;
         Log.verboseln("Value changed for %s from %s to %s", name, previous_value, latest_value);
+        return true;
       }
+      return false;
     }
 };
 
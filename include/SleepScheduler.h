@@ -0,0 +1,35 @@
+#ifndef SLEEP_SCHEDULER_H
+#define SLEEP_SCHEDULER_H
+
+#include <Arduino.h>
+#include "ConfigManager.h"
+
+// Chooses the deep sleep interval for the next wake. Keeps a short history in
+// RTC memory of which data points changed on recent wakes: stable values
+// stretch the interval, volatile values shorten it, and a low battery stretches
+// it further. The result is clamped to the configured minimum and maximum.
+class SleepScheduler {
+public:
+  // Number of data points tracked (matches the data_points array)
+  static const uint8_t MAX_DATA_POINTS = 3;
+
+  // Number of recent wakes considered
+  static const uint8_t HISTORY_LENGTH = 8;
+
+  // Record whether each data point changed during this wake (bit i = data point i)
+  void record_wake(uint8_t changed_mask);
+
+  // Compute the next sleep interval. battery_percent < 0 means no fuel gauge.
+  uint32_t next_interval_seconds(const ConfigData& config, float battery_percent);
+
+  // Fraction of recent wakes in which at least one data point changed (0..1)
+  float volatility() const;
+
+  // Human readable explanation of the last computed interval
+  const char* reason() const { return _reason; }
+
+private:
+  char _reason[64];
+};
+
+#endif // SLEEP_SCHEDULER_H
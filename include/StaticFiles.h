@@ -0,0 +1,23 @@
+#ifndef STATIC_FILES_H
+#define STATIC_FILES_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "HttpServer.h"
+
+// Serves web assets from LittleFS. When the client accepts gzip and a
+// precompressed "<path>.gz" exists (generated at build time by
+// scripts/compress_www.py), the compressed file is sent instead. Every response
+// carries a strong ETag derived from the file content, and a request whose
+// If-None-Match matches it gets an empty 304 Not Modified.
+class StaticFiles {
+public:
+  // Send the file (or a 304). Returns false without responding if the file does not exist.
+  static bool serve(HttpRequest& request, const String& path, const char* content_type);
+
+private:
+  // Strong ETag for a file, cached by path after the first content hash
+  static String etag_for(const String& path, File& file);
+};
+
+#endif // STATIC_FILES_H
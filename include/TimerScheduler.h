@@ -0,0 +1,69 @@
+#ifndef TIMER_SCHEDULER_H
+#define TIMER_SCHEDULER_H
+
+#include <Arduino.h>
+
+// Millisecond timers in a fixed number of slots, with no heap allocation.
+// Running timers are kept in a min-heap ordered by deadline, so update() only
+// looks at timers that are due and next_deadline() tells the caller how long it
+// can sleep before anything needs to run. Deadlines are millis() values and
+// are compared wrap-safe.
+class TimerScheduler {
+public:
+  typedef void (*Callback)();
+  typedef int8_t TimerId;
+
+  static const uint8_t MAX_TIMERS = 4;
+  static const TimerId INVALID_TIMER = -1;
+
+  TimerScheduler();
+
+  // Claim a slot; the timer is stopped until start(). repeats is the number of
+  // times the callback runs per start(), 0 to repeat until stopped.
+  // Returns INVALID_TIMER when all slots are taken.
+  TimerId add(Callback callback, uint32_t interval_ms, uint16_t repeats);
+
+  // (Re)start the countdown from now
+  void start(TimerId id);
+  void stop(TimerId id);
+  bool running(TimerId id) const;
+
+  // Takes effect from the next start or the next run
+  void set_interval(TimerId id, uint32_t interval_ms);
+
+  // Run the callbacks of all timers that are due
+  void update();
+
+  // millis() value at which the earliest running timer is due; false if none is running
+  bool next_deadline(uint32_t& deadline_ms) const;
+
+  // Milliseconds until the next timer is due (0 if overdue), capped at limit_ms
+  uint32_t ms_until_next(uint32_t limit_ms) const;
+
+private:
+  struct Timer {
+    Callback callback;
+    uint32_t interval_ms;
+    uint32_t deadline_ms;
+    uint16_t repeats;
+    uint16_t remaining;     // Runs left in this start(); 0 with repeats == 0 means endless
+  };
+
+  Timer _timers[MAX_TIMERS];
+  uint8_t _count;
+
+  // Heap of running timer ids and each timer's index in it (-1 if stopped)
+  TimerId _heap[MAX_TIMERS];
+  int8_t _position[MAX_TIMERS];
+  uint8_t _heap_size;
+
+  bool valid(TimerId id) const { return id >= 0 && id < _count; }
+  bool earlier(TimerId a, TimerId b) const;
+  void schedule(TimerId id, uint32_t deadline_ms);
+  void unschedule(TimerId id);
+  void place(uint8_t index, TimerId id);
+  void sift_up(uint8_t index);
+  void sift_down(uint8_t index);
+};
+
+#endif // TIMER_SCHEDULER_H
@@ -0,0 +1,62 @@
+#ifndef TLS_CLIENT_H
+#define TLS_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+// TLS 1.2 client on top of a WiFiClient, for wss:// connections. The server
+// certificate is checked against a pinned SHA-256 fingerprint when one is set,
+// otherwise against the CA certificates in /ca.pem (one or more PEM blocks)
+// with a hostname check.
+//
+// The negotiated session (ticket or session ID) is kept in RTC memory, so the
+// first connection after a deep sleep wake resumes it with an abbreviated
+// handshake: no certificate exchange and no key agreement.
+class TlsClient {
+public:
+  explicit TlsClient(WiFiClient& tcp);
+  ~TlsClient();
+
+  // SHA-256 of the server certificate as 64 hex digits (colons and spaces
+  // allowed). Empty to verify against /ca.pem instead.
+  bool set_fingerprint(const String& fingerprint);
+
+  // TCP connect to address and TLS handshake with host; blocks for up to timeout_ms
+  bool connect(const char* host, const IPAddress& address, uint16_t port, uint32_t timeout_ms);
+  size_t write(const uint8_t* data, size_t length);
+  int read(uint8_t* buffer, size_t length);
+
+  // Decrypted bytes ready to read
+  int available();
+  bool connected();
+  void stop();
+
+  // Last handshake: duration (TCP connect excluded) and whether it resumed a session
+  uint32_t handshake_ms() const { return _handshake_ms; }
+  bool resumed() const { return _resumed; }
+
+  // Drop the stored session so the next connection does a full handshake
+  static void forget_session();
+
+private:
+  struct Context;
+
+  WiFiClient& _tcp;
+  Context* _context;           // mbedtls state, only while connected
+  uint8_t _fingerprint[32];
+  bool _pinned;
+  bool _peer_closed;
+  uint32_t _timeout_ms;
+  uint32_t _handshake_ms;
+  bool _resumed;
+
+  bool configure(const char* host);
+  bool restore_session(const char* host, uint16_t port);
+  void save_session(const char* host, uint16_t port);
+  bool verify_pin();
+
+  static int send_callback(void* client, const unsigned char* data, size_t length);
+  static int receive_callback(void* client, unsigned char* buffer, size_t length);
+};
+
+#endif // TLS_CLIENT_H
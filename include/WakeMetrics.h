@@ -0,0 +1,117 @@
+#ifndef WAKE_METRICS_H
+#define WAKE_METRICS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "HassWebsocketManager.h"
+#include "LoopMonitor.h"
+
+// Boot stages that can run concurrently. WiFi association proceeds in the
+// WiFi driver and the fuel gauge probe on its own task while the main task
+// mounts the filesystem, starts the display and sets up the data points.
+enum BootStage : uint8_t {
+  BOOT_CONFIG = 0,
+  BOOT_FILESYSTEM,
+  BOOT_WIFI,          // WiFi.begin() until an IP address is assigned
+  BOOT_BATTERY,
+  BOOT_DISPLAY,
+  BOOT_DATA_POINTS,
+  BOOT_STAGE_COUNT
+};
+
+// millis() values; end_ms is 0 while the stage is running or if it never ran
+struct BootStageTiming {
+  uint32_t start_ms;
+  uint32_t end_ms;
+};
+
+// Measurements for a single wake cycle. Plain data so the finished cycle can be
+// kept in RTC memory and reported again after the next wake.
+struct WakeMetricsData {
+  uint32_t boot_count;
+  uint32_t awake_ms;
+
+  // Adaptive sleep scheduling
+  uint32_t sleep_interval_s;
+  float data_volatility;
+  float battery_percent;
+  char sleep_reason[64];
+
+  // Power mode comparison: time blocked in loop(), event latency and battery drain
+  char power_mode[24];
+  uint32_t idle_ms;
+  uint32_t events_received;
+  uint32_t event_latency_max_ms;
+  uint32_t event_latency_total_ms;
+  float battery_rate_percent_per_hour;
+
+  // Home Assistant traffic: bytes received on the wire and after inflating
+  WebsocketStats websocket;
+
+  // Home Assistant session: time to auth_ok and to the first data
+  HassConnectionStats connection;
+
+  // loop() responsiveness: iteration times and sections that overran their budget
+  LoopStats loop;
+
+  // Boot stage timing and when setup() finished
+  BootStageTiming boot[BOOT_STAGE_COUNT];
+  uint32_t boot_ms;
+};
+
+class WakeMetrics {
+public:
+  WakeMetrics();
+
+  // Start measuring a new wake cycle
+  void begin(uint32_t boot_count);
+
+  // Close the current cycle and keep it in RTC memory for the next wake
+  void finish();
+
+  // Copy the current cycle for to_json() (main loop only)
+  void publish();
+
+  // Last published cycle plus the previous one (if any); safe from any task
+  void to_json(JsonDocument& doc) const;
+
+  // Record a Home Assistant event; latency_ms is the upper bound on how long it waited
+  void record_event(uint32_t latency_ms);
+
+  // Take the websocket traffic counters for this wake
+  void record_websocket(const WebsocketStats& stats);
+
+  // Take the Home Assistant connection timing for this wake
+  void record_connection(const HassConnectionStats& stats);
+
+  // Take the loop() timing for this wake
+  void record_loop(const LoopStats& stats);
+
+  // Boot stage timing; each stage is recorded once per wake. Safe to call
+  // from other tasks, as each stage is only written by one of them.
+  void boot_stage_begin(BootStage stage);
+  void boot_stage_end(BootStage stage);
+  void boot_complete();
+
+  // Log a one-line summary of the current cycle
+  void log_summary() const;
+
+  // Values for the cycle in progress, written by the main loop (other tasks
+  // read them through publish() and to_json())
+  WakeMetricsData current;
+
+private:
+  // Copy of current for other tasks, guarded by _lock with rtc_previous_metrics
+  WakeMetricsData _published;
+  SemaphoreHandle_t _lock;
+
+  static void data_to_json(const WakeMetricsData& data, JsonObject object);
+  static void boot_to_json(const WakeMetricsData& data, JsonObject object);
+};
+
+// Global metrics instance
+extern WakeMetrics wake_metrics;
+
+#endif // WAKE_METRICS_H
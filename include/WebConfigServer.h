@@ -5,52 +5,82 @@
 #include <WiFi.h>
 #include <WiFiClient.h>
 #include <ESPmDNS.h>
-#include <WebServer.h>  // ESP32 WebServer (ESP32 core 2.0.0+)
 #include <ArduinoJson.h>
 #include <ArduinoLog.h>
 #include <LittleFS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "ConfigManager.h"
+#include "DisplayManager.h"
+#include "HttpServer.h"
 
+// Configuration web UI and JSON API. Requests are served on the HTTP server
+// task; saved settings are staged and only copied into the live configuration
+// and written to NVS by the main loop in take_pending_changes(), so loop code
+// never sees a half-written config.
 class WebConfigServer {
 public:
   // Constructor
-  WebConfigServer(ConfigManager& config_manager, int port = 80);
+  WebConfigServer(ConfigManager& config_manager, DisplayManager* display, int port = 80);
   
   // Initialize the web server
   void begin();
   
-  // Handle client requests (call this in the main loop)
-  void handle_client();
-  
   // Check if we need to restart the device
   bool should_restart() const;
   
-  // Check if a client is currently connected
+  // Apply settings posted since the last call to the live configuration and
+  // save them (main loop only). Returns ConfigApplyFlags for what changed.
+  uint8_t take_pending_changes();
+  
+  // Check if a client has used the server recently
   bool is_client_connected();
   
 private:
   // Reference to the config manager
   ConfigManager& _config_manager;
   
+  // Display to mirror at /api/screen (may be null)
+  DisplayManager* _display;
+  
   // Web server instance
-  WebServer _server;
+  HttpServer _server;
+  int _port;
   
   // Flag to indicate if device should restart
-  bool _restart_requested;
+  volatile bool _restart_requested;
+  
+  // Posted configuration waiting for the main loop, guarded by _lock
+  ConfigData _staged_config;
+  volatile bool _has_staged_config;
+  SemaphoreHandle_t _lock;
+  
+  // Each staged update is numbered; the loop reports the last one it saved
+  uint32_t _staged_sequence;
+  uint32_t _saved_sequence;
+  bool _save_succeeded;
+  SemaphoreHandle_t _saved_signal;
+  
+  // Wait until the loop has saved update sequence; false on timeout
+  bool wait_for_save(uint32_t sequence, bool& saved);
   
   // Setup server routes
   void setup_routes();
   
   // Handler methods
-  void handle_root();
-  void handle_static_files();
-  void handle_get_config();
-  void handle_update_config();
-  void handle_not_found();
-  void handle_restart();
-  
-  // Helper to serve static files from LittleFS
-  bool serve_file_from_fs(const String& path, const String& content_type);
+  void handle_root(HttpRequest& request);
+  void handle_get_config(HttpRequest& request);
+  void handle_get_schema(HttpRequest& request);
+  void handle_get_metrics(HttpRequest& request);
+  void handle_get_screen(HttpRequest& request);
+  void handle_update_config(HttpRequest& request);
+  void handle_not_found(HttpRequest& request);
+  void handle_restart(HttpRequest& request);
+  void handle_options(HttpRequest& request, const char* methods);
+  
+  // Helpers
+  bool serve_file_from_fs(HttpRequest& request, const String& path, const char* content_type);
+  void send_cors_headers(HttpRequest& request);
 };
 
 #endif // WEB_CONFIG_SERVER_H
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef WEBSOCKET_CLIENT_H
+#define WEBSOCKET_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <vector>
+#include "DnsCache.h"
+#include "Inflater.h"
+#include "TlsClient.h"
+
+enum class WebsocketEvent { Opened, Closed };
+
+// Traffic counters since the client was created
+struct WebsocketStats {
+  uint32_t messages;         // Text messages received
+  uint32_t wire_bytes;       // Frame bytes received, headers included
+  uint32_t payload_bytes;    // Message bytes after inflating
+  uint32_t sent_bytes;       // Frame bytes sent
+  uint32_t inflate_us;       // CPU time spent inflating
+  uint32_t inflate_max_us;   // Longest single message
+  bool deflate;              // permessage-deflate is active on this connection
+  bool tls;                  // Connected with wss://
+  bool tls_resumed;          // Last TLS handshake resumed a stored session
+  uint32_t tls_handshake_ms; // Duration of the last TLS handshake
+  uint32_t resolve_ms;       // Host name lookup for the last connect, 0 when cached
+  bool resolve_cached;       // Last connect used the cached address
+};
+
+// Minimal RFC 6455 client for the Home Assistant connection, over plain TCP
+// (ws://) or TLS (wss://, see TlsClient).
+// Offers permessage-deflate (RFC 7692) with a bounded server window, so
+// compressed messages are inflated with a fixed amount of memory; servers that
+// decline get a plain uncompressed connection. Messages are never compressed
+// in the other direction - they are small.
+class WebsocketClient {
+public:
+  typedef std::function<void(const String& message)> MessageCallback;
+  typedef std::function<void(WebsocketEvent event)> EventCallback;
+  
+  WebsocketClient();
+  ~WebsocketClient();
+  
+  void on_message(MessageCallback callback);
+  void on_event(EventCallback callback);
+  
+  // Whether the next connect() offers permessage-deflate (default true)
+  void set_deflate(bool offer);
+  
+  // Largest message accepted, before and after inflating (default 16 KB);
+  // anything longer closes the connection with 1009
+  void set_max_message_bytes(size_t bytes);
+  
+  // Server certificate pin for wss:// (see TlsClient::set_fingerprint)
+  bool set_fingerprint(const String& fingerprint);
+  
+  // Open a connection to a ws:// or wss:// URL. Blocks for the TCP connect and handshakes.
+  bool connect(const String& url);
+  bool send(const String& text);
+  // Several text messages, written to the connection in one go
+  bool send_batch(const std::vector<String>& texts);
+  void close();
+  bool available();
+  
+  // Handle whatever has arrived: messages, pings and close frames
+  void poll();
+  
+  // Block until poll() has something to read or timeout_ms passes; returns
+  // true if woken by data. Sleeps out the timeout when not connected.
+  bool wait_for_data(uint32_t timeout_ms);
+  
+  const WebsocketStats& stats() const { return _stats; }
+  
+  // The last connection was closed because a message exceeded the limit
+  bool message_too_big() const { return _message_too_big; }
+  
+private:
+  WiFiClient _tcp;
+  TlsClient _tls;              // Runs over _tcp for wss://
+  bool _secure;
+  DnsCache _dns;
+  bool _open;
+  bool _offer_deflate;
+  bool _no_context_takeover;
+  Inflater* _inflater;         // Present while permessage-deflate is active
+  size_t _max_message_bytes;
+  bool _message_too_big;
+  MessageCallback _on_message;
+  EventCallback _on_event;
+  WebsocketStats _stats;
+  
+  // Message being received, possibly over several frames
+  String _message;
+  bool _receiving;
+  bool _compressed;
+  uint32_t _message_wire_bytes;
+  
+  std::vector<uint8_t> _outgoing;  // Frames waiting for flush_frames()
+  
+  bool open_transport(const String& host, const IPAddress& address, uint16_t port);
+  bool handshake(const String& host, uint16_t port, const String& path);
+  bool read_line(String& line);
+  bool read_bytes(uint8_t* buffer, size_t length);
+  bool read_frame();
+  void finish_message();
+  bool send_frame(uint8_t opcode, const uint8_t* data, size_t length);
+  void append_frame(uint8_t opcode, const uint8_t* data, size_t length);
+  bool flush_frames();
+  void fail(uint16_t code, const char* reason);
+  void closed();
+  
+  // Byte stream of the current connection, plain or TLS
+  size_t transport_write(const uint8_t* data, size_t length);
+  int transport_read(uint8_t* buffer, size_t length);
+  int transport_available();
+  bool transport_connected();
+  void transport_stop();
+};
+
+#endif // WEBSOCKET_CLIENT_H
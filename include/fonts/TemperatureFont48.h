@@ -0,0 +1,154 @@
+// Generated by scripts/generate_font.py - do not edit.
+// DejaVuSans-Bold.ttf at 63 px (digit height 48 px), 13 glyphs, 1620 bytes of run data.
+#ifndef TEMPERATURE_FONT48_H
+#define TEMPERATURE_FONT48_H
+
+#include "CompactFont.h"
+
+const uint8_t TemperatureFont48Data[] PROGMEM = {
+  // '-' 20x9
+  0x09, 0x02, 0x00, 0x14,
+  // '.' 12x12
+  0x0C, 0x02, 0x00, 0x0C,
+  // '0' 38x48
+  0x01, 0x02, 0x0E, 0x0A, 0x01, 0x02, 0x0B, 0x10, 0x01, 0x02, 0x09, 0x14, 0x01, 0x02, 0x08, 0x16,
+  0x01, 0x02, 0x07, 0x18, 0x01, 0x02, 0x06, 0x1A, 0x01, 0x02, 0x05, 0x1C, 0x01, 0x02, 0x04, 0x1E,
+  0x01, 0x04, 0x03, 0x0E, 0x04, 0x0D, 0x01, 0x04, 0x03, 0x0C, 0x08, 0x0C, 0x01, 0x04, 0x02, 0x0C,
+  0x0A, 0x0B, 0x01, 0x04, 0x02, 0x0C, 0x0A, 0x0C, 0x01, 0x04, 0x02, 0x0B, 0x0C, 0x0B, 0x01, 0x04,
+  0x01, 0x0C, 0x0C, 0x0B, 0x01, 0x04, 0x01, 0x0C, 0x0C, 0x0C, 0x01, 0x04, 0x01, 0x0B, 0x0D, 0x0C,
+  0x01, 0x04, 0x01, 0x0B, 0x0E, 0x0B, 0x02, 0x04, 0x00, 0x0C, 0x0E, 0x0B, 0x0B, 0x04, 0x00, 0x0C,
+  0x0E, 0x0C, 0x01, 0x04, 0x00, 0x0C, 0x0E, 0x0B, 0x01, 0x04, 0x01, 0x0B, 0x0E, 0x0B, 0x01, 0x04,
+  0x01, 0x0B, 0x0D, 0x0C, 0x01, 0x04, 0x01, 0x0C, 0x0C, 0x0C, 0x01, 0x04, 0x01, 0x0C, 0x0C, 0x0B,
+  0x01, 0x04, 0x02, 0x0B, 0x0C, 0x0B, 0x01, 0x04, 0x02, 0x0C, 0x0A, 0x0C, 0x01, 0x04, 0x02, 0x0C,
+  0x0A, 0x0B, 0x01, 0x04, 0x03, 0x0C, 0x08, 0x0C, 0x01, 0x04, 0x03, 0x0E, 0x04, 0x0D, 0x01, 0x02,
+  0x04, 0x1E, 0x01, 0x02, 0x05, 0x1C, 0x01, 0x02, 0x06, 0x1A, 0x01, 0x02, 0x07, 0x18, 0x01, 0x02,
+  0x08, 0x16, 0x01, 0x02, 0x09, 0x14, 0x01, 0x02, 0x0B, 0x10, 0x01, 0x02, 0x0E, 0x0A,
+  // '1' 33x46
+  0x01, 0x02, 0x08, 0x0E, 0x01, 0x02, 0x03, 0x13, 0x06, 0x02, 0x00, 0x16, 0x01, 0x04, 0x00, 0x08,
+  0x03, 0x0B, 0x01, 0x04, 0x00, 0x03, 0x08, 0x0B, 0x1C, 0x02, 0x0B, 0x0B, 0x08, 0x02, 0x00, 0x21,
+  // '2' 33x47
+  0x01, 0x02, 0x0A, 0x0B, 0x01, 0x02, 0x05, 0x14, 0x01, 0x02, 0x02, 0x19, 0x01, 0x02, 0x00, 0x1C,
+  0x01, 0x02, 0x00, 0x1D, 0x01, 0x02, 0x00, 0x1E, 0x01, 0x02, 0x00, 0x1F, 0x01, 0x02, 0x00, 0x20,
+  0x01, 0x04, 0x00, 0x0A, 0x06, 0x10, 0x01, 0x04, 0x00, 0x07, 0x0B, 0x0E, 0x01, 0x04, 0x00, 0x04,
+  0x0F, 0x0E, 0x01, 0x04, 0x00, 0x03, 0x11, 0x0D, 0x01, 0x04, 0x00, 0x01, 0x14, 0x0C, 0x05, 0x02,
+  0x15, 0x0C, 0x02, 0x02, 0x14, 0x0C, 0x02, 0x02, 0x13, 0x0C, 0x01, 0x02, 0x12, 0x0C, 0x01, 0x02,
+  0x11, 0x0C, 0x01, 0x02, 0x0F, 0x0D, 0x01, 0x02, 0x0E, 0x0D, 0x01, 0x02, 0x0D, 0x0D, 0x01, 0x02,
+  0x0C, 0x0D, 0x01, 0x02, 0x0B, 0x0D, 0x01, 0x02, 0x0A, 0x0D, 0x01, 0x02, 0x09, 0x0D, 0x01, 0x02,
+  0x07, 0x0E, 0x01, 0x02, 0x06, 0x0D, 0x01, 0x02, 0x05, 0x0D, 0x01, 0x02, 0x04, 0x0D, 0x01, 0x02,
+  0x03, 0x0D, 0x01, 0x02, 0x02, 0x0D, 0x01, 0x02, 0x01, 0x0D, 0x09, 0x02, 0x00, 0x21,
+  // '3' 35x48
+  0x01, 0x02, 0x09, 0x0D, 0x01, 0x02, 0x04, 0x16, 0x01, 0x02, 0x02, 0x1B, 0x01, 0x02, 0x02, 0x1C,
+  0x01, 0x02, 0x02, 0x1D, 0x01, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x02, 0x1F, 0x01, 0x04, 0x02, 0x07,
+  0x09, 0x0F, 0x01, 0x04, 0x02, 0x04, 0x0E, 0x0E, 0x01, 0x04, 0x02, 0x01, 0x12, 0x0D, 0x03, 0x02,
+  0x16, 0x0C, 0x01, 0x02, 0x16, 0x0B, 0x02, 0x02, 0x15, 0x0C, 0x01, 0x02, 0x14, 0x0C, 0x01, 0x02,
+  0x12, 0x0D, 0x01, 0x02, 0x08, 0x16, 0x01, 0x02, 0x08, 0x15, 0x01, 0x02, 0x08, 0x12, 0x01, 0x02,
+  0x08, 0x13, 0x01, 0x02, 0x08, 0x15, 0x01, 0x02, 0x08, 0x17, 0x01, 0x02, 0x08, 0x18, 0x01, 0x02,
+  0x08, 0x19, 0x01, 0x02, 0x12, 0x0F, 0x01, 0x02, 0x14, 0x0E, 0x01, 0x02, 0x15, 0x0D, 0x01, 0x02,
+  0x16, 0x0C, 0x05, 0x02, 0x17, 0x0C, 0x01, 0x02, 0x16, 0x0D, 0x01, 0x04, 0x00, 0x01, 0x14, 0x0D,
+  0x01, 0x04, 0x00, 0x04, 0x10, 0x0E, 0x01, 0x04, 0x00, 0x08, 0x0A, 0x10, 0x02, 0x02, 0x00, 0x21,
+  0x01, 0x02, 0x00, 0x20, 0x01, 0x02, 0x00, 0x1F, 0x01, 0x02, 0x00, 0x1D, 0x01, 0x02, 0x00, 0x1C,
+  0x01, 0x02, 0x02, 0x17, 0x01, 0x02, 0x07, 0x0E,
+  // '4' 38x46
+  0x01, 0x02, 0x12, 0x0D, 0x02, 0x02, 0x11, 0x0E, 0x01, 0x02, 0x10, 0x0F, 0x01, 0x02, 0x0F, 0x10,
+  0x02, 0x02, 0x0E, 0x11, 0x01, 0x02, 0x0D, 0x12, 0x02, 0x02, 0x0C, 0x13, 0x01, 0x02, 0x0B, 0x14,
+  0x01, 0x04, 0x0A, 0x09, 0x01, 0x0B, 0x01, 0x04, 0x0A, 0x08, 0x02, 0x0B, 0x01, 0x04, 0x09, 0x09,
+  0x02, 0x0B, 0x01, 0x04, 0x08, 0x09, 0x03, 0x0B, 0x01, 0x04, 0x08, 0x08, 0x04, 0x0B, 0x01, 0x04,
+  0x07, 0x09, 0x04, 0x0B, 0x01, 0x04, 0x06, 0x09, 0x05, 0x0B, 0x01, 0x04, 0x06, 0x08, 0x06, 0x0B,
+  0x01, 0x04, 0x05, 0x09, 0x06, 0x0B, 0x01, 0x04, 0x04, 0x09, 0x07, 0x0B, 0x01, 0x04, 0x04, 0x08,
+  0x08, 0x0B, 0x01, 0x04, 0x03, 0x09, 0x08, 0x0B, 0x01, 0x04, 0x02, 0x09, 0x09, 0x0B, 0x01, 0x04,
+  0x02, 0x08, 0x0A, 0x0B, 0x01, 0x04, 0x01, 0x09, 0x0A, 0x0B, 0x01, 0x04, 0x00, 0x09, 0x0B, 0x0B,
+  0x02, 0x04, 0x00, 0x08, 0x0C, 0x0B, 0x08, 0x02, 0x00, 0x26, 0x09, 0x02, 0x14, 0x0B,
+  // '5' 34x47
+  0x09, 0x02, 0x02, 0x1D, 0x06, 0x02, 0x02, 0x09, 0x01, 0x04, 0x02, 0x09, 0x01, 0x0A, 0x01, 0x02,
+  0x02, 0x17, 0x01, 0x02, 0x02, 0x19, 0x01, 0x02, 0x02, 0x1B, 0x01, 0x02, 0x02, 0x1C, 0x01, 0x02,
+  0x02, 0x1D, 0x02, 0x02, 0x02, 0x1E, 0x01, 0x04, 0x02, 0x07, 0x08, 0x10, 0x01, 0x04, 0x02, 0x03,
+  0x0E, 0x0E, 0x01, 0x04, 0x02, 0x01, 0x11, 0x0E, 0x01, 0x02, 0x15, 0x0D, 0x03, 0x02, 0x16, 0x0C,
+  0x02, 0x02, 0x17, 0x0B, 0x03, 0x02, 0x16, 0x0C, 0x01, 0x04, 0x00, 0x01, 0x14, 0x0D, 0x01, 0x04,
+  0x00, 0x03, 0x11, 0x0E, 0x01, 0x04, 0x00, 0x06, 0x0D, 0x0E, 0x01, 0x04, 0x00, 0x09, 0x08, 0x10,
+  0x01, 0x02, 0x00, 0x20, 0x02, 0x02, 0x00, 0x1F, 0x01, 0x02, 0x00, 0x1E, 0x01, 0x02, 0x00, 0x1C,
+  0x01, 0x02, 0x01, 0x1A, 0x01, 0x02, 0x04, 0x15, 0x01, 0x02, 0x09, 0x0C,
+  // '6' 36x48
+  0x01, 0x02, 0x10, 0x0B, 0x01, 0x02, 0x0D, 0x13, 0x01, 0x02, 0x0B, 0x16, 0x01, 0x02, 0x09, 0x18,
+  0x01, 0x02, 0x08, 0x19, 0x01, 0x02, 0x07, 0x1A, 0x01, 0x02, 0x06, 0x1B, 0x01, 0x02, 0x05, 0x1C,
+  0x01, 0x04, 0x04, 0x0F, 0x08, 0x06, 0x01, 0x04, 0x04, 0x0D, 0x0D, 0x03, 0x01, 0x04, 0x03, 0x0C,
+  0x11, 0x01, 0x02, 0x02, 0x02, 0x0C, 0x01, 0x02, 0x02, 0x0B, 0x03, 0x02, 0x01, 0x0B, 0x01, 0x04,
+  0x01, 0x0B, 0x05, 0x08, 0x01, 0x04, 0x00, 0x0B, 0x03, 0x0E, 0x01, 0x04, 0x00, 0x0B, 0x01, 0x12,
+  0x01, 0x02, 0x00, 0x1F, 0x02, 0x02, 0x00, 0x21, 0x01, 0x02, 0x00, 0x22, 0x01, 0x02, 0x00, 0x23,
+  0x01, 0x04, 0x00, 0x10, 0x06, 0x0D, 0x01, 0x04, 0x00, 0x0F, 0x08, 0x0D, 0x01, 0x04, 0x00, 0x0E,
+  0x0A, 0x0C, 0x01, 0x04, 0x00, 0x0D, 0x0B, 0x0C, 0x03, 0x04, 0x00, 0x0D, 0x0C, 0x0B, 0x04, 0x04,
+  0x01, 0x0C, 0x0C, 0x0B, 0x01, 0x04, 0x02, 0x0B, 0x0B, 0x0C, 0x01, 0x04, 0x02, 0x0C, 0x0A, 0x0C,
+  0x01, 0x04, 0x03, 0x0C, 0x08, 0x0C, 0x01, 0x04, 0x03, 0x0D, 0x06, 0x0D, 0x01, 0x02, 0x04, 0x1E,
+  0x02, 0x02, 0x05, 0x1C, 0x01, 0x02, 0x06, 0x1A, 0x01, 0x02, 0x07, 0x18, 0x01, 0x02, 0x09, 0x14,
+  0x01, 0x02, 0x0B, 0x10, 0x01, 0x02, 0x0E, 0x0A,
+  // '7' 35x46
+  0x07, 0x02, 0x00, 0x23, 0x02, 0x02, 0x00, 0x22, 0x01, 0x02, 0x16, 0x0C, 0x01, 0x02, 0x16, 0x0B,
+  0x01, 0x02, 0x15, 0x0C, 0x01, 0x02, 0x15, 0x0B, 0x01, 0x02, 0x14, 0x0C, 0x01, 0x02, 0x14, 0x0B,
+  0x01, 0x02, 0x13, 0x0C, 0x01, 0x02, 0x13, 0x0B, 0x01, 0x02, 0x12, 0x0C, 0x02, 0x02, 0x12, 0x0B,
+  0x01, 0x02, 0x11, 0x0C, 0x01, 0x02, 0x11, 0x0B, 0x01, 0x02, 0x10, 0x0C, 0x01, 0x02, 0x10, 0x0B,
+  0x01, 0x02, 0x0F, 0x0C, 0x01, 0x02, 0x0F, 0x0B, 0x01, 0x02, 0x0E, 0x0C, 0x01, 0x02, 0x0E, 0x0B,
+  0x01, 0x02, 0x0D, 0x0C, 0x01, 0x02, 0x0D, 0x0B, 0x02, 0x02, 0x0C, 0x0C, 0x01, 0x02, 0x0C, 0x0B,
+  0x01, 0x02, 0x0B, 0x0C, 0x01, 0x02, 0x0B, 0x0B, 0x01, 0x02, 0x0A, 0x0C, 0x01, 0x02, 0x0A, 0x0B,
+  0x01, 0x02, 0x09, 0x0C, 0x01, 0x02, 0x09, 0x0B, 0x01, 0x02, 0x08, 0x0C, 0x01, 0x02, 0x08, 0x0B,
+  0x02, 0x02, 0x07, 0x0C, 0x01, 0x02, 0x07, 0x0B, 0x01, 0x02, 0x06, 0x0C, 0x01, 0x02, 0x06, 0x0B,
+  // '8' 36x48
+  0x01, 0x02, 0x0C, 0x0C, 0x01, 0x02, 0x08, 0x14, 0x01, 0x02, 0x06, 0x18, 0x01, 0x02, 0x05, 0x1A,
+  0x01, 0x02, 0x03, 0x1D, 0x01, 0x02, 0x03, 0x1E, 0x02, 0x02, 0x02, 0x20, 0x01, 0x04, 0x01, 0x0E,
+  0x06, 0x0E, 0x01, 0x04, 0x01, 0x0C, 0x09, 0x0D, 0x01, 0x04, 0x01, 0x0C, 0x0A, 0x0C, 0x04, 0x04,
+  0x01, 0x0B, 0x0C, 0x0B, 0x01, 0x04, 0x02, 0x0B, 0x0A, 0x0B, 0x01, 0x04, 0x02, 0x0B, 0x09, 0x0C,
+  0x01, 0x04, 0x03, 0x0C, 0x06, 0x0C, 0x01, 0x02, 0x03, 0x1D, 0x01, 0x02, 0x05, 0x1A, 0x01, 0x02,
+  0x06, 0x18, 0x01, 0x02, 0x08, 0x13, 0x01, 0x02, 0x07, 0x15, 0x01, 0x02, 0x05, 0x19, 0x01, 0x02,
+  0x04, 0x1C, 0x01, 0x02, 0x03, 0x1E, 0x01, 0x04, 0x02, 0x0D, 0x06, 0x0D, 0x01, 0x04, 0x01, 0x0C,
+  0x0A, 0x0B, 0x01, 0x04, 0x01, 0x0B, 0x0C, 0x0B, 0x01, 0x04, 0x00, 0x0C, 0x0C, 0x0B, 0x01, 0x04,
+  0x00, 0x0B, 0x0D, 0x0C, 0x04, 0x04, 0x00, 0x0B, 0x0E, 0x0B, 0x01, 0x04, 0x00, 0x0B, 0x0D, 0x0C,
+  0x02, 0x04, 0x00, 0x0C, 0x0C, 0x0C, 0x01, 0x04, 0x00, 0x0D, 0x0A, 0x0C, 0x01, 0x04, 0x01, 0x0E,
+  0x06, 0x0E, 0x01, 0x02, 0x01, 0x21, 0x01, 0x02, 0x02, 0x20, 0x01, 0x02, 0x03, 0x1E, 0x01, 0x02,
+  0x03, 0x1D, 0x01, 0x02, 0x05, 0x1A, 0x01, 0x02, 0x06, 0x18, 0x01, 0x02, 0x08, 0x14, 0x01, 0x02,
+  0x0C, 0x0C,
+  // '9' 37x48
+  0x01, 0x02, 0x0D, 0x0A, 0x01, 0x02, 0x0A, 0x10, 0x01, 0x02, 0x08, 0x14, 0x01, 0x02, 0x06, 0x17,
+  0x01, 0x02, 0x05, 0x19, 0x01, 0x02, 0x04, 0x1B, 0x01, 0x02, 0x03, 0x1D, 0x01, 0x02, 0x03, 0x1E,
+  0x01, 0x04, 0x02, 0x0D, 0x06, 0x0C, 0x01, 0x04, 0x02, 0x0C, 0x08, 0x0C, 0x01, 0x04, 0x01, 0x0C,
+  0x0A, 0x0B, 0x01, 0x04, 0x01, 0x0B, 0x0B, 0x0C, 0x01, 0x04, 0x01, 0x0B, 0x0C, 0x0B, 0x05, 0x04,
+  0x00, 0x0C, 0x0C, 0x0C, 0x01, 0x04, 0x00, 0x0C, 0x0C, 0x0D, 0x01, 0x04, 0x01, 0x0B, 0x0B, 0x0E,
+  0x01, 0x04, 0x01, 0x0C, 0x0A, 0x0E, 0x01, 0x04, 0x01, 0x0D, 0x08, 0x0F, 0x01, 0x04, 0x01, 0x0E,
+  0x06, 0x10, 0x01, 0x02, 0x02, 0x23, 0x02, 0x02, 0x03, 0x22, 0x01, 0x02, 0x04, 0x21, 0x01, 0x02,
+  0x05, 0x20, 0x01, 0x04, 0x07, 0x11, 0x01, 0x0B, 0x01, 0x04, 0x08, 0x0F, 0x02, 0x0B, 0x01, 0x04,
+  0x0B, 0x09, 0x05, 0x0B, 0x02, 0x02, 0x19, 0x0B, 0x02, 0x02, 0x18, 0x0B, 0x01, 0x02, 0x17, 0x0C,
+  0x01, 0x02, 0x16, 0x0C, 0x01, 0x04, 0x03, 0x01, 0x11, 0x0D, 0x01, 0x04, 0x03, 0x04, 0x0D, 0x0D,
+  0x01, 0x04, 0x03, 0x07, 0x08, 0x0F, 0x01, 0x02, 0x03, 0x1D, 0x01, 0x02, 0x03, 0x1C, 0x01, 0x02,
+  0x03, 0x1B, 0x01, 0x02, 0x03, 0x1A, 0x01, 0x02, 0x03, 0x19, 0x01, 0x02, 0x04, 0x16, 0x01, 0x02,
+  0x07, 0x11, 0x01, 0x02, 0x0A, 0x0A,
+  // '°' 20x20
+  0x01, 0x02, 0x07, 0x06, 0x01, 0x02, 0x04, 0x0B, 0x01, 0x02, 0x03, 0x0D, 0x01, 0x02, 0x02, 0x0F,
+  0x01, 0x02, 0x01, 0x11, 0x01, 0x04, 0x01, 0x06, 0x05, 0x07, 0x01, 0x04, 0x00, 0x06, 0x07, 0x06,
+  0x01, 0x04, 0x00, 0x05, 0x09, 0x06, 0x02, 0x04, 0x00, 0x05, 0x0A, 0x05, 0x01, 0x04, 0x00, 0x04,
+  0x0B, 0x05, 0x01, 0x04, 0x00, 0x05, 0x0A, 0x05, 0x01, 0x04, 0x00, 0x05, 0x09, 0x06, 0x01, 0x04,
+  0x00, 0x06, 0x08, 0x05, 0x01, 0x04, 0x01, 0x06, 0x05, 0x07, 0x01, 0x02, 0x01, 0x11, 0x01, 0x02,
+  0x02, 0x10, 0x01, 0x02, 0x03, 0x0D, 0x01, 0x02, 0x04, 0x0B, 0x01, 0x02, 0x06, 0x07,
+};
+
+const CompactGlyph TemperatureFont48Glyphs[] PROGMEM = {
+  // offset, codepoint, width, height, x_advance, x_offset, y_offset
+  {     0, 0x002D,  20,   9,  26,   3,  -23 },  // '-'
+  {     4, 0x002E,  12,  12,  24,   6,  -12 },  // '.'
+  {     8, 0x0030,  38,  48,  44,   3,  -47 },  // '0'
+  {   198, 0x0031,  33,  46,  44,   7,  -46 },  // '1'
+  {   230, 0x0032,  33,  47,  44,   5,  -47 },  // '2'
+  {   372, 0x0033,  35,  48,  44,   4,  -47 },  // '3'
+  {   540, 0x0034,  38,  46,  44,   3,  -46 },  // '4'
+  {   682, 0x0035,  34,  47,  44,   5,  -46 },  // '5'
+  {   806, 0x0036,  36,  48,  44,   4,  -47 },  // '6'
+  {   990, 0x0037,  35,  46,  44,   4,  -46 },  // '7'
+  {  1134, 0x0038,  36,  48,  44,   4,  -47 },  // '8'
+  {  1328, 0x0039,  37,  48,  44,   3,  -47 },  // '9'
+  {  1526, 0x00B0,  20,  20,  32,   6,  -47 },  // '°'
+};
+
+const CompactFont TemperatureFont48 = {
+  TemperatureFont48Data,
+  TemperatureFont48Glyphs,
+  13,  // glyph_count
+  74,  // y_advance
+};
+
+#endif // TEMPERATURE_FONT48_H
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+# Compare host benchmark results (bench/host/bench_host.cpp --json) against the
+# committed baseline and exit non-zero if any metric regressed past its
+# threshold. Thresholds are relative and live in the baseline file.
+#
+#   scripts/compare_bench.py bench/host/baseline.json .pio/bench_results.json
+#   scripts/compare_bench.py --update bench/host/baseline.json .pio/bench_results.json
+#
+# --update records the results as the new baseline for the benchmarks that ran.
+# A benchmark without baseline numbers (null or missing) fails the comparison,
+# so a suite that was never recorded can't pass as "no regressions".
+import argparse
+import json
+import sys
+
+METRICS = ("time_ns", "allocations", "peak_heap_bytes")
+
+# Absolute slack on top of the relative threshold, so deterministic counts
+# near zero don't flag rounding
+SLACK = {"time_ns": 0, "allocations": 0.5, "peak_heap_bytes": 64}
+
+
+def compare(baseline, results):
+    thresholds = baseline["thresholds"]
+    regressions = 0
+    unrecorded = 0
+    print("%-60s %-16s %14s %14s %9s" % ("benchmark", "metric", "baseline", "result", "change"))
+    for name, result in sorted(results["benchmarks"].items()):
+        expected = baseline["benchmarks"].get(name) or {}
+        for metric in METRICS:
+            value = result[metric]
+            reference = expected.get(metric)
+            if reference is None:
+                print("%-60s %-16s %14s %14.1f %9s  NO BASELINE" % (name, metric, "-", value, "-"))
+                unrecorded += 1
+                continue
+
+            limit = reference * (1 + thresholds[metric]) + SLACK[metric]
+            change = (value - reference) / reference * 100 if reference else 0.0
+            flag = ""
+            if value > limit:
+                flag = "  REGRESSION"
+                regressions += 1
+            print("%-60s %-16s %14.1f %14.1f %+8.1f%%%s" % (name, metric, reference, value, change, flag))
+
+    for name in sorted(set(baseline["benchmarks"]) - set(results["benchmarks"])):
+        print("%-60s missing from results" % name)
+    return regressions, unrecorded
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare host benchmark results against a baseline")
+    parser.add_argument("baseline", help="Committed baseline JSON")
+    parser.add_argument("results", help="Results JSON written by the benchmark runner")
+    parser.add_argument("--update", action="store_true", help="Write the results into the baseline")
+    args = parser.parse_args()
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    with open(args.results) as f:
+        results = json.load(f)
+
+    if args.update:
+        for name, result in results["benchmarks"].items():
+            baseline["benchmarks"][name] = {metric: result[metric] for metric in METRICS}
+        baseline["benchmarks"] = dict(sorted(baseline["benchmarks"].items()))
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=2)
+            f.write("\n")
+        print("Updated %d benchmarks in %s" % (len(results["benchmarks"]), args.baseline))
+        return 0
+
+    regressions, unrecorded = compare(baseline, results)
+    if unrecorded:
+        print("%d metric(s) without a baseline; record them with --update on the reference machine" % unrecorded)
+    if regressions:
+        print("%d regression(s) past threshold" % regressions)
+    return 1 if regressions or unrecorded else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
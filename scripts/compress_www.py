@@ -0,0 +1,31 @@
+# PlatformIO pre-build script: gzip the web assets in data/www so the servers can
+# send "<file>.gz" to clients that accept gzip. Only stale files are rewritten,
+# and the gzip header carries no timestamp so the output is reproducible.
+import gzip
+import os
+
+Import("env")  # noqa: F821 - provided by PlatformIO
+
+COMPRESSED_EXTENSIONS = (".html", ".css", ".js", ".json", ".svg")
+
+
+def compress_www(www_dir):
+    for root, _, files in os.walk(www_dir):
+        for name in files:
+            if not name.endswith(COMPRESSED_EXTENSIONS):
+                continue
+
+            source = os.path.join(root, name)
+            target = source + ".gz"
+            if os.path.exists(target) and os.path.getmtime(target) >= os.path.getmtime(source):
+                continue
+
+            with open(source, "rb") as f:
+                data = f.read()
+            with open(target, "wb") as f:
+                with gzip.GzipFile(filename="", mode="wb", fileobj=f, compresslevel=9, mtime=0) as gz:
+                    gz.write(data)
+            print("Compressed %s: %d -> %d bytes" % (source, len(data), os.path.getsize(target)))
+
+
+compress_www(os.path.join(env.subst("$PROJECT_DATA_DIR"), "www"))  # noqa: F821
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+# Generate a CompactFont header (see include/CompactFont.h) from a TrueType font.
+#
+# Only the requested characters are rendered, at the exact pixel size the layout
+# needs, so large text is drawn natively instead of scaling a small GFX font.
+# Each glyph is stored as groups of identical rows; a group is
+#
+#   [row count] [run count] [run lengths...]
+#
+# where runs alternate background/ink starting with background, and trailing
+# background is omitted. Runs longer than 255 are split with a zero-length run.
+#
+# Requires Pillow. Example (the committed temperature font):
+#
+#   scripts/generate_font.py DejaVuSans-Bold.ttf --cap-height 48 \
+#       --chars "0123456789.-°" --name TemperatureFont48 \
+#       --output include/fonts/TemperatureFont48.h
+import argparse
+import os
+
+from PIL import Image, ImageDraw, ImageFont
+
+
+def find_size(path, cap_height):
+    # Pick the point size whose digit height matches the requested pixel height
+    for size in range(cap_height, cap_height * 3):
+        font = ImageFont.truetype(path, size)
+        left, top, right, bottom = font.getbbox("0", anchor="ls")
+        if bottom - top >= cap_height:
+            return size
+    raise SystemExit("No size found for cap height %d" % cap_height)
+
+
+def render_glyph(font, char, threshold):
+    left, top, right, bottom = font.getbbox(char, anchor="ls")
+    width, height = max(right - left, 0), max(bottom - top, 0)
+    rows = []
+    if width and height:
+        image = Image.new("L", (width, height), 0)
+        ImageDraw.Draw(image).text((-left, -top), char, font=font, fill=255, anchor="ls")
+        # The layout box can extend past the ink (e.g. down to the baseline); trim it
+        ink = image.point(lambda value: 255 if value >= threshold else 0).getbbox()
+        if ink:
+            image = image.crop(ink)
+            left, top = left + ink[0], top + ink[1]
+            width, height = image.size
+            pixels = image.load()
+            rows = [[pixels[x, y] >= threshold for x in range(width)] for y in range(height)]
+        else:
+            width = height = 0
+    advance = int(round(font.getlength(char)))
+    return width, height, advance, left, top, rows
+
+
+def encode_row(row):
+    runs = []
+    color = False
+    length = 0
+    for pixel in row:
+        if pixel == color:
+            length += 1
+        else:
+            runs.append(length)
+            color = pixel
+            length = 1
+    if color:
+        runs.append(length)
+
+    encoded = []
+    for run in runs:
+        while run > 255:
+            encoded += [255, 0]
+            run -= 255
+        encoded.append(run)
+    return encoded
+
+
+def encode_glyph(rows):
+    data = []
+    y = 0
+    while y < len(rows):
+        count = 1
+        while y + count < len(rows) and count < 255 and rows[y + count] == rows[y]:
+            count += 1
+        runs = encode_row(rows[y])
+        if len(runs) > 255:
+            raise SystemExit("Row too complex to encode")
+        data += [count, len(runs)] + runs
+        y += count
+    return data
+
+
+def c_char(char):
+    return char if char.isprintable() and char not in "\\'" else "U+%04X" % ord(char)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("font", help="TrueType font file")
+    parser.add_argument("--cap-height", type=int, required=True, help="Height of the digits in pixels")
+    parser.add_argument("--chars", required=True, help="Characters to include")
+    parser.add_argument("--name", required=True, help="C identifier for the font")
+    parser.add_argument("--output", required=True, help="Header file to write")
+    parser.add_argument("--threshold", type=int, default=128, help="Ink threshold (0-255)")
+    args = parser.parse_args()
+
+    size = find_size(args.font, args.cap_height)
+    font = ImageFont.truetype(args.font, size)
+    ascent, descent = font.getmetrics()
+
+    data = []
+    glyphs = []
+    for char in sorted(set(args.chars), key=ord):
+        width, height, advance, x_offset, y_offset, rows = render_glyph(font, char, args.threshold)
+        glyphs.append((len(data), ord(char), width, height, advance, x_offset, y_offset, char))
+        data += encode_glyph(rows)
+
+    guard = "%s_H" % "".join("_" + c if c.isupper() and i else c for i, c in enumerate(args.name)).upper()
+    lines = [
+        "// Generated by scripts/generate_font.py - do not edit.",
+        "// %s at %d px (digit height %d px), %d glyphs, %d bytes of run data." % (
+            os.path.basename(args.font), size, args.cap_height, len(glyphs), len(data)),
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        '#include "CompactFont.h"',
+        "",
+        "const uint8_t %sData[] PROGMEM = {" % args.name,
+    ]
+    for start, _, width, height, _, _, _, char in glyphs:
+        end = next((g[0] for g in glyphs if g[0] > start), len(data))
+        chunk = data[start:end]
+        lines.append("  // '%s' %dx%d" % (c_char(char), width, height))
+        for i in range(0, len(chunk), 16):
+            lines.append("  " + ", ".join("0x%02X" % b for b in chunk[i:i + 16]) + ",")
+    lines += [
+        "};",
+        "",
+        "const CompactGlyph %sGlyphs[] PROGMEM = {" % args.name,
+        "  // offset, codepoint, width, height, x_advance, x_offset, y_offset",
+    ]
+    for start, codepoint, width, height, advance, x_offset, y_offset, char in glyphs:
+        lines.append("  { %5d, 0x%04X, %3d, %3d, %3d, %3d, %4d },  // '%s'" % (
+            start, codepoint, width, height, advance, x_offset, y_offset, c_char(char)))
+    lines += [
+        "};",
+        "",
+        "const CompactFont %s = {" % args.name,
+        "  %sData," % args.name,
+        "  %sGlyphs," % args.name,
+        "  %d,  // glyph_count" % len(glyphs),
+        "  %d,  // y_advance" % (ascent + descent),
+        "};",
+        "",
+        "#endif // %s" % guard,
+        "",
+    ]
+
+    os.makedirs(os.path.dirname(args.output) or ".", exist_ok=True)
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines))
+    print("Wrote %s: %d glyphs, %d bytes of run data, %d bytes of glyph table" % (
+        args.output, len(glyphs), len(data), len(glyphs) * 10))
+
+
+if __name__ == "__main__":
+    main()
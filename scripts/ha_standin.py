@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+# Local stand-in for the Home Assistant websocket API, for measuring the
+# device's traffic without a real instance. Point the device's Home Assistant
+# URL at ws://<this machine>:8123/api/websocket (any token is accepted unless
+# --token is given).
+#
+# It speaks just enough of the API for the firmware: auth, subscribe_entities
+# (a snapshot from bench/host/payloads, then a temperature diff every
+# --interval seconds), render_template, subscribe_trigger and ping. When the
+# client asks for coalesce_messages (supported_features), the replies to a
+# request go out as one JSON array frame; --no-coalesce declines. Each sent
+# message is logged with its JSON size and its size on the wire, so runs with
+# and without permessage-deflate can be compared. The device reports its side
+# (bytes received, inflate time per message) under "websocket" in /api/metrics.
+#
+#   scripts/ha_standin.py                  # permessage-deflate if offered
+#   scripts/ha_standin.py --no-deflate     # always uncompressed
+#
+# With --cert/--key it serves wss:// instead, issuing TLS 1.2 session tickets,
+# and logs whether each connection did a full handshake or resumed a session.
+# Put the printed SHA-256 fingerprint into the device's certificate fingerprint
+# setting, then compare "tls_handshake_ms" in /api/metrics after a cold boot
+# (full handshake) and after a deep sleep wake (resumed):
+#
+#   openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes \
+#       -days 365 -subj /CN=standin -keyout standin.key -out standin.pem
+#   scripts/ha_standin.py --cert standin.pem --key standin.key
+#
+# Standard library only.
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import os
+import random
+import ssl
+import struct
+import zlib
+
+ACCEPT_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+PAYLOAD_DIR = os.path.join(os.path.dirname(__file__), "..", "bench", "host", "payloads")
+
+
+def load_entities():
+    with open(os.path.join(PAYLOAD_DIR, "subscribe_entities_snapshot.json"), encoding="utf-8") as f:
+        return json.load(f)["event"]["a"]
+
+
+class Connection:
+    def __init__(self, reader, writer, args):
+        self.reader = reader
+        self.writer = writer
+        self.args = args
+        self.entities = load_entities()
+        self.compressor = None
+        self.window_bits = 15
+        self.context_takeover = not args.no_context_takeover
+        self.subscription = None
+        self.coalesce = False
+        self.json_bytes = 0
+        self.wire_bytes = 0
+        self.messages = 0
+
+    async def handshake(self):
+        request = await self.reader.readuntil(b"\r\n\r\n")
+        lines = request.decode("latin-1").split("\r\n")
+        headers = {}
+        for line in lines[1:]:
+            if ":" in line:
+                name, value = line.split(":", 1)
+                headers[name.strip().lower()] = value.strip()
+
+        accept = base64.b64encode(hashlib.sha1((headers["sec-websocket-key"] + ACCEPT_GUID).encode()).digest())
+        response = ["HTTP/1.1 101 Switching Protocols", "Upgrade: websocket", "Connection: Upgrade",
+                    "Sec-WebSocket-Accept: " + accept.decode()]
+
+        offer = headers.get("sec-websocket-extensions", "")
+        if not self.args.no_deflate and offer.startswith("permessage-deflate"):
+            parameters = ["permessage-deflate"]
+            for parameter in offer.split(",")[0].split(";")[1:]:
+                name, _, value = parameter.strip().partition("=")
+                if name == "server_max_window_bits":
+                    # zlib cannot produce raw streams with an 8-bit window
+                    self.window_bits = max(9, int(value or 15))
+                    parameters.append("server_max_window_bits=%d" % self.window_bits)
+            if not self.context_takeover:
+                parameters.append("server_no_context_takeover")
+            response.append("Sec-WebSocket-Extensions: " + "; ".join(parameters))
+            self.compressor = self.new_compressor()
+        print("Client connected, permessage-deflate %s" % (
+            "on (%d-bit window%s)" % (self.window_bits, "" if self.context_takeover else ", no context takeover")
+            if self.compressor else "off"))
+
+        self.writer.write(("\r\n".join(response) + "\r\n\r\n").encode())
+        await self.writer.drain()
+
+    def new_compressor(self):
+        return zlib.compressobj(self.args.level, zlib.DEFLATED, -self.window_bits)
+
+    async def send_all(self, messages):
+        # Several messages in one frame if the client accepts coalesced messages
+        if self.coalesce and len(messages) > 1:
+            await self.send(messages)
+        else:
+            for message in messages:
+                await self.send(message)
+
+    async def send(self, message):
+        # message is a dict, or a list of them sent as one coalesced frame
+        text = json.dumps(message, separators=(",", ":")).encode()
+        first = 0x81
+        payload = text
+        if self.compressor:
+            if not self.context_takeover:
+                self.compressor = self.new_compressor()
+            payload = self.compressor.compress(text) + self.compressor.flush(zlib.Z_SYNC_FLUSH)
+            payload = payload[:-4]  # Drop the 00 00 ff ff tail (RFC 7692)
+            first |= 0x40
+
+        if len(payload) < 126:
+            header = struct.pack("!BB", first, len(payload))
+        elif len(payload) < 65536:
+            header = struct.pack("!BBH", first, 126, len(payload))
+        else:
+            header = struct.pack("!BBQ", first, 127, len(payload))
+        self.writer.write(header + payload)
+        await self.writer.drain()
+
+        wire = len(header) + len(payload)
+        self.messages += 1
+        self.json_bytes += len(text)
+        self.wire_bytes += wire
+        if isinstance(message, list):
+            kind, request_id = "batch", "x%d" % len(message)
+        else:
+            kind, request_id = message["type"], message.get("id", "-")
+        print("-> %-7s id=%-3s %6d bytes JSON, %6d on the wire (%3d%%)" % (
+            kind, request_id, len(text), wire, 100 * wire // len(text)))
+
+    async def send_control(self, opcode, payload=b""):
+        self.writer.write(struct.pack("!BB", 0x80 | opcode, len(payload)) + payload)
+        await self.writer.drain()
+
+    async def read_message(self):
+        # Returns the text of the next data message, or None once closed
+        while True:
+            first, second = await self.reader.readexactly(2)
+            length = second & 0x7F
+            if length == 126:
+                length, = struct.unpack("!H", await self.reader.readexactly(2))
+            elif length == 127:
+                length, = struct.unpack("!Q", await self.reader.readexactly(8))
+            mask = await self.reader.readexactly(4) if second & 0x80 else b"\0\0\0\0"
+            data = bytes(b ^ mask[i % 4] for i, b in enumerate(await self.reader.readexactly(length)))
+
+            opcode = first & 0x0F
+            if opcode == 0x8:
+                await self.send_control(0x8, data[:2])
+                return None
+            if opcode == 0x9:
+                await self.send_control(0xA, data)
+            elif opcode == 0x1:
+                return data.decode()
+
+    async def handle(self, request):
+        kind = request.get("type")
+        request_id = request.get("id")
+        if kind == "auth":
+            if self.args.token is not None and request.get("access_token") != self.args.token:
+                await self.send({"type": "auth_invalid", "message": "Invalid access token or password"})
+                return False
+            await self.send({"type": "auth_ok", "ha_version": "2025.1.4"})
+        elif kind == "ping":
+            await self.send({"id": request_id, "type": "pong"})
+        elif kind == "supported_features":
+            self.coalesce = not self.args.no_coalesce and bool(request.get("features", {}).get("coalesce_messages"))
+            await self.send({"id": request_id, "type": "result", "success": True, "result": None})
+        elif kind == "subscribe_entities":
+            self.subscription = request_id
+            wanted = request.get("entity_ids") or list(self.entities)
+            await self.send_all([
+                {"id": request_id, "type": "result", "success": True, "result": None},
+                {"id": request_id, "type": "event",
+                 "event": {"a": {e: self.entities[e] for e in wanted if e in self.entities}}}])
+        elif kind == "render_template":
+            await self.send_all([
+                {"id": request_id, "type": "result", "success": True, "result": None},
+                {"id": request_id, "type": "event", "event": {
+                    "result": str(self.entities["weather.home"]["a"]["temperature"]),
+                    "listeners": {"all": False, "entities": ["weather.home"], "domains": [], "time": False}}}])
+        else:
+            # subscribe_trigger, subscribe_events, unsubscribe_events, ...
+            await self.send({"id": request_id, "type": "result", "success": True, "result": None})
+        return True
+
+    async def send_changes(self):
+        while True:
+            await asyncio.sleep(self.args.interval)
+            if self.subscription is None:
+                continue
+            weather = self.entities["weather.home"]
+            weather["a"]["temperature"] = round(weather["a"]["temperature"] + random.choice((-0.5, 0.5)), 1)
+            await self.send({"id": self.subscription, "type": "event", "event": {"c": {"weather.home": {
+                "+": {"a": {"temperature": weather["a"]["temperature"]}, "lu": 1737244814.40313}}}}})
+
+    def log_tls(self):
+        tls = self.writer.get_extra_info("ssl_object")
+        if tls is not None:
+            print("TLS %s handshake: %s, %s" % ("resumed" if tls.session_reused else "full",
+                                               tls.version(), tls.cipher()[0]))
+
+    async def run(self):
+        self.log_tls()
+        await self.handshake()
+        await self.send({"type": "auth_required", "ha_version": "2025.1.4"})
+        changes = asyncio.ensure_future(self.send_changes())
+        try:
+            while True:
+                text = await self.read_message()
+                if text is None:
+                    break
+                print("<- %s" % text[:100])
+                if not await self.handle(json.loads(text)):
+                    await self.send_control(0x8, struct.pack("!H", 1000))
+                    break
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            changes.cancel()
+            self.writer.close()
+            if self.json_bytes:
+                print("Client disconnected: %d messages, %d bytes JSON, %d on the wire (%d%%)" % (
+                    self.messages, self.json_bytes, self.wire_bytes, 100 * self.wire_bytes // self.json_bytes))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Home Assistant websocket stand-in")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8123)
+    parser.add_argument("--no-deflate", action="store_true", help="Decline permessage-deflate")
+    parser.add_argument("--no-context-takeover", action="store_true",
+                        help="Compress every message on its own (server_no_context_takeover)")
+    parser.add_argument("--no-coalesce", action="store_true", help="Ignore coalesce_messages requests")
+    parser.add_argument("--level", type=int, default=zlib.Z_DEFAULT_COMPRESSION, help="zlib compression level")
+    parser.add_argument("--interval", type=float, default=30, help="Seconds between entity diffs")
+    parser.add_argument("--token", help="Reject other access tokens with auth_invalid")
+    parser.add_argument("--cert", help="PEM certificate; serve wss:// with it")
+    parser.add_argument("--key", help="PEM private key for --cert")
+    args = parser.parse_args()
+
+    context = None
+    if args.cert:
+        context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        context.load_cert_chain(args.cert, args.key)
+        # The device resumes TLS 1.2 sessions (tickets are on by default)
+        context.maximum_version = ssl.TLSVersion.TLSv1_2
+        with open(args.cert, encoding="ascii") as f:
+            der = ssl.PEM_cert_to_DER_cert(f.read())
+        print("Certificate SHA-256 fingerprint: %s" % hashlib.sha256(der).hexdigest())
+
+    async def serve():
+        server = await asyncio.start_server(lambda r, w: Connection(r, w, args).run(), args.host, args.port,
+                                            ssl=context)
+        print("Listening on %s://%s:%d/api/websocket" % ("wss" if context else "ws", args.host, args.port))
+        async with server:
+            await server.serve_forever()
+
+    try:
+        asyncio.run(serve())
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -1,96 +1,12 @@
 #include "CaptivePortal.h"
+#include "HtmlTemplate.h"
+#include "StaticFiles.h"
 #include <LittleFS.h>
 
-CaptivePortal::CaptivePortal(ConfigManager& config_manager, DisplayManager* display)
-  : _config_manager(config_manager), 
-    _display(display), 
-    _web_server(WEB_PORT),
-    _restart_requested(false),
-    _portal_start_time(0) {
-}
-
-void CaptivePortal::begin(const String& ap_name) {
-  // Start the access point
-  WiFi.mode(WIFI_AP);
-  WiFi.softAP(ap_name.c_str());
-  
-  // Configure DNS server to redirect all domains to the ESP's IP
-  IPAddress ap_ip = WiFi.softAPIP();
-  _dns_server.start(DNS_PORT, "*", ap_ip);
-  
-  // Setup web server routes
-  setup_routes();
-  _web_server.begin();
-  
-  // Scan for networks
-  scan_networks();
-  
-  // Display message on ePaper
-  if (_display) {
-    _display->show_message(ap_name, "http://" + ap_ip.toString());
-  }
-  
-  // Record start time
-  _portal_start_time = millis();
-  
-  Log.infoln("Captive portal started. SSID: %s, IP: %s", ap_name.c_str(), ap_ip.toString().c_str());
-}
-
-void CaptivePortal::handle_client() {
-  // Process DNS requests
-  _dns_server.processNextRequest();
-  
-  // Process web server requests
-  _web_server.handleClient();
-  
-  // Check if portal timeout has been reached
-  if (_portal_start_time > 0 && millis() - _portal_start_time > TIMEOUT_MS) {
-    Log.infoln("Captive portal timeout reached. Restarting device...");
-    if (_display) {
-      _display->show_message("Portal Timeout", "Restarting...");
-    }
-    delay(2000);
-    ESP.restart();
-  }
-}
-
-bool CaptivePortal::should_restart() const {
-  return _restart_requested;
-}
-
-void CaptivePortal::setup_routes() {
-  // Root route (captive portal landing page)
-  _web_server.on("/", [this]() {
-    handle_root();
-  });
-  
-  // Route to handle saving configuration
-  _web_server.on("/save", HTTP_POST, [this]() {
-    handle_save_config();
-  });
-  
-  // CSS and JS static files
-  _web_server.on("/styles.css", [this]() {
-    serve_file_from_fs("/www/portal-styles.css", "text/css");
-  });
-  
-  _web_server.on("/script.js", [this]() {
-    serve_file_from_fs("/www/portal-script.js", "application/javascript");
-  });
-  
-  // Default handler for all other requests
-  _web_server.onNotFound([this]() {
-    handle_not_found();
-  });
-}
+namespace {
 
-void CaptivePortal::handle_root() {
-  // Prepare current values to pre-populate the form
-  String current_ssid = _config_manager.wifi_ssid;
-  String current_hass_url = _config_manager.hass_url;
-  String current_hass_token = _config_manager.hass_token;
-
-  String html = R"(
+// Portal landing page, streamed through HtmlTemplate
+const char PORTAL_PAGE[] = R"(
 <!DOCTYPE html>
 <html>
 <head>
@@ -108,15 +24,11 @@ void CaptivePortal::handle_root() {
     <form id="setupForm" action="/save" method="post">
       <div class="section">
         <h2>Available Networks</h2>
-        <div class="networks-list">)";
-  
-  html += _networks_list;
-  
-  html += R"(
+        <div class="networks-list">{{networks}}
         </div>
         <div class="form-group">
           <label for="ssid">WiFi Network:</label>
-          <input type="text" id="ssid" name="ssid" placeholder="Enter network name" value=")" + current_ssid + R"(">
+          <input type="text" id="ssid" name="ssid" placeholder="Enter network name" value="{{ssid}}">
         </div>
         <div class="form-group">
           <label for="password">WiFi Password:</label>
@@ -129,11 +41,11 @@ void CaptivePortal::handle_root() {
         <h2>Home Assistant Settings</h2>
         <div class="form-group">
           <label for="hass_url">Home Assistant WebSocket URL:</label>
-          <input type="text" id="hass_url" name="hass_url" placeholder="ws://homeassistant.local:8123/api/websocket" value=")" + current_hass_url + R"(">
+          <input type="text" id="hass_url" name="hass_url" placeholder="ws://homeassistant.local:8123/api/websocket" value="{{hass_url}}">
         </div>
         <div class="form-group">
           <label for="hass_token">Long-Lived Access Token:</label>
-          <input type="password" id="hass_token" name="hass_token" placeholder="Enter token" value=")" + current_hass_token + R"(">
+          <input type="password" id="hass_token" name="hass_token" placeholder="Enter token" value="{{hass_token}}">
           <small>Leave blank to keep current token</small>
         </div>
       </div>
@@ -146,57 +58,47 @@ void CaptivePortal::handle_root() {
 
   <script>
     document.addEventListener('DOMContentLoaded', function() {
-      // Handle network selection
-      const networkLinks = document.querySelectorAll('.network-item');
-      networkLinks.forEach(link => {
-        link.addEventListener('click', function(e) {
+      const list = document.querySelector('.networks-list');
+
+      // Handle network selection (the list is replaced as scans complete)
+      list.addEventListener('click', function(e) {
+        const item = e.target.closest('.network-item[ssid]');
+        if (item) {
           e.preventDefault();
-          document.getElementById('ssid').value = this.getAttribute('ssid').trim();
-        });
+          document.getElementById('ssid').value = item.getAttribute('ssid');
+        }
       });
+
+      // Poll for fresh scan results
+      function refreshNetworks() {
+        fetch('/api/networks')
+          .then(response => response.json())
+          .then(data => {
+            if (data.networks.length === 0) {
+              return;
+            }
+            list.replaceChildren(...data.networks.map(net => {
+              const item = document.createElement('div');
+              item.className = 'network-item';
+              item.setAttribute('ssid', net.ssid);
+              item.textContent = (net.secure ? '🔒 ' : '') + net.ssid;
+              const signal = document.createElement('span');
+              signal.className = 'signal';
+              signal.textContent = net.signal;
+              item.appendChild(signal);
+              return item;
+            }));
+          })
+          .catch(() => {});
+      }
+      setInterval(refreshNetworks, 5000);
     });
   </script>
 </body>
 </html>
-  )";
-  
-  _web_server.send(200, "text/html", html);
-}
+)";
 
-void CaptivePortal::handle_save_config() {
-  // Make sure we have the latest configuration before making changes
-  // This ensures we don't overwrite any settings that aren't part of the form
-  _config_manager.load_config();
-  
-  // Get form parameters
-  String ssid = _web_server.arg("ssid");
-  String password = _web_server.arg("password");
-  String hass_url = _web_server.arg("hass_url");
-  String hass_token = _web_server.arg("hass_token");
-  
-  // Update configuration - only change what was provided
-  if (ssid.length() > 0) {
-    _config_manager.wifi_ssid = ssid;
-  }
-  
-  if (password.length() > 0) {
-    _config_manager.wifi_password = password;
-  }
-  
-  if (hass_url.length() > 0) {
-    _config_manager.hass_url = hass_url;
-  }
-  
-  if (hass_token.length() > 0) {
-    _config_manager.hass_token = hass_token;
-  }
-  
-  // Save configuration
-  bool success = _config_manager.save_config();
-  
-  if (success) {
-    // Send success response
-    String html = R"(
+const char SETUP_COMPLETE_PAGE[] = R"(
 <!DOCTYPE html>
 <html>
 <head>
@@ -245,7 +147,7 @@ void CaptivePortal::handle_save_config() {
   <div class="container">
     <h1>Setup Complete!</h1>
     <p>Your WiFi settings have been saved.</p>
-    <p>The device will now restart and connect to your network.</p>
+    <p>The device will now connect to your network.</p>
     <div class="spinner"></div>
   </div>
   <script>
@@ -256,43 +158,10 @@ void CaptivePortal::handle_save_config() {
   </script>
 </body>
 </html>
-    )";
-    
-    _web_server.send(200, "text/html", html);
-    
-    // Show success on display
-    if (_display) {
-      _display->show_message("Setup Complete", "Connecting to: " + ssid);
-    }
-    
-    // Set restart flag
-    _restart_requested = true;
-  } else {
-    // Failed to save config
-    _web_server.send(500, "text/plain", "Failed to save configuration");
-  }
-}
-
-void CaptivePortal::handle_not_found() {
-  // For the captive portal to work, we redirect all requests to the root
-  _web_server.sendHeader("Location", String("http://") + WiFi.softAPIP().toString(), true);
-  _web_server.send(302, "text/plain", "");
-}
+)";
 
-bool CaptivePortal::serve_file_from_fs(const String& path, const String& content_type) {
-  if (LittleFS.exists(path)) {
-    File file = LittleFS.open(path, "r");
-    if (file) {
-      _web_server.streamFile(file, content_type);
-      file.close();
-      return true;
-    }
-  }
-  
-  // If we get here, serve a default response
-  if (content_type == "text/css") {
-    // Default CSS if file not found
-    _web_server.send(200, "text/css", R"(
+// Fallback stylesheet when /www/portal-styles.css is missing
+const char PORTAL_DEFAULT_CSS[] = R"(
       body {
         font-family: Arial, sans-serif;
         margin: 0;
@@ -369,7 +238,249 @@ bool CaptivePortal::serve_file_from_fs(const String& path, const String& content
         float: right;
         color: #888;
       }
-    )");
+)";
+
+}  // namespace
+
+CaptivePortal::CaptivePortal(ConfigManager& config_manager, DisplayManager* display)
+  : _config_manager(config_manager), 
+    _display(display), 
+    _config_saved(false),
+    _portal_start_time(0),
+    _running(false),
+    _setup_state(SETUP_NONE),
+    _network_count(0),
+    _scan_completed(false),
+    _last_scan_time(0) {
+  _networks_lock = xSemaphoreCreateMutex();
+  _setup_lock = xSemaphoreCreateMutex();
+  _setup_done = xSemaphoreCreateBinary();
+}
+
+CaptivePortal::~CaptivePortal() {
+  // Stops the HTTP server task before the lock it uses goes away
+  end();
+  vSemaphoreDelete(_networks_lock);
+  vSemaphoreDelete(_setup_lock);
+  vSemaphoreDelete(_setup_done);
+}
+
+void CaptivePortal::begin(const String& ap_name) {
+  // Start the access point (station interface stays up for background scans)
+  WiFi.mode(WIFI_AP_STA);
+  WiFi.softAP(ap_name.c_str());
+  
+  // Configure DNS server to redirect all domains to the ESP's IP
+  IPAddress ap_ip = WiFi.softAPIP();
+  _dns_server.start(DNS_PORT, "*", ap_ip);
+  
+  // Setup web server routes
+  setup_routes();
+  _web_server.begin(WEB_PORT);
+  
+  // Scan for networks in the background; the page fills in as results arrive
+  start_scan();
+  
+  // Display message on ePaper
+  if (_display) {
+    _display->show_message(ap_name, "http://" + ap_ip.toString());
+  }
+  
+  // Record start time
+  _portal_start_time = millis();
+  _running = true;
+  
+  Log.infoln("Captive portal started. SSID: %s, IP: %s", ap_name.c_str(), ap_ip.toString().c_str());
+}
+
+void CaptivePortal::handle_client() {
+  // Process DNS requests
+  _dns_server.processNextRequest();
+  
+  // Apply settings posted to /save
+  apply_pending_setup();
+  
+  // Collect finished scans and start the next one when due
+  update_scan();
+  
+  // Check if portal timeout has been reached
+  if (_portal_start_time > 0 && millis() - _portal_start_time > TIMEOUT_MS) {
+    Log.infoln("Captive portal timeout reached. Restarting device...");
+    if (_display) {
+      _display->show_message("Portal Timeout", "Restarting...");
+      _display->flush();
+    }
+    delay(2000);
+    ESP.restart();
+  }
+}
+
+bool CaptivePortal::config_saved() const {
+  return _config_saved;
+}
+
+void CaptivePortal::end() {
+  if (!_running) {
+    return;
+  }
+  _running = false;
+  _web_server.stop();
+  WiFi.scanDelete();
+  _dns_server.stop();
+  WiFi.softAPdisconnect(true);
+  _portal_start_time = 0;
+  Log.infoln("Captive portal stopped");
+}
+
+void CaptivePortal::setup_routes() {
+  // Root route (captive portal landing page)
+  _web_server.on("/", HTTP_GET, [this](HttpRequest& request) {
+    handle_root(request);
+  });
+  
+  // Route to handle saving configuration
+  _web_server.on("/save", HTTP_POST, [this](HttpRequest& request) {
+    handle_save_config(request);
+  });
+  
+  // Latest WiFi scan results, polled by the page
+  _web_server.on("/api/networks", HTTP_GET, [this](HttpRequest& request) {
+    handle_get_networks(request);
+  });
+  
+  // CSS and JS static files
+  _web_server.on("/styles.css", HTTP_GET, [this](HttpRequest& request) {
+    serve_file_from_fs(request, "/www/portal-styles.css", "text/css");
+  });
+  
+  _web_server.on("/script.js", HTTP_GET, [this](HttpRequest& request) {
+    serve_file_from_fs(request, "/www/portal-script.js", "application/javascript");
+  });
+  
+  // Default handler for all other requests
+  _web_server.on_not_found([this](HttpRequest& request) {
+    handle_not_found(request);
+  });
+}
+
+void CaptivePortal::handle_root(HttpRequest& request) {
+  // Stream the page, pre-populating the form with the current values
+  HtmlTemplate page(request);
+  page.render("text/html", PORTAL_PAGE, [this](const char* name, HtmlTemplate& out) {
+    if (strcmp(name, "networks") == 0) {
+      write_networks_html(out);
+    } else if (strcmp(name, "ssid") == 0) {
+      out.write_escaped(_config_manager.wifi_ssid);
+    } else if (strcmp(name, "hass_url") == 0) {
+      out.write_escaped(_config_manager.hass_url);
+    } else if (strcmp(name, "hass_token") == 0) {
+      out.write_escaped(_config_manager.hass_token);
+    }
+  });
+}
+
+void CaptivePortal::handle_save_config(HttpRequest& request) {
+  // Get form parameters
+  String ssid = request.arg("ssid");
+  String password = request.arg("password");
+  String hass_url = request.arg("hass_url");
+  String hass_token = request.arg("hass_token");
+  if (request.sent()) {
+    return;
+  }
+  
+  // Stage them for the main loop, which applies and saves them in
+  // apply_pending_setup(); the live configuration is never touched here
+  xSemaphoreTake(_setup_lock, portMAX_DELAY);
+  _pending_ssid = ssid;
+  _pending_password = password;
+  _pending_hass_url = hass_url;
+  _pending_hass_token = hass_token;
+  _setup_state = SETUP_PENDING;
+  xSemaphoreGive(_setup_lock);
+  
+  // Wait for the loop, so the page reports whether the save worked
+  unsigned long start = millis();
+  SetupState state;
+  while ((state = _setup_state) == SETUP_PENDING && millis() - start < SETUP_SAVE_TIMEOUT_MS) {
+    // Signalled after every save; a stale signal only costs another check
+    xSemaphoreTake(_setup_done, pdMS_TO_TICKS(100));
+  }
+  
+  if (state == SETUP_SAVED) {
+    // Send success response
+    HtmlTemplate page(request);
+    page.render("text/html", SETUP_COMPLETE_PAGE);
+    
+    // Let the main loop show it and hand over to normal operation (the
+    // display is only drawn from the loop)
+    _config_saved = true;
+  } else if (state == SETUP_PENDING) {
+    request.send(503, "text/plain", "Timed out waiting for the configuration to be saved");
+  } else {
+    // Failed to save config
+    request.send(500, "text/plain", "Failed to save configuration");
+  }
+}
+
+void CaptivePortal::apply_pending_setup() {
+  if (_setup_state != SETUP_PENDING) {
+    return;
+  }
+  
+  xSemaphoreTake(_setup_lock, portMAX_DELAY);
+  String ssid = _pending_ssid;
+  String password = _pending_password;
+  String hass_url = _pending_hass_url;
+  String hass_token = _pending_hass_token;
+  xSemaphoreGive(_setup_lock);
+  
+  // Make sure we have the latest configuration before making changes
+  // This ensures we don't overwrite any settings that aren't part of the form
+  _config_manager.load_config();
+  
+  // Update configuration - only change what was provided
+  if (ssid.length() > 0) {
+    ConfigManager::set_string(_config_manager.wifi_ssid, ssid);
+  }
+  
+  if (password.length() > 0) {
+    ConfigManager::set_string(_config_manager.wifi_password, password);
+  }
+  
+  if (hass_url.length() > 0) {
+    ConfigManager::set_string(_config_manager.hass_url, hass_url);
+  }
+  
+  if (hass_token.length() > 0) {
+    ConfigManager::set_string(_config_manager.hass_token, hass_token);
+  }
+  
+  // Save configuration
+  bool success = _config_manager.save_config();
+  
+  xSemaphoreTake(_setup_lock, portMAX_DELAY);
+  _setup_state = success ? SETUP_SAVED : SETUP_FAILED;
+  xSemaphoreGive(_setup_lock);
+  xSemaphoreGive(_setup_done);
+}
+
+void CaptivePortal::handle_not_found(HttpRequest& request) {
+  // For the captive portal to work, we redirect all requests to the root
+  request.send_header("Location", String("http://") + WiFi.softAPIP().toString());
+  request.send(302, "text/plain", "");
+}
+
+bool CaptivePortal::serve_file_from_fs(HttpRequest& request, const String& path, const char* content_type) {
+  if (StaticFiles::serve(request, path, content_type)) {
+    return true;
+  }
+  
+  // If we get here, serve a default response
+  if (strcmp(content_type, "text/css") == 0) {
+    // Default CSS if file not found
+    HtmlTemplate page(request);
+    page.render("text/css", PORTAL_DEFAULT_CSS);
     return true;
   }
   
@@ -377,63 +488,147 @@ bool CaptivePortal::serve_file_from_fs(const String& path, const String& content
   return false;
 }
 
-void CaptivePortal::scan_networks() {
-  // Clear old list
-  _networks_list = "";
+void CaptivePortal::start_scan() {
+  if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+    Log.warningln("WiFi scan could not be started");
+  }
+  _last_scan_time = millis();
+}
+
+void CaptivePortal::update_scan() {
+  int16_t found = WiFi.scanComplete();
+  if (found == WIFI_SCAN_RUNNING) {
+    return;
+  }
   
-  // Scan for networks
-  int networks = WiFi.scanNetworks();
-  Log.infoln("Found %d networks", networks);
+  if (found >= 0) {
+    store_scan_results(found);
+    WiFi.scanDelete();
+  }
   
-  if (networks == 0) {
-    _networks_list = "<div class='network-item'>No networks found</div>";
-  } else {
-    // Sort networks by RSSI (signal strength)
-    struct NetworkInfo {
-      String ssid;
-      int rssi;
-      bool isEncrypted;
-    };
-    
-    std::vector<NetworkInfo> networkList;
+  if (millis() - _last_scan_time > SCAN_INTERVAL_MS) {
+    start_scan();
+  }
+}
+
+void CaptivePortal::store_scan_results(int16_t found) {
+  // Build the new list, one entry per SSID with its strongest RSSI
+  PortalNetwork networks[MAX_NETWORKS];
+  uint8_t count = 0;
+  
+  for (int16_t i = 0; i < found; i++) {
+    String ssid = WiFi.SSID(i);
+    if (ssid.length() == 0) {  // Skip hidden networks
+      continue;
+    }
+    int8_t rssi = WiFi.RSSI(i);
     
-    for (int i = 0; i < networks; i++) {
-      if (WiFi.SSID(i).length() > 0) {  // Skip hidden networks
-        NetworkInfo net;
-        net.ssid = WiFi.SSID(i);
-        net.rssi = WiFi.RSSI(i);
-        net.isEncrypted = WiFi.encryptionType(i) != WIFI_AUTH_OPEN;
-        networkList.push_back(net);
+    PortalNetwork* slot = nullptr;
+    for (uint8_t j = 0; j < count; j++) {
+      if (ssid == networks[j].ssid) {
+        slot = &networks[j];
+        break;
       }
     }
-    
-    // Sort by signal strength
-    std::sort(networkList.begin(), networkList.end(), 
-      [](const NetworkInfo& a, const NetworkInfo& b) {
-        return a.rssi > b.rssi;
+    if (slot) {
+      if (rssi <= slot->rssi) {
+        continue;
       }
-    );
-    
-    // Generate HTML
-    for (const auto& net : networkList) {
-      String signalStrength;
-      if (net.rssi > -50) {
-        signalStrength = "Strong";
-      } else if (net.rssi > -70) {
-        signalStrength = "Good";
-      } else if (net.rssi > -80) {
-        signalStrength = "Fair";
-      } else {
-        signalStrength = "Weak";
+    } else if (count < MAX_NETWORKS) {
+      slot = &networks[count++];
+    } else {
+      // Full: replace the weakest entry if this one is stronger
+      slot = std::min_element(networks, networks + count,
+        [](const PortalNetwork& a, const PortalNetwork& b) {
+          return a.rssi < b.rssi;
+        });
+      if (rssi <= slot->rssi) {
+        continue;
       }
-      
-      String secureIcon = net.isEncrypted ? "🔒 " : "";
-      
-      _networks_list += "<div class='network-item' ssid='" + net.ssid + "'>" + secureIcon + net.ssid;
-      _networks_list += "<span class='signal'>" + signalStrength + "</span></div>";
     }
+    
+    ConfigManager::set_string(slot->ssid, ssid);
+    slot->rssi = rssi;
+    slot->secure = WiFi.encryptionType(i) != WIFI_AUTH_OPEN;
   }
   
-  // Free memory used by scan
-  WiFi.scanDelete();
-}
\ No newline at end of file
+  // Sort by signal strength
+  std::sort(networks, networks + count,
+    [](const PortalNetwork& a, const PortalNetwork& b) {
+      return a.rssi > b.rssi;
+    }
+  );
+  
+  xSemaphoreTake(_networks_lock, portMAX_DELAY);
+  memcpy(_networks, networks, sizeof(PortalNetwork) * count);
+  _network_count = count;
+  _scan_completed = true;
+  xSemaphoreGive(_networks_lock);
+  
+  Log.verboseln("WiFi scan found %d networks (%d unique)", found, count);
+}
+
+uint8_t CaptivePortal::copy_networks(PortalNetwork (&networks)[MAX_NETWORKS]) const {
+  xSemaphoreTake(_networks_lock, portMAX_DELAY);
+  uint8_t count = _network_count;
+  memcpy(networks, _networks, sizeof(PortalNetwork) * count);
+  xSemaphoreGive(_networks_lock);
+  return count;
+}
+
+const char* CaptivePortal::signal_label(int8_t rssi) {
+  if (rssi > -50) {
+    return "Strong";
+  } else if (rssi > -70) {
+    return "Good";
+  } else if (rssi > -80) {
+    return "Fair";
+  }
+  return "Weak";
+}
+
+void CaptivePortal::handle_get_networks(HttpRequest& request) {
+  PortalNetwork networks[MAX_NETWORKS];
+  uint8_t count = copy_networks(networks);
+  
+  JsonDocument doc;
+  doc["scanning"] = WiFi.scanComplete() == WIFI_SCAN_RUNNING;
+  JsonArray list = doc["networks"].to<JsonArray>();
+  for (uint8_t i = 0; i < count; i++) {
+    JsonObject entry = list.add<JsonObject>();
+    entry["ssid"] = networks[i].ssid;
+    entry["rssi"] = networks[i].rssi;
+    entry["secure"] = networks[i].secure;
+    entry["signal"] = signal_label(networks[i].rssi);
+  }
+  
+  String response;
+  serializeJson(doc, response);
+  request.send_header("Cache-Control", "no-store");
+  request.send(200, "application/json", response);
+}
+
+void CaptivePortal::write_networks_html(HtmlTemplate& page) const {
+  PortalNetwork networks[MAX_NETWORKS];
+  uint8_t count = copy_networks(networks);
+  
+  if (count == 0) {
+    page.write(_scan_completed ? "<div class='network-item'>No networks found</div>"
+                               : "<div class='network-item'>Scanning for networks...</div>");
+    return;
+  }
+  
+  for (uint8_t i = 0; i < count; i++) {
+    const PortalNetwork& net = networks[i];
+    page.write("<div class='network-item' ssid='");
+    page.write_escaped(net.ssid);
+    page.write("'>");
+    if (net.secure) {
+      page.write("🔒 ");
+    }
+    page.write_escaped(net.ssid);
+    page.write("<span class='signal'>");
+    page.write(signal_label(net.rssi));
+    page.write("</span></div>");
+  }
+}
@@ -0,0 +1,86 @@
+#include "CompactFont.h"
+
+int16_t CompactFontRenderer::draw_text(Adafruit_GFX& canvas, const CompactFont& font, int16_t x, int16_t y,
+                                       const char* text, uint16_t color) {
+  while (*text) {
+    const CompactGlyph* glyph = find_glyph(font, next_codepoint(text));
+    if (!glyph) {
+      continue;
+    }
+    draw_glyph(canvas, font, *glyph, x, y, color);
+    x += glyph->x_advance;
+  }
+  return x;
+}
+
+int16_t CompactFontRenderer::text_width(const CompactFont& font, const char* text) {
+  int16_t width = 0;
+  while (*text) {
+    const CompactGlyph* glyph = find_glyph(font, next_codepoint(text));
+    if (glyph) {
+      width += glyph->x_advance;
+    }
+  }
+  return width;
+}
+
+const CompactGlyph* CompactFontRenderer::find_glyph(const CompactFont& font, uint16_t codepoint) {
+  // Fonts are small subsets; a binary search keeps larger ones cheap too
+  int low = 0, high = font.glyph_count - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    uint16_t candidate = font.glyphs[middle].codepoint;
+    if (candidate == codepoint) {
+      return &font.glyphs[middle];
+    }
+    if (candidate < codepoint) {
+      low = middle + 1;
+    } else {
+      high = middle - 1;
+    }
+  }
+  return nullptr;
+}
+
+void CompactFontRenderer::draw_glyph(Adafruit_GFX& canvas, const CompactFont& font, const CompactGlyph& glyph,
+                                     int16_t x, int16_t y, uint16_t color) {
+  const uint8_t* data = font.data + glyph.offset;
+  int16_t left = x + glyph.x_offset;
+  int16_t row = y + glyph.y_offset;
+  int16_t bottom = row + glyph.height;
+
+  while (row < bottom) {
+    uint8_t row_count = *data++;
+    uint8_t run_count = *data++;
+    const uint8_t* runs = data;
+    data += run_count;
+
+    // Every row in the group has the same spans
+    for (uint8_t r = 0; r < row_count; r++, row++) {
+      int16_t column = left;
+      for (uint8_t i = 0; i < run_count; i++) {
+        if (i & 1) {
+          canvas.drawFastHLine(column, row, runs[i], color);
+        }
+        column += runs[i];
+      }
+    }
+  }
+}
+
+uint16_t CompactFontRenderer::next_codepoint(const char*& text) {
+  uint8_t c = *text++;
+  if (c < 0x80) {
+    return c;
+  }
+  // Two and three byte UTF-8 sequences (the BMP)
+  if ((c & 0xE0) == 0xC0 && (*text & 0xC0) == 0x80) {
+    return ((c & 0x1F) << 6) | (*text++ & 0x3F);
+  }
+  if ((c & 0xF0) == 0xE0 && (text[0] & 0xC0) == 0x80 && (text[1] & 0xC0) == 0x80) {
+    uint16_t codepoint = ((c & 0x0F) << 12) | ((text[0] & 0x3F) << 6) | (text[1] & 0x3F);
+    text += 2;
+    return codepoint;
+  }
+  return 0xFFFD;
+}
@@ -1,152 +1,342 @@
 #include "ConfigManager.h"
+#include "ConfigSchema.h"
+#include <esp_rom_crc.h>
+#include <esp_sleep.h>
+
+namespace {
+
+// Typed readers and writers for each schema field type. Dispatch goes through
+// FIELD_OPS indexed by ConfigFieldType, so no field is ever looked up by name.
+template <ConfigFieldType T> struct ConfigFieldCodec;
+
+template <> struct ConfigFieldCodec<ConfigFieldType::String> {
+  static void reset(const ConfigField& field, uint8_t* base) {
+    strlcpy(reinterpret_cast<char*>(base + field.offset), field.default_text, field.size);
+  }
+
+  static void write(const ConfigField& field, const uint8_t* base, JsonDocument& doc) {
+    doc[field.name] = reinterpret_cast<const char*>(base + field.offset);
+  }
+
+  static bool read(const ConfigField& field, JsonVariantConst value, uint8_t* base) {
+    if (!value.is<const char*>()) return false;
+    const char* text = value.as<const char*>();
+    size_t length = strlen(text);
+    if (length < (size_t)field.min_value || length > (size_t)field.max_value) return false;
+    memcpy(base + field.offset, text, length + 1);
+    return true;
+  }
+
+  static bool equals(const ConfigField& field, const uint8_t* a, const uint8_t* b) {
+    return strncmp(reinterpret_cast<const char*>(a + field.offset),
+                   reinterpret_cast<const char*>(b + field.offset), field.size) == 0;
+  }
+};
+
+template <> struct ConfigFieldCodec<ConfigFieldType::Int> {
+  static void reset(const ConfigField& field, uint8_t* base) {
+    memcpy(base + field.offset, &field.default_value, sizeof(int32_t));
+  }
+
+  static void write(const ConfigField& field, const uint8_t* base, JsonDocument& doc) {
+    int32_t number;
+    memcpy(&number, base + field.offset, sizeof(int32_t));
+    doc[field.name] = number;
+  }
+
+  static bool read(const ConfigField& field, JsonVariantConst value, uint8_t* base) {
+    if (!value.is<int32_t>()) return false;
+    int32_t number = value.as<int32_t>();
+    if (number < field.min_value || number > field.max_value) return false;
+    memcpy(base + field.offset, &number, sizeof(int32_t));
+    return true;
+  }
+
+  static bool equals(const ConfigField& field, const uint8_t* a, const uint8_t* b) {
+    return memcmp(a + field.offset, b + field.offset, sizeof(int32_t)) == 0;
+  }
+};
+
+template <> struct ConfigFieldCodec<ConfigFieldType::Bool> {
+  static void reset(const ConfigField& field, uint8_t* base) {
+    base[field.offset] = field.default_value != 0;
+  }
+
+  static void write(const ConfigField& field, const uint8_t* base, JsonDocument& doc) {
+    doc[field.name] = base[field.offset] != 0;
+  }
+
+  static bool read(const ConfigField& field, JsonVariantConst value, uint8_t* base) {
+    if (!value.is<bool>()) return false;
+    base[field.offset] = value.as<bool>();
+    return true;
+  }
+
+  static bool equals(const ConfigField& field, const uint8_t* a, const uint8_t* b) {
+    return (a[field.offset] != 0) == (b[field.offset] != 0);
+  }
+};
+
+struct ConfigFieldOps {
+  void (*reset)(const ConfigField& field, uint8_t* base);
+  void (*write)(const ConfigField& field, const uint8_t* base, JsonDocument& doc);
+  bool (*read)(const ConfigField& field, JsonVariantConst value, uint8_t* base);
+  bool (*equals)(const ConfigField& field, const uint8_t* a, const uint8_t* b);
+};
+
+template <ConfigFieldType T>
+constexpr ConfigFieldOps make_field_ops() {
+  return { &ConfigFieldCodec<T>::reset, &ConfigFieldCodec<T>::write, &ConfigFieldCodec<T>::read,
+           &ConfigFieldCodec<T>::equals };
+}
+
+// Indexed by ConfigFieldType
+const ConfigFieldOps FIELD_OPS[] = {
+  make_field_ops<ConfigFieldType::String>(),
+  make_field_ops<ConfigFieldType::Int>(),
+  make_field_ops<ConfigFieldType::Bool>(),
+};
+
+const ConfigFieldOps& ops_for(const ConfigField& field) {
+  return FIELD_OPS[static_cast<uint8_t>(field.type)];
+}
+
+const char* type_name(ConfigFieldType type) {
+  switch (type) {
+    case ConfigFieldType::String: return "string";
+    case ConfigFieldType::Int: return "int";
+    case ConfigFieldType::Bool: return "bool";
+  }
+  return "unknown";
+}
+
+} // namespace
 
 // Initialize the global configuration instance
 ConfigManager config_manager;
 
+// Copy of the configuration record that survives deep sleep
+RTC_DATA_ATTR ConfigRecord rtc_config_record;
+
 ConfigManager::ConfigManager() : _config_file_path(CONFIG_FILE_PATH) {
   // Set defaults in constructor
   reset_to_defaults();
 }
 
 bool ConfigManager::begin() {
-  // Try to load configuration from file
-  if (!load_config()) {
-    // If loading fails, use defaults and save them
-    Log.infoln("Using default configuration and saving to file");
+  // Fast path: after a deep sleep wake the RTC copy is still valid
+  if (load_from_rtc()) {
+    Log.verboseln("Configuration loaded from RTC memory");
+    return true;
+  }
+
+  // Normal boot: read the binary record from NVS
+  if (load_config()) {
+    store_to_rtc();
+    return true;
+  }
+
+  // First boot after upgrading from JSON storage
+  if (import_legacy_file()) {
     save_config();
-    return false;
+    return true;
   }
-  return true;
+
+  // If loading fails, use defaults and save them
+  Log.infoln("Using default configuration and saving to NVS");
+  reset_to_defaults();
+  save_config();
+  return false;
 }
 
 void ConfigManager::reset_to_defaults() {
-  // WiFi settings
-  wifi_ssid = "";
-  wifi_password = "";
-  
-  // Home Assistant settings
-  hass_url = "ws://homeassistant.local:8123/api/websocket";
-  hass_token = "";
-  
-  // Data refresh settings
-  data_refresh_seconds = 300;
-  data_wait_ms = 250;
-  
-  // Entity IDs
-  weather_entity_id = "weather.accuweather";
-  alarm_entity_id = "";
-  temperature_unit = "F";
-  
-  // Feature flags
-  listen_for_events = true;
-  wait_for_serial = false;
-  
-  // Power management settings (enabled by default)
-  enable_deep_sleep = true;
-  sleep_duration_minutes = 5; // Default matches data_refresh_seconds
-  disable_wifi_between_updates = true;
+  // Zero everything (including padding) so stored records are deterministic
+  ConfigData* data = static_cast<ConfigData*>(this);
+  memset(data, 0, sizeof(ConfigData));
+
+  uint8_t* base = reinterpret_cast<uint8_t*>(data);
+  for (const ConfigField& field : CONFIG_FIELDS) {
+    ops_for(field).reset(field, base);
+  }
+}
+
+void ConfigManager::build_record(ConfigRecord& record) const {
+  record.data = *static_cast<const ConfigData*>(this);
+  record.header.magic = CONFIG_MAGIC;
+  record.header.version = CONFIG_VERSION;
+  record.header.size = sizeof(ConfigData);
+  record.header.crc = esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(&record.data), sizeof(ConfigData));
+}
+
+bool ConfigManager::validate_record(const ConfigRecord& record, size_t length) {
+  if (length < sizeof(ConfigHeader) || record.header.magic != CONFIG_MAGIC) {
+    return false;
+  }
+
+  // Older firmware may have stored a shorter record; newer firmware a longer one we can't read
+  if (record.header.size > sizeof(ConfigData) || record.header.size != length - sizeof(ConfigHeader)) {
+    Log.warningln("Config record size mismatch (%d bytes, version %d)", record.header.size, record.header.version);
+    return false;
+  }
+
+  uint32_t crc = esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(&record.data), record.header.size);
+  if (crc != record.header.crc) {
+    Log.warningln("Config record CRC mismatch");
+    return false;
+  }
+  return true;
 }
 
 bool ConfigManager::save_config() {
-  // Create a JSON document
-  JsonDocument doc;
-  
-  // WiFi settings
-  doc["wifi_ssid"] = wifi_ssid;
-  doc["wifi_password"] = wifi_password;
-  
-  // Home Assistant settings
-  doc["hass_url"] = hass_url;
-  doc["hass_token"] = hass_token;
-  
-  // Data refresh settings
-  doc["data_refresh_seconds"] = data_refresh_seconds;
-  doc["data_wait_ms"] = data_wait_ms;
-  
-  // Entity IDs
-  doc["weather_entity_id"] = weather_entity_id;
-  doc["alarm_entity_id"] = alarm_entity_id;
-  doc["temperature_unit"] = temperature_unit;
-  
-  // Feature flags
-  doc["listen_for_events"] = listen_for_events;
-  doc["wait_for_serial"] = wait_for_serial;
-  
-  // Power management settings
-  doc["enable_deep_sleep"] = enable_deep_sleep;
-  doc["sleep_duration_minutes"] = sleep_duration_minutes;
-  doc["disable_wifi_between_updates"] = disable_wifi_between_updates;
-  
-  // Open file for writing
-  File configFile = LittleFS.open(_config_file_path, "w");
-  if (!configFile) {
-    Log.errorln("Failed to open config file for writing");
+  ConfigRecord record;
+  build_record(record);
+
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NVS_NAMESPACE, false)) {
+    Log.errorln("Failed to open NVS namespace for writing");
     return false;
   }
-  
-  // Write to file
-  if (serializeJson(doc, configFile) == 0) {
-    Log.errorln("Failed to write config to file");
-    configFile.close();
+
+  size_t written = prefs.putBytes(CONFIG_NVS_KEY, &record, sizeof(record));
+  prefs.end();
+
+  if (written != sizeof(record)) {
+    Log.errorln("Failed to write config to NVS");
     return false;
   }
-  
-  // Close file
-  configFile.close();
+
+  rtc_config_record = record;
   Log.infoln("Configuration saved successfully");
   return true;
 }
 
 bool ConfigManager::load_config() {
-  // Check if config file exists
-  if (!LittleFS.exists(_config_file_path)) {
-    Log.warningln("Config file %s does not exist", _config_file_path);
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NVS_NAMESPACE, true)) {
+    Log.warningln("Config namespace does not exist in NVS");
     return false;
   }
-  
-  // Open file for reading
+
+  size_t length = prefs.getBytesLength(CONFIG_NVS_KEY);
+  if (length == 0 || length > sizeof(ConfigRecord)) {
+    prefs.end();
+    Log.warningln("No usable config record in NVS");
+    return false;
+  }
+
+  // Start from defaults so fields missing from an older, shorter record keep their default
+  reset_to_defaults();
+  ConfigRecord record;
+  build_record(record);
+  prefs.getBytes(CONFIG_NVS_KEY, &record, length);
+  prefs.end();
+
+  if (!validate_record(record, length)) {
+    reset_to_defaults();
+    return false;
+  }
+
+  *static_cast<ConfigData*>(this) = record.data;
+  Log.infoln("Configuration loaded successfully (version %d)", record.header.version);
+  return true;
+}
+
+bool ConfigManager::load_from_rtc() {
+  // RTC memory only holds meaningful data when waking from deep sleep
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED) {
+    return false;
+  }
+
+  const ConfigRecord& record = rtc_config_record;
+  if (record.header.version != CONFIG_VERSION || !validate_record(record, sizeof(ConfigRecord))) {
+    return false;
+  }
+
+  *static_cast<ConfigData*>(this) = record.data;
+  return true;
+}
+
+void ConfigManager::store_to_rtc() const {
+  build_record(rtc_config_record);
+}
+
+bool ConfigManager::import_legacy_file() {
+  if (!LittleFS.begin(false) || !LittleFS.exists(_config_file_path)) {
+    return false;
+  }
+
   File configFile = LittleFS.open(_config_file_path, "r");
   if (!configFile) {
-    Log.errorln("Failed to open config file for reading");
+    Log.errorln("Failed to open legacy config file for reading");
     return false;
   }
-  
-  // Deserialize JSON from the file
+
   JsonDocument doc;
   DeserializationError error = deserializeJson(doc, configFile);
   configFile.close();
-  
+
   if (error) {
-    Log.errorln("Failed to parse config file: %s", error.c_str());
+    Log.errorln("Failed to parse legacy config file: %s", error.c_str());
     return false;
   }
-  
-  // WiFi settings
-  if (doc.containsKey("wifi_ssid")) wifi_ssid = doc["wifi_ssid"].as<String>();
-  if (doc.containsKey("wifi_password")) wifi_password = doc["wifi_password"].as<String>();
-  
-  // Home Assistant settings
-  if (doc.containsKey("hass_url")) hass_url = doc["hass_url"].as<String>();
-  if (doc.containsKey("hass_token")) hass_token = doc["hass_token"].as<String>();
-  
-  // Data refresh settings
-  if (doc.containsKey("data_refresh_seconds")) data_refresh_seconds = doc["data_refresh_seconds"].as<int>();
-  if (doc.containsKey("data_wait_ms")) data_wait_ms = doc["data_wait_ms"].as<int>();
-  
-  // Entity IDs
-  if (doc.containsKey("weather_entity_id")) weather_entity_id = doc["weather_entity_id"].as<String>();
-  if (doc.containsKey("alarm_entity_id")) alarm_entity_id = doc["alarm_entity_id"].as<String>();
-  if (doc.containsKey("temperature_unit")) temperature_unit = doc["temperature_unit"].as<String>();
-  
-  // Feature flags
-  if (doc.containsKey("listen_for_events")) listen_for_events = doc["listen_for_events"].as<bool>();
-  if (doc.containsKey("wait_for_serial")) wait_for_serial = doc["wait_for_serial"].as<bool>();
-  
-  // Power management settings
-  if (doc.containsKey("enable_deep_sleep")) enable_deep_sleep = doc["enable_deep_sleep"].as<bool>();
-  if (doc.containsKey("sleep_duration_minutes")) sleep_duration_minutes = doc["sleep_duration_minutes"].as<int>();
-  if (doc.containsKey("disable_wifi_between_updates")) disable_wifi_between_updates = doc["disable_wifi_between_updates"].as<bool>();
-  
-  Log.infoln("Configuration loaded successfully");
+
+  reset_to_defaults();
+  from_json(doc, true);
+  Log.infoln("Imported legacy configuration from %s", _config_file_path);
   return true;
-}
\ No newline at end of file
+}
+
+void ConfigManager::to_json(JsonDocument& doc) const {
+  const uint8_t* base = reinterpret_cast<const uint8_t*>(static_cast<const ConfigData*>(this));
+  for (const ConfigField& field : CONFIG_FIELDS) {
+    ops_for(field).write(field, base, doc);
+  }
+}
+
+const char* ConfigManager::from_json(const JsonDocument& doc, bool skip_invalid) {
+  // Validate into a staged copy so a rejected update leaves the current values untouched
+  ConfigData staged = *static_cast<const ConfigData*>(this);
+  uint8_t* base = reinterpret_cast<uint8_t*>(&staged);
+
+  for (const ConfigField& field : CONFIG_FIELDS) {
+    JsonVariantConst value = doc[field.name];
+    if (value.isNull()) continue;
+
+    if (!ops_for(field).read(field, value, base)) {
+      if (!skip_invalid) {
+        Log.warningln("Invalid value for config field %s", field.name);
+        return field.name;
+      }
+      Log.warningln("Ignoring invalid value for config field %s", field.name);
+    }
+  }
+
+  *static_cast<ConfigData*>(this) = staged;
+  return nullptr;
+}
+
+uint8_t ConfigManager::changes_since(const ConfigData& previous) const {
+  const uint8_t* before = reinterpret_cast<const uint8_t*>(&previous);
+  const uint8_t* after = reinterpret_cast<const uint8_t*>(static_cast<const ConfigData*>(this));
+
+  uint8_t apply = CONFIG_APPLY_NONE;
+  for (const ConfigField& field : CONFIG_FIELDS) {
+    if (!ops_for(field).equals(field, before, after)) {
+      Log.verboseln("Config field %s changed", field.name);
+      apply |= field.apply;
+    }
+  }
+  return apply;
+}
+
+void ConfigManager::schema_json(JsonDocument& doc) {
+  JsonArray fields = doc["fields"].to<JsonArray>();
+  for (const ConfigField& field : CONFIG_FIELDS) {
+    JsonObject entry = fields.add<JsonObject>();
+    entry["name"] = field.name;
+    entry["type"] = type_name(field.type);
+    entry["min"] = field.min_value;
+    entry["max"] = field.max_value;
+    entry["restart"] = (field.apply & CONFIG_APPLY_REBOOT) != 0;
+  }
+}
@@ -0,0 +1,184 @@
+#include "DisplayRenderTask.h"
+#include <ArduinoLog.h>
+#include <esp_rom_crc.h>
+
+DisplayRenderTask::DisplayRenderTask(size_t frame_size, UploadFunction upload)
+  : _frame_size(frame_size),
+    _upload(upload),
+    _pending(nullptr),
+    _front(nullptr),
+    _has_pending(false),
+    _refreshing(false),
+    _front_valid(false),
+    _readers(0),
+    _pending_hash(0),
+    _displayed_hash(0),
+    _lock(nullptr),
+    _task(nullptr),
+    _frames_rendered(0),
+    _frames_replaced(0),
+    _frames_skipped(0),
+    _last_refresh_ms(0) {
+}
+
+DisplayRenderTask::~DisplayRenderTask() {
+  if (_task) vTaskDelete(_task);
+  if (_lock) vSemaphoreDelete(_lock);
+  free(_pending);
+  free(_front);
+}
+
+bool DisplayRenderTask::begin(BaseType_t core) {
+  if (_task) return true;
+
+  _pending = (uint8_t*)malloc(_frame_size);
+  _front = (uint8_t*)malloc(_frame_size);
+  _lock = xSemaphoreCreateMutex();
+  if (!_pending || !_front || !_lock) {
+    Log.errorln("Failed to allocate display render buffers");
+    return false;
+  }
+
+  if (xTaskCreatePinnedToCore(task_entry, "display_render", TASK_STACK_SIZE, this,
+                              TASK_PRIORITY, &_task, core) != pdPASS) {
+    Log.errorln("Failed to start display render task");
+    _task = nullptr;
+    return false;
+  }
+
+  Log.verboseln("Display render task started on core %d", core);
+  return true;
+}
+
+uint32_t DisplayRenderTask::frame_hash(const uint8_t* frame) const {
+  return esp_rom_crc32_le(0, frame, _frame_size);
+}
+
+bool DisplayRenderTask::submit(const uint8_t* frame) {
+  uint32_t hash = frame_hash(frame);
+
+  if (!_task) {
+    // Task not running - fall back to a synchronous refresh
+    if (hash == _displayed_hash) {
+      _frames_skipped++;
+      return false;
+    }
+    _upload(frame);
+    _displayed_hash = hash;
+    _frames_rendered++;
+    return true;
+  }
+
+  xSemaphoreTake(_lock, portMAX_DELAY);
+
+  // After a deep sleep wake only the hash of the panel contents is known; the
+  // first matching frame fills in the front buffer for readers
+  if (!_front_valid && hash == _displayed_hash) {
+    memcpy(_front, frame, _frame_size);
+    _front_valid = true;
+  }
+
+  // The panel will end up showing the pending frame if there is one, otherwise the last one taken
+  uint32_t target_hash = _has_pending ? _pending_hash : _displayed_hash;
+  if (hash == target_hash) {
+    _frames_skipped++;
+    xSemaphoreGive(_lock);
+    Log.verboseln("Frame unchanged - skipping panel refresh");
+    return false;
+  }
+
+  if (_has_pending) {
+    _frames_replaced++;
+    if (hash == _displayed_hash) {
+      // Back to what the panel already shows: just cancel the pending frame
+      _has_pending = false;
+      xSemaphoreGive(_lock);
+      Log.verboseln("Cancelled pending frame, panel already shows this frame");
+      return false;
+    }
+    Log.verboseln("Replacing pending frame that has not started");
+  }
+  memcpy(_pending, frame, _frame_size);
+  _pending_hash = hash;
+  _has_pending = true;
+  xSemaphoreGive(_lock);
+
+  xTaskNotifyGive(_task);
+  return true;
+}
+
+const uint8_t* DisplayRenderTask::acquire_displayed_frame(uint32_t& hash) {
+  if (!_task) {
+    return nullptr;
+  }
+
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  if (!_front_valid) {
+    xSemaphoreGive(_lock);
+    return nullptr;
+  }
+  _readers++;
+  hash = _displayed_hash;
+  xSemaphoreGive(_lock);
+  return _front;
+}
+
+void DisplayRenderTask::release_displayed_frame() {
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  bool resume = --_readers == 0 && _has_pending;
+  xSemaphoreGive(_lock);
+
+  // A frame submitted while the buffer was pinned is waiting for us
+  if (resume) {
+    xTaskNotifyGive(_task);
+  }
+}
+
+bool DisplayRenderTask::wait_until_idle(uint32_t timeout_ms) {
+  unsigned long start = millis();
+  while (is_busy()) {
+    if (timeout_ms != UINT32_MAX && millis() - start > timeout_ms) {
+      return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  return true;
+}
+
+bool DisplayRenderTask::is_busy() const {
+  return _has_pending || _refreshing;
+}
+
+void DisplayRenderTask::task_entry(void* arg) {
+  static_cast<DisplayRenderTask*>(arg)->run();
+}
+
+void DisplayRenderTask::run() {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    // Take ownership of the pending frame by swapping it with the front buffer
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if (!_has_pending || _readers > 0) {
+      // Nothing to do, or the front buffer is pinned; release_displayed_frame() notifies us again
+      xSemaphoreGive(_lock);
+      continue;
+    }
+    uint8_t* frame = _pending;
+    _pending = _front;
+    _front = frame;
+    _displayed_hash = _pending_hash;
+    _front_valid = true;
+    _refreshing = true;
+    _has_pending = false;
+    xSemaphoreGive(_lock);
+
+    unsigned long start = millis();
+    _upload(_front);
+    _last_refresh_ms = millis() - start;
+    _frames_rendered++;
+    _refreshing = false;
+
+    Log.verboseln("Display refresh completed in %lu ms", _last_refresh_ms);
+  }
+}
@@ -0,0 +1,56 @@
+#include "DnsCache.h"
+#include <ArduinoLog.h>
+#include <time.h>
+
+// How long a resolved address is trusted. lwIP does not report the record's
+// own TTL, and a failed connection re-resolves anyway, so this only bounds
+// how long a moved host that still accepts connections goes unnoticed.
+#define DNS_CACHE_TTL_S 3600
+
+// The system clock keeps running through deep sleep, so entry age is
+// measured with time() rather than millis()
+struct DnsCacheEntry {
+  char host[64];
+  uint32_t address;       // 0 when empty
+  uint32_t resolved_at;   // time() of the lookup
+};
+RTC_DATA_ATTR DnsCacheEntry rtc_dns_cache;
+
+DnsCache::DnsCache() : _resolve_ms(0), _cached(false) {
+}
+
+bool DnsCache::resolve(const String& host, IPAddress& address) {
+  _resolve_ms = 0;
+  _cached = false;
+  if (address.fromString(host)) {
+    return true;
+  }
+
+  DnsCacheEntry& entry = rtc_dns_cache;
+  uint32_t now = time(nullptr);
+  if (entry.address != 0 && host == entry.host && now - entry.resolved_at < DNS_CACHE_TTL_S) {
+    address = IPAddress(entry.address);
+    _cached = true;
+    return true;
+  }
+
+  unsigned long start = millis();
+  bool resolved = WiFi.hostByName(host.c_str(), address) == 1 && (uint32_t)address != 0;
+  _resolve_ms = millis() - start;
+  if (!resolved) {
+    Log.errorln("Could not resolve %s (%lu ms)", host.c_str(), (unsigned long)_resolve_ms);
+    return false;
+  }
+  Log.infoln("Resolved %s to %s in %lu ms", host.c_str(), address.toString().c_str(), (unsigned long)_resolve_ms);
+
+  if (host.length() < sizeof(entry.host)) {
+    strncpy(entry.host, host.c_str(), sizeof(entry.host));
+    entry.address = (uint32_t)address;
+    entry.resolved_at = now;
+  }
+  return true;
+}
+
+void DnsCache::invalidate() {
+  rtc_dns_cache.address = 0;
+}
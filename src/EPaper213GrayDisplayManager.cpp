@@ -0,0 +1,244 @@
+#include "EPaper213GrayDisplayManager.h"
+#include "EPaper213MonoDisplayManager.h"
+#include <Fonts/FreeSansBold12pt7b.h>
+#include <Fonts/FreeSans9pt7b.h>
+#include "CompactFont.h"
+#include "fonts/TemperatureFont48.h"
+#include "FS.h"
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <ArduinoLog.h>
+#include "ConfigManager.h"
+#include <esp_sleep.h>
+
+// Hash of the frame on the panel, kept across deep sleep (see the mono manager)
+RTC_DATA_ATTR uint32_t rtc_displayed_gray_frame_hash = 0;
+
+// Panel color for each gray level
+static const uint16_t LEVEL_COLORS[] = { EPD_WHITE, EPD_LIGHT, EPD_DARK, EPD_BLACK };
+
+// Widest panel row the upload masks have room for, in bytes
+#define MAX_ROW_BYTES 64
+
+EPaper213GrayDisplayManager::EPaper213GrayDisplayManager()
+  : _display(EPD_DC, EPD_RST, EPD_CS, EPD_SRCS, EPD_BUSY, EPD_SPI),
+    _canvas(nullptr),
+    _renderer(nullptr) {
+}
+
+void EPaper213GrayDisplayManager::begin() {
+  _display.begin(THINKINK_GRAYSCALE4);
+  _width = _display.width();
+  _height = _display.height();
+  
+  // Two bit-planes; the render task hashes and copies both as one frame
+  _canvas = new GrayRaster(_width, _height);
+  _renderer = new DisplayRenderTask(_canvas->frame_size(), [this](const uint8_t* frame) {
+    upload_frame(frame);
+  });
+  _renderer->begin();
+  
+  if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED) {
+    _renderer->set_displayed_hash(rtc_displayed_gray_frame_hash);
+  }
+}
+
+void EPaper213GrayDisplayManager::show_message(const String& message, const String& second_line) {
+  _canvas->fillScreen(GRAY_WHITE);
+  
+  // Display first line (larger font)
+  _canvas->setFont(&FreeSansBold12pt7b);
+  _canvas->setTextSize(1);
+  _canvas->setTextColor(GRAY_BLACK);
+  _canvas->setCursor(10, 40);
+  _canvas->print(message);
+  
+  // Display second line if provided (smaller font, softer)
+  if (second_line.length() > 0) {
+    _canvas->setFont(&FreeSans9pt7b);
+    _canvas->setTextColor(GRAY_DARK);
+    _canvas->setCursor(10, 70);
+    _canvas->print(second_line);
+  }
+  
+  submit_frame();  // Full refresh on the render task
+}
+
+void EPaper213GrayDisplayManager::update_display(const std::array<RequestData, 3>& data_points, bool force_refresh, String battery_level) {
+  Log.verboseln("Updating display with latest data");
+  
+  if (!needs_refresh(data_points, force_refresh)) {
+    Log.infoln("No values have changed - skipping screen refresh.");
+    return;
+  }
+  
+  _canvas->fillScreen(GRAY_WHITE);
+  
+  // Layout relative to the panel size; the alarm banner runs along the bottom
+  const int temp_x = 16;
+  const int box_height = 34, box_y = _height - box_height;
+  const int bitmap_x = _width - 64 - 10, bitmap_y = (box_y - 64) / 2;
+  
+  // Temperature in the generated 48 px font, unit in the regular font
+  String temperature = get_data_value(data_points, DATA_TEMPERATURE) + "\u00B0";
+  int16_t unit_x = CompactFontRenderer::draw_text(*_canvas, TemperatureFont48, temp_x, _height / 2,
+                                                  temperature.c_str(), GRAY_BLACK);
+  _canvas->setCursor(unit_x, _height / 2);
+  _canvas->setFont(&FreeSansBold12pt7b);
+  _canvas->setTextColor(GRAY_DARK);
+  _canvas->setTextSize(1);
+  _canvas->print(config_manager.temperature_unit);
+  
+  // Weather icon in gray
+  String weather_condition = get_data_value(data_points, DATA_CONDITIONS);
+  String path = EPaper213MonoDisplayManager::determine_weather_icon_path(weather_condition);
+  draw_bitmap_from_path(path.c_str(), bitmap_x, bitmap_y);
+  
+  // Alarm banner: black when armed, light gray when disarmed
+  uint16_t footer_color = GRAY_DARK;
+  if (strlen(config_manager.alarm_entity_id) > 0) {
+    String alarm_state = get_data_value(data_points, DATA_ALARM);
+    uint16_t box_color = GRAY_WHITE, text_color = GRAY_BLACK;
+    if (alarm_state == "armed_home") {
+      box_color = GRAY_BLACK;
+      text_color = GRAY_WHITE;
+      alarm_state = "ARMED - HOME";
+    } else if (alarm_state == "armed_away") {
+      box_color = GRAY_BLACK;
+      text_color = GRAY_WHITE;
+      alarm_state = "ARMED - AWAY";
+    } else if (alarm_state == "disarmed") {
+      box_color = GRAY_LIGHT;
+      alarm_state = "DISARMED";
+    } else {
+      alarm_state = "UNKNOWN";
+    }
+    if (box_color != GRAY_WHITE) {
+      _canvas->fillRect(0, box_y, _width, box_height, box_color);
+      footer_color = box_color == GRAY_BLACK ? GRAY_LIGHT : GRAY_BLACK;
+    }
+    _canvas->setFont(&FreeSansBold12pt7b);
+    _canvas->setTextColor(text_color);
+    _canvas->setCursor(temp_x, _height - 14);
+    _canvas->print(alarm_state);
+  }
+  
+  // IP address and battery in the built-in font
+  _canvas->setFont();
+  _canvas->setTextSize(1);
+  _canvas->setTextColor(footer_color);
+  _canvas->setCursor(temp_x, _height - 9);
+  _canvas->print(WiFi.localIP().toString());
+  
+  if (battery_level.length() > 0) {
+    int16_t x1, y1;
+    uint16_t w, h;
+    _canvas->getTextBounds(battery_level, 0, 0, &x1, &y1, &w, &h);
+    _canvas->setCursor(_width - (w + 10), _height - 9);
+    _canvas->print(battery_level);
+  }
+  
+  if (!submit_frame()) {
+    Log.infoln("Frame identical to the panel contents - skipping screen refresh.");
+  }
+  
+  // Reset the changed flags after display update
+  for (const RequestData& data : data_points) {
+    const_cast<RequestData&>(data).has_value_changed = false;
+  }
+}
+
+void EPaper213GrayDisplayManager::draw_bitmap_from_path(const char *path, int x, int y) {
+  File bmpFile = LittleFS.open(path);
+  if (!bmpFile) {
+    Log.warningln("Failed to open BMP file: %s", path);
+    return;
+  }
+  
+  // Skip BMP Header (54 bytes)
+  bmpFile.seek(54);
+  
+  const int bmpWidth = 64;  // Change to match your BMP dimensions
+  const int bmpHeight = 64;
+  const int rowPadding = (4 - ((bmpWidth * 3) % 4)) % 4;  // BMP rows are padded to 4-byte alignment
+  uint8_t pixels[bmpWidth * 3 + 3];
+  uint8_t gray[bmpWidth];
+  
+  // One row at a time straight into the planes; BMP starts from the bottom row
+  for (int row = bmpHeight - 1; row >= 0; row--) {
+    bmpFile.read(pixels, bmpWidth * 3 + rowPadding);
+    for (int col = 0; col < bmpWidth; col++) {
+      uint8_t b = pixels[col * 3];
+      uint8_t g = pixels[col * 3 + 1];
+      uint8_t r = pixels[col * 3 + 2];
+      gray[col] = (r * 30 + g * 59 + b * 11) / 100;
+    }
+    _canvas->draw_gray_row(x, y + row, gray, bmpWidth);
+  }
+  bmpFile.close();
+  Log.verboseln("BMP drawn: %s", path);
+}
+
+void EPaper213GrayDisplayManager::flush() {
+  if (_renderer) {
+    _renderer->wait_until_idle();
+  }
+}
+
+const uint8_t* EPaper213GrayDisplayManager::acquire_screen(uint32_t& hash) {
+  return _renderer ? _renderer->acquire_displayed_frame(hash) : nullptr;
+}
+
+void EPaper213GrayDisplayManager::release_screen() {
+  if (_renderer) {
+    _renderer->release_displayed_frame();
+  }
+}
+
+void EPaper213GrayDisplayManager::sleep() {
+  // Let any in-flight refresh finish before the panel is powered down
+  flush();
+  if (_renderer) {
+    rtc_displayed_gray_frame_hash = _renderer->displayed_hash();
+  }
+  
+  _display.powerDown();
+  Log.verboseln("E-paper display powered down");
+}
+
+bool EPaper213GrayDisplayManager::submit_frame() {
+  return _renderer->submit(_canvas->getBuffer());
+}
+
+void EPaper213GrayDisplayManager::upload_frame(const uint8_t* frame) {
+  // Split each row of the two planes into one mask per non-white level, so
+  // no full-size intermediate frame is needed
+  size_t stride = (_width + 7) / 8;
+  size_t plane_size = stride * _height;
+  uint8_t masks[4][MAX_ROW_BYTES];
+  if (stride > MAX_ROW_BYTES) {
+    Log.errorln("Panel too wide for grayscale upload: %d", _width);
+    return;
+  }
+  
+  _display.clearBuffer();
+  for (int y = 0; y < _height; y++) {
+    const uint8_t* low = frame + y * stride;
+    const uint8_t* high = low + plane_size;
+    bool used[4] = { false, false, false, false };
+    for (size_t i = 0; i < stride; i++) {
+      masks[GRAY_LIGHT][i] = low[i] & ~high[i];
+      masks[GRAY_DARK][i] = high[i] & ~low[i];
+      masks[GRAY_BLACK][i] = low[i] & high[i];
+      used[GRAY_LIGHT] |= masks[GRAY_LIGHT][i] != 0;
+      used[GRAY_DARK] |= masks[GRAY_DARK][i] != 0;
+      used[GRAY_BLACK] |= masks[GRAY_BLACK][i] != 0;
+    }
+    for (uint8_t level = GRAY_LIGHT; level <= GRAY_BLACK; level++) {
+      if (used[level]) {
+        _display.drawBitmap(0, y, masks[level], _width, 1, LEVEL_COLORS[level]);
+      }
+    }
+  }
+  _display.display();
+}
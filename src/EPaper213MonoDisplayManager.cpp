@@ -2,41 +2,62 @@
 #include <Fonts/FreeSansBold12pt7b.h>
 #include <Fonts/FreeSans9pt7b.h>
 #include <Fonts/FreeSans12pt7b.h>
+#include "CompactFont.h"
+#include "fonts/TemperatureFont48.h"
 #include "FS.h"
 #include <LittleFS.h>
 #include <WiFi.h>
 #include <ArduinoLog.h>
 #include "ConfigManager.h"
+#include <esp_sleep.h>
+
+// Hash of the frame on the panel, kept across deep sleep (e-paper keeps its image
+// while powered down) so an identical frame after waking doesn't refresh again
+RTC_DATA_ATTR uint32_t rtc_displayed_frame_hash = 0;
 
 EPaper213MonoDisplayManager::EPaper213MonoDisplayManager() 
-  : _display(EPD_DC, EPD_RST, EPD_CS, EPD_SRCS, EPD_BUSY, EPD_SPI) {
+  : _display(EPD_DC, EPD_RST, EPD_CS, EPD_SRCS, EPD_BUSY, EPD_SPI),
+    _canvas(nullptr),
+    _renderer(nullptr) {
 }
 
 void EPaper213MonoDisplayManager::begin() {
   _display.begin();
   _width = _display.width();
   _height = _display.height();
+  
+  // Compose into an in-memory 1bpp raster and let the render task own the panel
+  _canvas = new MonoRaster(_width, _height);
+  size_t frame_size = ((_width + 7) / 8) * _height;
+  _renderer = new DisplayRenderTask(frame_size, [this](const uint8_t* frame) {
+    upload_frame(frame);
+  });
+  _renderer->begin();
+  
+  if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED) {
+    _renderer->set_displayed_hash(rtc_displayed_frame_hash);
+  }
 }
 
 void EPaper213MonoDisplayManager::show_message(const String& message, const String& second_line) {
-  _display.clearBuffer();
+  _canvas->fillScreen(EPD_WHITE);
   
   // Display first line (larger font)
-  _display.setFont(&FreeSansBold12pt7b);
-  _display.setTextSize(1);
-  _display.setTextColor(EPD_BLACK);
-  _display.setCursor(10, 40);
-  _display.print(message);
+  _canvas->setFont(&FreeSansBold12pt7b);
+  _canvas->setTextSize(1);
+  _canvas->setTextColor(EPD_BLACK);
+  _canvas->setCursor(10, 40);
+  _canvas->print(message);
   
   // Display second line if provided (smaller font)
   if (second_line.length() > 0) {
-    _display.setFont(&FreeSans9pt7b);
-    _display.setTextSize(1);
-    _display.setCursor(10, 70);
-    _display.print(second_line);
+    _canvas->setFont(&FreeSans9pt7b);
+    _canvas->setTextSize(1);
+    _canvas->setCursor(10, 70);
+    _canvas->print(second_line);
   }
   
-  _display.display();  // Full refresh
+  submit_frame();  // Full refresh on the render task
 }
 
 void EPaper213MonoDisplayManager::update_display(const std::array<RequestData, 3>& data_points, bool force_refresh, String battery_level) {
@@ -50,22 +71,22 @@ void EPaper213MonoDisplayManager::update_display(const std::array<RequestData, 3
   }
   
   // Clear any previous content
-  _display.clearBuffer();
+  _canvas->fillScreen(EPD_WHITE);
   
   // Layout constants
   int section_width = _width / 2;
   const int temp_x = 16, temp_y = 40;
   const int BITMAP_X = 176, BITMAP_Y = 12;
   
-  // Draw temperature
-  _display.setCursor(16, _height / 2);
-  _display.setFont(&FreeSansBold12pt7b);
-  _display.setTextColor(EPD_BLACK, EPD_WHITE);
-  _display.setTextSize(3);
-  String temperature = get_data_value(data_points, DATA_TEMPERATURE);
-  _display.print(temperature);
-  _display.setTextSize(1);
-  _display.print(config_manager.temperature_unit);
+  // Draw temperature in the generated 48 px font, then the unit in the regular font
+  String temperature = get_data_value(data_points, DATA_TEMPERATURE) + "\u00B0";
+  int16_t unit_x = CompactFontRenderer::draw_text(*_canvas, TemperatureFont48, temp_x, _height / 2,
+                                                  temperature.c_str(), EPD_BLACK);
+  _canvas->setCursor(unit_x, _height / 2);
+  _canvas->setFont(&FreeSansBold12pt7b);
+  _canvas->setTextColor(EPD_BLACK, EPD_WHITE);
+  _canvas->setTextSize(1);
+  _canvas->print(config_manager.temperature_unit);
   
   // Draw weather conditions icon
   String weather_condition = get_data_value(data_points, DATA_CONDITIONS);
@@ -78,50 +99,53 @@ void EPaper213MonoDisplayManager::update_display(const std::array<RequestData, 3
   const int box_height = 122-88, box_y = 88;
   
   // Check if alarm entity is configured
-  if (config_manager.alarm_entity_id.length() > 0) {
-    _display.setFont(&FreeSansBold12pt7b);
-    _display.setTextSize(1);
+  if (strlen(config_manager.alarm_entity_id) > 0) {
+    _canvas->setFont(&FreeSansBold12pt7b);
+    _canvas->setTextSize(1);
     
     String alarm_state = get_data_value(data_points, DATA_ALARM);
     if (alarm_state == "armed_home") { 
-      _display.fillRect(0, 88, _width, box_height, EPD_BLACK);
-      _display.setTextColor(EPD_WHITE, EPD_BLACK);
+      _canvas->fillRect(0, 88, _width, box_height, EPD_BLACK);
+      _canvas->setTextColor(EPD_WHITE, EPD_BLACK);
       alarm_state = "ARMED - HOME";
     } else if (alarm_state == "armed_away") {
-      _display.fillRect(0, 88, _width, box_height, EPD_BLACK);
-      _display.setTextColor(EPD_WHITE, EPD_BLACK);
+      _canvas->fillRect(0, 88, _width, box_height, EPD_BLACK);
+      _canvas->setTextColor(EPD_WHITE, EPD_BLACK);
       alarm_state = "ARMED - AWAY";    
     } else if (alarm_state == "disarmed") {
-      _display.setTextColor(EPD_BLACK, EPD_WHITE);
+      _canvas->setTextColor(EPD_BLACK, EPD_WHITE);
       alarm_state = "DISARMED";
     } else {
-      _display.setTextColor(EPD_BLACK, EPD_WHITE);
+      _canvas->setTextColor(EPD_BLACK, EPD_WHITE);
       alarm_state = "UNKNOWN";
     }
-    _display.setCursor(alarm_x, alarm_y);
-    _display.print(alarm_state);
+    _canvas->setCursor(alarm_x, alarm_y);
+    _canvas->print(alarm_state);
   } else {
     // No alarm entity configured - leave this section blank
-    _display.setTextColor(EPD_BLACK, EPD_WHITE);
+    _canvas->setTextColor(EPD_BLACK, EPD_WHITE);
   }
   
   // Draw IP address
-  _display.setFont();
-  _display.setTextSize(1);
-  _display.setCursor(alarm_x, _height - 9);
+  _canvas->setFont();
+  _canvas->setTextSize(1);
+  _canvas->setCursor(alarm_x, _height - 9);
   String ipString = WiFi.localIP().toString();
-  _display.print(ipString);
+  _canvas->print(ipString);
 
   if (battery_level.length() > 0) {
     int16_t x1, y1;
     uint16_t w, h;
-    _display.getTextBounds(battery_level, 0, 0, &x1, &y1, &w, &h);
-    _display.setCursor(_width - (w + 10), _height - 9);
-    _display.print(battery_level);
+    _canvas->getTextBounds(battery_level, 0, 0, &x1, &y1, &w, &h);
+    _canvas->setCursor(_width - (w + 10), _height - 9);
+    _canvas->print(battery_level);
   }
   
-  // Update the physical display
-  _display.display();
+  // Hand the frame to the render task; the panel refresh runs in the background.
+  // Identical frames (e.g. same values as before deep sleep) are skipped.
+  if (!submit_frame()) {
+    Log.infoln("Frame identical to the panel contents - skipping screen refresh.");
+  }
   
   // Reset the changed flags after display update
   for (const RequestData& data : data_points) {
@@ -139,41 +163,75 @@ void EPaper213MonoDisplayManager::draw_bitmap_from_path(const char *path, int x,
   // Skip BMP Header (54 bytes)
   bmpFile.seek(54);
   
-  int bmpWidth = 64;  // Change to match your BMP dimensions
-  int bmpHeight = 64;
-  int rowPadding = (4 - (bmpWidth % 4)) % 4;  // BMP rows are padded to 4-byte alignment
-  GFXcanvas1 canvas(bmpWidth, bmpHeight);  // 1-bit buffer
+  const int bmpWidth = 64;  // Change to match your BMP dimensions
+  const int bmpHeight = 64;
+  const int rowPadding = (4 - ((bmpWidth * 3) % 4)) % 4;  // BMP rows are padded to 4-byte alignment
+  const int rowBytes = (bmpWidth + 7) / 8;
+  uint8_t bitmap[rowBytes * bmpHeight];  // 1-bit, rows padded to whole bytes
+  uint8_t pixels[bmpWidth * 3 + 3];
+  memset(bitmap, 0, sizeof(bitmap));
   
   for (int row = bmpHeight - 1; row >= 0; row--) {  // BMP starts from the bottom row
+    bmpFile.read(pixels, bmpWidth * 3 + rowPadding);
+    uint8_t* out = bitmap + row * rowBytes;
     for (int col = 0; col < bmpWidth; col++) {
-      uint8_t b = bmpFile.read();
-      uint8_t g = bmpFile.read();
-      uint8_t r = bmpFile.read();
+      uint8_t b = pixels[col * 3];
+      uint8_t g = pixels[col * 3 + 1];
+      uint8_t r = pixels[col * 3 + 2];
       
       // Convert to grayscale: (0.3 * R + 0.59 * G + 0.11 * B)
       uint8_t gray = (r * 30 + g * 59 + b * 11) / 100;
       
       // Convert to 1-bit (black/white) thresholding
       if (gray < 128) {
-        canvas.drawPixel(col, row, 1);  // Black
-      } else {
-        canvas.drawPixel(col, row, 0);  // White
+        out[col / 8] |= 0x80 >> (col % 8);  // Black
       }
     }
-    bmpFile.seek(bmpFile.position() + rowPadding);  // Skip row padding
   }
   bmpFile.close();
   
-  _display.drawBitmap(x, y, canvas.getBuffer(), bmpWidth, bmpHeight, EPD_BLACK);
+  _canvas->draw_bitmap(x, y, bitmap, bmpWidth, bmpHeight, EPD_BLACK);
   Log.verboseln("BMP drawn: %s", path);
 }
 
+void EPaper213MonoDisplayManager::flush() {
+  if (_renderer) {
+    _renderer->wait_until_idle();
+  }
+}
+
+const uint8_t* EPaper213MonoDisplayManager::acquire_screen(uint32_t& hash) {
+  return _renderer ? _renderer->acquire_displayed_frame(hash) : nullptr;
+}
+
+void EPaper213MonoDisplayManager::release_screen() {
+  if (_renderer) {
+    _renderer->release_displayed_frame();
+  }
+}
+
 void EPaper213MonoDisplayManager::sleep() {
+  // Let any in-flight refresh finish before the panel is powered down
+  flush();
+  if (_renderer) {
+    rtc_displayed_frame_hash = _renderer->displayed_hash();
+  }
+  
   // Put the display in sleep mode to save power
   _display.powerDown();
   Log.verboseln("E-paper display powered down");
 }
 
+bool EPaper213MonoDisplayManager::submit_frame() {
+  return _renderer->submit(_canvas->getBuffer());
+}
+
+void EPaper213MonoDisplayManager::upload_frame(const uint8_t* frame) {
+  _display.clearBuffer();
+  _display.drawBitmap(0, 0, frame, _width, _height, EPD_BLACK);
+  _display.display();
+}
+
 String EPaper213MonoDisplayManager::determine_weather_icon_path(const String& weather_condition) {
   String path = "/day/no_image.bmp";
   
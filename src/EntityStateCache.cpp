@@ -0,0 +1,136 @@
+#include "EntityStateCache.h"
+#include <ArduinoLog.h>
+
+void EntityStateCache::track(const String& entity_id, const String& attribute) {
+  for (const TrackedValue& tracked : _values) {
+    if (tracked.entity_id == entity_id && tracked.attribute == attribute) {
+      return;
+    }
+  }
+  TrackedValue tracked;
+  tracked.entity_id = entity_id;
+  tracked.attribute = attribute;
+  _values.push_back(tracked);
+}
+
+void EntityStateCache::clear() {
+  _values.clear();
+}
+
+std::vector<String> EntityStateCache::entity_ids() const {
+  std::vector<String> ids;
+  for (const TrackedValue& tracked : _values) {
+    bool seen = false;
+    for (const String& id : ids) {
+      if (id == tracked.entity_id) {
+        seen = true;
+        break;
+      }
+    }
+    if (!seen) {
+      ids.push_back(tracked.entity_id);
+    }
+  }
+  return ids;
+}
+
+bool EntityStateCache::apply(JsonObjectConst event) {
+  bool changed = false;
+  
+  // Entities walk the (few) tracked values rather than the message, so
+  // untracked entities and attributes cost nothing beyond parsing
+  JsonObjectConst added = event["a"];
+  JsonObjectConst updates = event["c"];
+  JsonArrayConst removed = event["r"];
+  
+  for (TrackedValue& tracked : _values) {
+    const char* id = tracked.entity_id.c_str();
+    
+    // Added: a full state replaces whatever was cached
+    JsonObjectConst full = added[id];
+    if (!full.isNull()) {
+      JsonVariantConst value = tracked.attribute.length() == 0 ? full["s"] : full["a"][tracked.attribute.c_str()];
+      changed |= value.isNull() ? forget(tracked) : set(tracked, value);
+    }
+    
+    // Changed: "+" carries new values, "-" lists removed attributes
+    JsonObjectConst diff = updates[id];
+    if (!diff.isNull()) {
+      JsonVariantConst value = tracked.attribute.length() == 0 ? diff["+"]["s"] : diff["+"]["a"][tracked.attribute.c_str()];
+      if (!value.isNull()) {
+        changed |= set(tracked, value);
+      } else if (tracked.attribute.length() > 0) {
+        for (JsonVariantConst name : diff["-"]["a"].as<JsonArrayConst>()) {
+          if (tracked.attribute == name.as<const char*>()) {
+            changed |= forget(tracked);
+          }
+        }
+      }
+    }
+    
+    for (JsonVariantConst entity : removed) {
+      if (tracked.entity_id == entity.as<const char*>()) {
+        changed |= forget(tracked);
+      }
+    }
+  }
+  
+  return changed;
+}
+
+void EntityStateCache::add_to_filter(JsonObject event_filter) const {
+  JsonObject added = event_filter["a"].to<JsonObject>();
+  JsonObject updates = event_filter["c"].to<JsonObject>();
+  event_filter["r"] = true;
+  
+  for (const TrackedValue& tracked : _values) {
+    const char* id = tracked.entity_id.c_str();
+    if (tracked.attribute.length() == 0) {
+      added[id]["s"] = true;
+      updates[id]["+"]["s"] = true;
+    } else {
+      const char* attribute = tracked.attribute.c_str();
+      added[id]["a"][attribute] = true;
+      updates[id]["+"]["a"][attribute] = true;
+      updates[id]["-"]["a"] = true;
+    }
+  }
+}
+
+bool EntityStateCache::get(const String& entity_id, const String& attribute, String& value) const {
+  for (const TrackedValue& tracked : _values) {
+    if (tracked.known && tracked.entity_id == entity_id && tracked.attribute == attribute) {
+      value = tracked.value;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool EntityStateCache::set(TrackedValue& tracked, JsonVariantConst value) {
+  // Strings as-is; numbers and other values as JSON, as render_template would print them
+  String text;
+  if (value.is<const char*>()) {
+    text = value.as<const char*>();
+  } else {
+    serializeJson(value, text);
+  }
+  
+  if (tracked.known && tracked.value == text) {
+    return false;
+  }
+  Log.verboseln("Entity %s %s = %s", tracked.entity_id.c_str(),
+                tracked.attribute.length() > 0 ? tracked.attribute.c_str() : "state", text.c_str());
+  tracked.value = text;
+  tracked.known = true;
+  return true;
+}
+
+bool EntityStateCache::forget(TrackedValue& tracked) {
+  if (!tracked.known) {
+    return false;
+  }
+  tracked.value = "";
+  tracked.known = false;
+  return true;
+}
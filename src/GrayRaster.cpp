@@ -0,0 +1,101 @@
+#include "GrayRaster.h"
+
+GrayRaster::GrayRaster(uint16_t width, uint16_t height)
+  : Adafruit_GFX(width, height),
+    _buffer(static_cast<uint8_t*>(calloc(2 * ((width + 7) / 8) * height, 1))),
+    _planes{ RasterPlane(_buffer, width, height),
+             RasterPlane(_buffer ? _buffer + ((width + 7) / 8) * height : nullptr, width, height) } {
+}
+
+GrayRaster::~GrayRaster() {
+  free(_buffer);
+}
+
+void GrayRaster::draw_bitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t width, int16_t height, uint8_t level) {
+  uint32_t row_bits = ((width + 7) / 8) * 8;
+  for (uint8_t p = 0; p < 2; p++) {
+    _planes[p].blit_bits(rotation, x, y, bitmap, row_bits, width, height, (level >> p) & 1);
+  }
+}
+
+void GrayRaster::draw_gray_row(int16_t x, int16_t y, const uint8_t* gray, int16_t width) {
+  // Split the row into one bit mask per plane, then clear the span and set the bits
+  while (width > 0) {
+    int16_t count = width < MAX_ROW_PIXELS ? width : MAX_ROW_PIXELS;
+    uint8_t masks[2][MAX_ROW_PIXELS / 8];
+    memset(masks, 0, sizeof(masks));
+    for (int16_t i = 0; i < count; i++) {
+      uint8_t level = level_for_gray(gray[i]);
+      uint8_t bit = 0x80 >> (i & 7);
+      if (level & 1) masks[0][i / 8] |= bit;
+      if (level & 2) masks[1][i / 8] |= bit;
+    }
+
+    for (uint8_t p = 0; p < 2; p++) {
+      _planes[p].fill_rect(rotation, x, y, count, 1, false);
+      _planes[p].blit_bits(rotation, x, y, masks[p], count, count, 1, true);
+    }
+
+    x += count;
+    gray += count;
+    width -= count;
+  }
+}
+
+void GrayRaster::drawPixel(int16_t x, int16_t y, uint16_t level) {
+  // Only used by the generic GFX paths (lines, circles, built-in font)
+  for (uint8_t p = 0; p < 2; p++) {
+    _planes[p].fill_rect(rotation, x, y, 1, 1, (level >> p) & 1);
+  }
+}
+
+void GrayRaster::fillScreen(uint16_t level) {
+  if (!_buffer) return;
+  memset(_buffer, (level & 1) ? 0xFF : 0x00, plane_size());
+  memset(_buffer + plane_size(), (level & 2) ? 0xFF : 0x00, plane_size());
+}
+
+void GrayRaster::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t level) {
+  for (uint8_t p = 0; p < 2; p++) {
+    _planes[p].fill_rect(rotation, x, y, w, h, (level >> p) & 1);
+  }
+}
+
+void GrayRaster::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t level) {
+  fillRect(x, y, w, 1, level);
+}
+
+void GrayRaster::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t level) {
+  fillRect(x, y, 1, h, level);
+}
+
+size_t GrayRaster::write(uint8_t c) {
+  if (!gfxFont || textsize_x != 1 || textsize_y != 1) {
+    return Adafruit_GFX::write(c);
+  }
+
+  // Same cursor handling as Adafruit_GFX::write for custom fonts
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += gfxFont->yAdvance;
+    return 1;
+  }
+  if (c == '\r' || c < gfxFont->first || c > gfxFont->last) {
+    return 1;
+  }
+
+  const GFXglyph& glyph = gfxFont->glyph[c - gfxFont->first];
+  if (glyph.width > 0 && glyph.height > 0) {
+    if (wrap && cursor_x + glyph.xOffset + glyph.width > _width) {
+      cursor_x = 0;
+      cursor_y += gfxFont->yAdvance;
+    }
+    for (uint8_t p = 0; p < 2; p++) {
+      _planes[p].blit_bits(rotation, cursor_x + glyph.xOffset, cursor_y + glyph.yOffset,
+                           gfxFont->bitmap + glyph.bitmapOffset, glyph.width, glyph.width, glyph.height,
+                           (textcolor >> p) & 1);
+    }
+  }
+  cursor_x += glyph.xAdvance;
+  return 1;
+}
@@ -2,20 +2,56 @@
 #include <ArduinoLog.h>
 #include <WiFi.h>
 
+// Largest single message, and largest coalesced frame: Home Assistant joins
+// whatever is queued into one array without a size limit
+#define HASS_MAX_MESSAGE_BYTES 16384
+#define HASS_MAX_BATCH_BYTES 49152
 
-using namespace websockets;
+// Wait before reconnecting after a message over the limit, doubled for each
+// further one in a row: the server would only send it again
+#define HASS_TOO_BIG_BACKOFF_MS 30000UL
+#define HASS_TOO_BIG_BACKOFF_MAX_MS (30UL * 60 * 1000)
 
 HassWebsocketManager::HassWebsocketManager()
 {   
-    ws_client.onMessage([&](WebsocketsMessage message) {
-        Log.infoln("Received WS message: %s", message.data().c_str());
-        process_websocket_message(message.data());
+    build_message_filters();
+
+    ws_client.on_message([&](const String& message) {
+        Log.infoln("Received WS message: %s", message.c_str());
+        process_websocket_message(message);
     });
     
-    ws_client.onEvent([&](WebsocketsEvent event, String data) {
-        if(event == WebsocketsEvent::ConnectionOpened) {
+    ws_client.on_event([&](WebsocketEvent event) {
+        if(event == WebsocketEvent::Opened) {
             Log.infoln("Connnection Opened");
-        } else if(event == WebsocketsEvent::ConnectionClosed) {
+        } else if(event == WebsocketEvent::Closed) {
+            is_authenticated = false;
+            fail_queued_requests("connection closed");
+            if (closing_intentionally) {
+                Log.infoln("WebSocket closed");
+                return;
+            }
+            if (!ws_client.message_too_big()) {
+                too_big_closes = 0;
+            } else if (coalesce_messages) {
+                // Home Assistant would send the same burst again; take it as separate messages
+                Log.warningln("Coalesced messages exceeded %d bytes, reconnecting without coalesce_messages",
+                              HASS_MAX_BATCH_BYTES);
+                coalesce_messages = false;
+            } else {
+                // A single message over the limit comes back on every connection
+                too_big_closes++;
+                unsigned long backoff_ms = min(HASS_TOO_BIG_BACKOFF_MS << min(too_big_closes - 1, 6),
+                                               HASS_TOO_BIG_BACKOFF_MAX_MS);
+                reconnect_after = millis() + backoff_ms;
+                holding_reconnect = true;
+                Log.errorln("Home Assistant sent a message over %d bytes (%d in a row), reconnecting in %lu s",
+                            HASS_MAX_MESSAGE_BYTES, too_big_closes, backoff_ms / 1000);
+                if (error_callback != nullptr) {
+                    error_callback(-1, "message too big, reconnecting in " + String(backoff_ms / 1000) + " s");
+                }
+                return;
+            }
             Log.warningln("WebSocket disconnected! Attempting to reconnect...");
             delay(5000);  // Wait before retrying
             connect(this->websocket_url, this->auth_token);  // Try reconnecting
@@ -29,23 +65,60 @@ void HassWebsocketManager::connect(String url, String auth_token) {
         return;
     }
 
+    // New settings may point at a server that behaves; otherwise wait out the back-off
+    if (url != this->websocket_url || auth_token != this->auth_token) {
+        too_big_closes = 0;
+        holding_reconnect = false;
+    }
+    if (backing_off()) {
+        return;
+    }
+    holding_reconnect = false;
+
     this->websocket_url = url;
     this->auth_token = auth_token;
+    is_authenticated = false;
+    connect_started = millis();
+    connection = {};
 
+    ws_client.set_max_message_bytes(coalesce_messages ? HASS_MAX_BATCH_BYTES : HASS_MAX_MESSAGE_BYTES);
     bool connected = ws_client.connect(url);
     if (connected) {
         Log.infoln("Connected to HASS websocket: %s", url.c_str());
         ws_client.send("{\"type\": \"auth\", \"access_token\": \"" + auth_token + "\"}");
+
+        // First request after auth_ok: let the server pack several messages
+        // into one frame as a JSON array
+        if (coalesce_messages) {
+            send_message("{\"type\": \"supported_features\", \"features\": {\"coalesce_messages\": 1}}");
+        }
+
+        // Subscriptions end with the connection; renew the entity subscription
+        // (queued until auth_ok)
+        if (entities_subscription_id > 0) {
+            entities_subscription_id = -1;
+            subscribe_entities();
+        }
     } else {
         Serial.println("WebSocket connection failed!");
-        error_callback(-1, "WS connection failed");
+        if (error_callback != nullptr) {
+            error_callback(-1, "WS connection failed");
+        }
     }
 }
 
+bool HassWebsocketManager::set_certificate_fingerprint(String fingerprint) {
+    return ws_client.set_fingerprint(fingerprint);
+}
+
 void HassWebsocketManager::disconnect() {
     if (ws_client.available()) {
+       // Don't let the close event trigger an automatic reconnect
+       closing_intentionally = true;
        ws_client.close();
+       closing_intentionally = false;
     }
+    entities_subscription_id = -1;
 }
 
 void HassWebsocketManager::loop() {
@@ -75,20 +148,81 @@ int HassWebsocketManager::send_message(String json_text) {
     serializeJson(doc, request_json);
     Log.verboseln("Sending WS message: %s", request_json.c_str());
 
-    if (ws_client.available()) {
-        ws_client.send(request_json);
-    } else {
+    if (!ws_client.available()) {
         Log.errorln("Websocket not available, message not sent");
         return -1;
     }
-    
+
+    if (!is_authenticated) {
+        // Home Assistant rejects requests before auth_ok; send them once it arrives
+        queued_messages.push_back(request_json);
+        queued_ids.push_back(id);
+        connection.queued++;
+        return id;
+    }
+
+    ws_client.send(request_json);
     return id;
 }
 
+void HassWebsocketManager::flush_queued_requests() {
+    if (queued_messages.empty()) {
+        return;
+    }
+
+    Log.infoln("Sending %d requests queued until auth_ok", queued_messages.size());
+    if (!ws_client.send_batch(queued_messages)) {
+        fail_queued_requests("send failed");
+        return;
+    }
+    queued_messages.clear();
+    queued_ids.clear();
+}
+
+void HassWebsocketManager::fail_queued_requests(const String& reason) {
+    // Clear first: the error callback may send new requests
+    std::vector<int> ids;
+    ids.swap(queued_ids);
+    queued_messages.clear();
+
+    for (int id : ids) {
+        Log.warningln("Request %d failed: %s", id, reason.c_str());
+        if (id == entities_subscription_id) {
+            entities_subscription_id = -1;
+        }
+        connection.failed++;
+        if (error_callback != nullptr) {
+            error_callback(id, reason);
+        }
+    }
+}
+
+void HassWebsocketManager::build_message_filters() {
+    message_filter.clear();
+    message_filter["id"] = true;
+    message_filter["type"] = true;
+    message_filter["success"] = true;
+    message_filter["message"] = true;
+    message_filter["error"]["message"] = true;
+    JsonObject event = message_filter["event"].to<JsonObject>();
+    event["result"] = true;
+    entities.add_to_filter(event);
+
+    batch_filter.clear();
+    batch_filter.add(message_filter);
+}
+
 void HassWebsocketManager::process_websocket_message(String json_text) {
-    // Process message (parse JSON, extract sensor values, etc.)
+    // Parse only what dispatch_message() and the data callback read; a
+    // snapshot's unneeded entities and attributes are skipped while parsing
+    const char* text = json_text.c_str();
+    while (*text == ' ' || *text == '\n' || *text == '\r' || *text == '\t') {
+        text++;
+    }
+    const JsonDocument& filter = *text == '[' ? batch_filter : message_filter;
+
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, json_text.c_str());
+    DeserializationError error = deserializeJson(doc, text, DeserializationOption::Filter(filter));
     if (error) {
         Log.errorln("Error parsing JSON: %s", error.c_str());
         if (error_callback != nullptr) {
@@ -97,11 +231,62 @@ void HassWebsocketManager::process_websocket_message(String json_text) {
         return;
     }
 
+    if (doc.is<JsonArrayConst>()) {
+        // coalesce_messages: several results and events in one frame
+        for (JsonObjectConst message : doc.as<JsonArrayConst>()) {
+            dispatch_message(message);
+        }
+    } else {
+        dispatch_message(doc.as<JsonObjectConst>());
+    }
+}
+
+void HassWebsocketManager::dispatch_message(JsonObjectConst doc) {
+    connection.dispatched++;
     int request_id = doc["id"].as<int>();
     String type = doc["type"];
     Log.verboseln("Received response to request_id %d with type %s", request_id, type);
 
-    if (type == "auth_required" || type == "auth_ok" || type == "result") {
+    if (type == "auth_ok") {
+        is_authenticated = true;
+        connection.auth_ms = millis() - connect_started;
+        Log.infoln("Authenticated with Home Assistant in %lu ms", (unsigned long)connection.auth_ms);
+        flush_queued_requests();
+        return;
+    }
+
+    if (type == "auth_invalid") {
+        String message = doc["message"] | "";
+        Log.errorln("Home Assistant rejected the access token: %s", message.c_str());
+        fail_queued_requests("auth_invalid");
+        if (error_callback != nullptr) {
+            error_callback(-1, "auth_invalid: " + message);
+        }
+        return;
+    }
+
+    if (request_id > 0 && connection.first_data_ms == 0) {
+        connection.first_data_ms = millis() - connect_started;
+    }
+
+    if (request_id == entities_subscription_id && request_id > 0) {
+        if (type == "result" && !doc["success"].as<bool>()) {
+            Log.errorln("subscribe_entities failed: %s", doc["error"]["message"].as<const char*>());
+            entities_subscription_id = -1;
+        } else if (type == "event" && !entities.apply(doc["event"].as<JsonObjectConst>())) {
+            // Only untracked attributes changed; nothing for the data callback
+            return;
+        }
+    }
+
+    if (type == "result" && !doc["success"].as<bool>()) {
+        if (error_callback != nullptr) {
+            error_callback(request_id, doc["error"]["message"] | "request failed");
+        }
+        return;
+    }
+
+    if (type == "auth_required" || type == "result") {
       return;
     }
 
@@ -115,6 +300,14 @@ bool HassWebsocketManager::available() {
   return ws_client.available();
 }
 
+bool HassWebsocketManager::backing_off() const {
+  return holding_reconnect && (long)(millis() - reconnect_after) < 0;
+}
+
+bool HassWebsocketManager::wait_for_data(uint32_t timeout_ms) {
+  return ws_client.wait_for_data(timeout_ms);
+}
+
 
 int HassWebsocketManager::ping() {
     return send_message("{\"type\": \"ping\"}");
@@ -154,6 +347,32 @@ int HassWebsocketManager::render_template(String templateStr) {
     return send_message("{\"type\": \"render_template\", \"template\": \"" + templateStr + "\"}");
 }
 
+int HassWebsocketManager::subscribe_entities() {
+    std::vector<String> entity_ids = entities.entity_ids();
+    if (entity_ids.empty()) {
+        Log.warningln("Error: No entities to subscribe to.");
+        return -1;
+    }
+
+    if (entities_subscription_id > 0) {
+        unsubscribe_from_event(entities_subscription_id);
+        entities_subscription_id = -1;
+    }
+
+    JsonDocument request;
+    request["type"] = "subscribe_entities";
+    JsonArray ids = request["entity_ids"].to<JsonArray>();
+    for (const String& id : entity_ids) {
+        ids.add(id);
+    }
+
+    String message;
+    serializeJson(request, message);
+    build_message_filters();
+    entities_subscription_id = send_message(message);
+    return entities_subscription_id;
+}
+
 void HassWebsocketManager::setMessageCallback(DataCallback callback) {
     this->data_callback = callback;
 }
@@ -0,0 +1,80 @@
+#include "HtmlTemplate.h"
+#include <ArduinoLog.h>
+
+HtmlTemplate::HtmlTemplate(HttpRequest& request)
+  : _request(request), _length(0), _failed(false) {
+}
+
+bool HtmlTemplate::render(const char* content_type, const char* text, Resolver resolver) {
+  _request.begin_chunks(200, content_type);
+
+  const char* cursor = text;
+  while (!_failed) {
+    const char* open = strstr(cursor, "{{");
+    if (!open) {
+      write(cursor);
+      break;
+    }
+    write(cursor, open - cursor);
+
+    const char* name_start = open + 2;
+    const char* close = strstr(name_start, "}}");
+    size_t name_length = close ? close - name_start : 0;
+    if (!close || name_length >= MAX_NAME_LENGTH) {
+      // Not a placeholder, emit the braces literally
+      write(open, 2);
+      cursor = name_start;
+      continue;
+    }
+
+    char name[MAX_NAME_LENGTH];
+    memcpy(name, name_start, name_length);
+    name[name_length] = '\0';
+    if (resolver) {
+      resolver(name, *this);
+    } else {
+      Log.warningln("Template placeholder {{%s}} has no value", name);
+    }
+    cursor = close + 2;
+  }
+
+  flush();
+  if (!_failed) {
+    _request.end_chunks();
+  }
+  return !_failed;
+}
+
+void HtmlTemplate::write(const char* data, size_t length) {
+  while (length > 0 && !_failed) {
+    size_t space = BUFFER_SIZE - _length;
+    size_t count = length < space ? length : space;
+    memcpy(_buffer + _length, data, count);
+    _length += count;
+    data += count;
+    length -= count;
+    if (_length == BUFFER_SIZE) {
+      flush();
+    }
+  }
+}
+
+void HtmlTemplate::write_escaped(const char* text) {
+  for (const char* c = text; *c; c++) {
+    switch (*c) {
+      case '&': write("&amp;"); break;
+      case '<': write("&lt;"); break;
+      case '>': write("&gt;"); break;
+      case '"': write("&quot;"); break;
+      case '\'': write("&#39;"); break;
+      default: write(c, 1); break;
+    }
+  }
+}
+
+void HtmlTemplate::flush() {
+  if (_length > 0 && !_failed) {
+    _failed = !_request.send_chunk(_buffer, _length);
+  }
+  _length = 0;
+}
@@ -0,0 +1,324 @@
+#include "HttpServer.h"
+#include <ArduinoLog.h>
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+
+// httpd task stack: handlers build JSON documents and stream files
+#define HTTP_TASK_STACK_SIZE 8192
+
+HttpRequest::HttpRequest(httpd_req_t* req)
+  : _req(req), _header_count(0), _body_read(false), _sent(false), _close(false) {
+}
+
+String HttpRequest::header(const char* name) const {
+  size_t length = httpd_req_get_hdr_value_len(_req, name);
+  if (length == 0) {
+    return String();
+  }
+
+  char value[length + 1];
+  if (httpd_req_get_hdr_value_str(_req, name, value, sizeof(value)) != ESP_OK) {
+    return String();
+  }
+  return String(value);
+}
+
+const String& HttpRequest::body() {
+  if (_body_read) {
+    return _body;
+  }
+  _body_read = true;
+
+  size_t remaining = _req->content_len;
+  if (remaining > MAX_BODY_SIZE) {
+    remaining = MAX_BODY_SIZE;
+    Log.warningln("Request body for %s truncated to %d bytes", _req->uri, MAX_BODY_SIZE);
+  }
+  _body.reserve(remaining);
+
+  // Each timeout is a full recv_wait_timeout; a client that stalls the body
+  // must not hold the only httpd task
+  char buffer[256];
+  uint8_t timeouts = 0;
+  while (remaining > 0) {
+    int received = httpd_req_recv(_req, buffer, min(remaining, sizeof(buffer)));
+    if (received == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts <= MAX_BODY_TIMEOUTS) {
+      continue;
+    }
+    if (received == HTTPD_SOCK_ERR_TIMEOUT) {
+      Log.warningln("Timed out reading the request body for %s", _req->uri);
+      send(408, "text/plain", "Request body timed out");
+      _close = true;
+      break;
+    }
+    if (received <= 0) {
+      break;
+    }
+    _body.concat(buffer, received);
+    remaining -= received;
+  }
+  return _body;
+}
+
+String HttpRequest::arg(const char* name) {
+  size_t query_length = httpd_req_get_url_query_len(_req);
+  if (query_length > 0) {
+    char query[query_length + 1];
+    if (httpd_req_get_url_query_str(_req, query, sizeof(query)) == ESP_OK) {
+      String value = find_arg(String(query), name);
+      if (value.length() > 0) {
+        return value;
+      }
+    }
+  }
+
+  if (header("Content-Type").startsWith("application/x-www-form-urlencoded")) {
+    return find_arg(body(), name);
+  }
+  return String();
+}
+
+void HttpRequest::send_header(const char* name, const String& value) {
+  if (_header_count >= MAX_RESPONSE_HEADERS) {
+    Log.warningln("Too many response headers, dropping %s", name);
+    return;
+  }
+  _header_values[_header_count] = value;
+  httpd_resp_set_hdr(_req, name, _header_values[_header_count].c_str());
+  _header_count++;
+}
+
+void HttpRequest::send(int code, const char* content_type, const String& content) {
+  if (_sent) {
+    // body() already answered (408)
+    return;
+  }
+  httpd_resp_set_status(_req, status_text(code));
+  if (content_type) {
+    httpd_resp_set_type(_req, content_type);
+  }
+  httpd_resp_send(_req, content.c_str(), content.length());
+  _sent = true;
+}
+
+void HttpRequest::begin_chunks(int code, const char* content_type) {
+  if (_sent) {
+    return;
+  }
+  httpd_resp_set_status(_req, status_text(code));
+  httpd_resp_set_type(_req, content_type);
+  _sent = true;
+}
+
+bool HttpRequest::send_chunk(const char* data, size_t length) {
+  if (length == 0) {
+    // A zero-length chunk would end the response
+    return true;
+  }
+  if (httpd_resp_send_chunk(_req, data, length) != ESP_OK) {
+    Log.warningln("Client went away while sending %s", _req->uri);
+    return false;
+  }
+  return true;
+}
+
+void HttpRequest::end_chunks() {
+  httpd_resp_send_chunk(_req, nullptr, 0);
+}
+
+bool HttpRequest::send_file(File& file, const char* content_type) {
+  if (String(file.name()).endsWith(".gz")) {
+    send_header("Content-Encoding", "gzip");
+  }
+  begin_chunks(200, content_type);
+
+  char buffer[FILE_CHUNK_SIZE];
+  size_t length;
+  while ((length = file.read(reinterpret_cast<uint8_t*>(buffer), sizeof(buffer))) > 0) {
+    if (!send_chunk(buffer, length)) {
+      return false;
+    }
+  }
+  end_chunks();
+  return true;
+}
+
+const char* HttpRequest::status_text(int code) {
+  switch (code) {
+    case 200: return "200 OK";
+    case 204: return "204 No Content";
+    case 302: return "302 Found";
+    case 304: return "304 Not Modified";
+    case 400: return "400 Bad Request";
+    case 404: return "404 Not Found";
+    case 408: return "408 Request Timeout";
+    case 500: return "500 Internal Server Error";
+    case 503: return "503 Service Unavailable";
+    default: return code < 400 ? "200 OK" : "500 Internal Server Error";
+  }
+}
+
+String HttpRequest::find_arg(const String& source, const char* name) {
+  size_t name_length = strlen(name);
+  int start = 0;
+  while (start < (int)source.length()) {
+    int end = source.indexOf('&', start);
+    if (end < 0) {
+      end = source.length();
+    }
+    if (end - start > (int)name_length && source[start + name_length] == '=' &&
+        strncmp(source.c_str() + start, name, name_length) == 0) {
+      return url_decode(source.substring(start + name_length + 1, end));
+    }
+    start = end + 1;
+  }
+  return String();
+}
+
+String HttpRequest::url_decode(const String& value) {
+  String decoded;
+  decoded.reserve(value.length());
+  for (size_t i = 0; i < value.length(); i++) {
+    char c = value[i];
+    if (c == '+') {
+      decoded += ' ';
+    } else if (c == '%' && i + 2 < value.length() && isxdigit(value[i + 1]) && isxdigit(value[i + 2])) {
+      char hex[3] = { value[i + 1], value[i + 2], 0 };
+      decoded += (char)strtol(hex, nullptr, 16);
+      i += 2;
+    } else {
+      decoded += c;
+    }
+  }
+  return decoded;
+}
+
+HttpServer::HttpServer()
+  : _handle(nullptr), _route_count(0), _active_connections(0), _peak_connections(0),
+    _requests(0), _latency_total_us(0), _latency_max_us(0), _last_request_time(0) {
+}
+
+HttpServer::~HttpServer() {
+  stop();
+}
+
+bool HttpServer::on(const char* uri, httpd_method_t method, Handler handler) {
+  if (_route_count >= MAX_ROUTES) {
+    Log.errorln("Too many HTTP routes, cannot add %s", uri);
+    return false;
+  }
+
+  Route& route = _routes[_route_count++];
+  route.server = this;
+  route.handler = handler;
+  // Zero the websocket and other optional fields httpd reads
+  route.uri = {};
+  route.uri.uri = uri;
+  route.uri.method = method;
+  route.uri.handler = route_trampoline;
+  route.uri.user_ctx = &route;
+  return true;
+}
+
+bool HttpServer::begin(uint16_t port) {
+  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  config.server_port = port;
+  config.stack_size = HTTP_TASK_STACK_SIZE;
+  config.max_uri_handlers = MAX_ROUTES;
+  config.max_open_sockets = MAX_OPEN_SOCKETS;
+  config.lru_purge_enable = true;
+  config.global_user_ctx = this;
+  // httpd_stop() frees the context unless told otherwise; this one is a member
+  // of the portal or config server, not a heap block of its own
+  config.global_user_ctx_free_fn = [](void* server) {};
+  config.open_fn = on_open;
+  config.close_fn = on_close;
+
+  esp_err_t err = httpd_start(&_handle, &config);
+  if (err != ESP_OK) {
+    Log.errorln("Failed to start HTTP server on port %d: %s", port, esp_err_to_name(err));
+    _handle = nullptr;
+    return false;
+  }
+
+  for (uint8_t i = 0; i < _route_count; i++) {
+    httpd_register_uri_handler(_handle, &_routes[i].uri);
+  }
+  httpd_register_err_handler(_handle, HTTPD_404_NOT_FOUND, not_found_trampoline);
+  return true;
+}
+
+void HttpServer::stop() {
+  if (_handle) {
+    httpd_stop(_handle);
+    _handle = nullptr;
+    _active_connections = 0;
+  }
+}
+
+bool HttpServer::is_client_active() const {
+  return _active_connections > 0 && millis() - _last_request_time < CLIENT_IDLE_MS;
+}
+
+void HttpServer::metrics_json(JsonObject object) const {
+  object["active_connections"] = _active_connections;
+  object["peak_connections"] = _peak_connections;
+  object["requests"] = _requests;
+  if (_requests > 0) {
+    object["latency_avg_ms"] = (float)(_latency_total_us / _requests) / 1000.0f;
+  }
+  object["latency_max_ms"] = (float)_latency_max_us / 1000.0f;
+}
+
+esp_err_t HttpServer::dispatch(httpd_req_t* req, const Handler& handler) {
+  int64_t start = esp_timer_get_time();
+
+  HttpRequest request(req);
+  handler(request);
+  if (!request.sent()) {
+    request.send(500, "text/plain", "No response");
+  }
+
+  uint32_t elapsed_us = esp_timer_get_time() - start;
+  _requests++;
+  _latency_total_us += elapsed_us;
+  if (elapsed_us > _latency_max_us) {
+    _latency_max_us = elapsed_us;
+  }
+  _last_request_time = millis();
+
+  // A failure return makes httpd close the socket, e.g. with an unread body on it
+  return request.close_requested() ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t HttpServer::route_trampoline(httpd_req_t* req) {
+  Route* route = static_cast<Route*>(req->user_ctx);
+  return route->server->dispatch(req, route->handler);
+}
+
+esp_err_t HttpServer::not_found_trampoline(httpd_req_t* req, httpd_err_code_t error) {
+  HttpServer* server = static_cast<HttpServer*>(httpd_get_global_user_ctx(req->handle));
+  if (server->_not_found) {
+    return server->dispatch(req, server->_not_found);
+  }
+  httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, nullptr);
+  return ESP_OK;
+}
+
+esp_err_t HttpServer::on_open(httpd_handle_t handle, int sockfd) {
+  HttpServer* server = static_cast<HttpServer*>(httpd_get_global_user_ctx(handle));
+  server->_active_connections++;
+  if (server->_active_connections > server->_peak_connections) {
+    server->_peak_connections = server->_active_connections;
+  }
+  return ESP_OK;
+}
+
+void HttpServer::on_close(httpd_handle_t handle, int sockfd) {
+  HttpServer* server = static_cast<HttpServer*>(httpd_get_global_user_ctx(handle));
+  if (server->_active_connections > 0) {
+    server->_active_connections--;
+  }
+  // Providing close_fn makes closing the socket our responsibility
+  close(sockfd);
+}
@@ -0,0 +1,293 @@
+#include "Inflater.h"
+
+namespace {
+
+// Base values and extra bits for length codes 257-285 and distance codes 0-29
+const uint16_t LENGTH_BASE[] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t LENGTH_EXTRA[] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t DISTANCE_BASE[] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t DISTANCE_EXTRA[] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Order in which code length code lengths are sent
+const uint8_t CODE_LENGTH_ORDER[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+}  // namespace
+
+Inflater::Inflater(uint8_t window_bits)
+  : _mask((1u << (window_bits < 8 ? 8 : window_bits > 15 ? 15 : window_bits)) - 1) {
+  _window = static_cast<uint8_t*>(malloc(_mask + 1));
+  reset();
+}
+
+Inflater::~Inflater() {
+  free(_window);
+}
+
+void Inflater::reset() {
+  _pos = 0;
+  _history = 0;
+}
+
+bool Inflater::inflate(const uint8_t* data, size_t length, String& out, size_t max_output) {
+  if (!_window) {
+    return false;
+  }
+  
+  _in = data;
+  _end = data + length;
+  _bit_buffer = 0;
+  _bit_count = 0;
+  _error = false;
+  _out = &out;
+  _pending = 0;
+  _produced = 0;
+  _max_output = max_output;
+  
+  // A message ends on a block boundary: after the empty stored block of a sync
+  // flush, or after a final block (anything past it is padding)
+  bool last = false;
+  while (!last && !_error && _in < _end) {
+    last = bits(1);
+    switch (bits(2)) {
+      case 0: stored_block(); break;
+      case 1: fixed_block(); break;
+      case 2: dynamic_block(); break;
+      default: _error = true; break;
+    }
+  }
+  
+  flush();
+  return !_error;
+}
+
+uint32_t Inflater::bits(uint8_t count) {
+  while (_bit_count < count) {
+    if (_in == _end) {
+      _error = true;
+      return 0;
+    }
+    _bit_buffer |= static_cast<uint32_t>(*_in++) << _bit_count;
+    _bit_count += 8;
+  }
+  uint32_t value = _bit_buffer & ((1u << count) - 1);
+  _bit_buffer >>= count;
+  _bit_count -= count;
+  return value;
+}
+
+int Inflater::decode(const Huffman& huffman) {
+  // Canonical codes of each length are consecutive, so walk the lengths
+  int code = 0, first = 0, index = 0;
+  for (int length = 1; length < 16; length++) {
+    code |= bits(1);
+    int count = huffman.count[length];
+    if (code - count < first) {
+      return huffman.symbol[index + (code - first)];
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  _error = true;
+  return -1;
+}
+
+bool Inflater::build(Huffman& huffman, const uint8_t* lengths, int count) {
+  memset(huffman.count, 0, sizeof(huffman.count));
+  for (int symbol = 0; symbol < count; symbol++) {
+    huffman.count[lengths[symbol]]++;
+  }
+  
+  // Reject over-subscribed sets; incomplete ones (e.g. a single distance code) are fine
+  int left = 1;
+  for (int length = 1; length < 16; length++) {
+    left = (left << 1) - huffman.count[length];
+    if (left < 0) {
+      return false;
+    }
+  }
+  
+  uint16_t offsets[16];
+  offsets[1] = 0;
+  for (int length = 1; length < 15; length++) {
+    offsets[length + 1] = offsets[length] + huffman.count[length];
+  }
+  for (int symbol = 0; symbol < count; symbol++) {
+    if (lengths[symbol] != 0) {
+      huffman.symbol[offsets[lengths[symbol]]++] = symbol;
+    }
+  }
+  return true;
+}
+
+bool Inflater::stored_block() {
+  // Byte aligned: drop the rest of the current byte
+  _bit_buffer = 0;
+  _bit_count = 0;
+  if (_end - _in < 4) {
+    _error = true;
+    return false;
+  }
+  uint16_t length = _in[0] | (_in[1] << 8);
+  uint16_t complement = _in[2] | (_in[3] << 8);
+  _in += 4;
+  if (length != static_cast<uint16_t>(~complement) || _end - _in < length) {
+    _error = true;
+    return false;
+  }
+  while (length--) {
+    put(*_in++);
+  }
+  return !_error;
+}
+
+bool Inflater::fixed_block() {
+  uint8_t lengths[288];
+  memset(lengths, 8, 144);
+  memset(lengths + 144, 9, 112);
+  memset(lengths + 256, 7, 24);
+  memset(lengths + 280, 8, 8);
+  build(_lengths, lengths, 288);
+  
+  memset(lengths, 5, 30);
+  build(_distances, lengths, 30);
+  return codes();
+}
+
+bool Inflater::dynamic_block() {
+  int literal_count = bits(5) + 257;
+  int distance_count = bits(5) + 1;
+  int code_count = bits(4) + 4;
+  if (_error || literal_count > 286 || distance_count > 30) {
+    _error = true;
+    return false;
+  }
+  
+  uint8_t lengths[286 + 30];
+  memset(lengths, 0, 19);
+  for (int index = 0; index < code_count; index++) {
+    lengths[CODE_LENGTH_ORDER[index]] = bits(3);
+  }
+  if (_error || !build(_lengths, lengths, 19)) {
+    _error = true;
+    return false;
+  }
+  
+  // Literal/length and distance code lengths, run-length coded
+  int index = 0;
+  while (index < literal_count + distance_count) {
+    int symbol = decode(_lengths);
+    if (_error) {
+      return false;
+    }
+    if (symbol < 16) {
+      lengths[index++] = symbol;
+      continue;
+    }
+    uint8_t value = 0;
+    int repeat;
+    if (symbol == 16) {
+      if (index == 0) {
+        _error = true;
+        return false;
+      }
+      value = lengths[index - 1];
+      repeat = 3 + bits(2);
+    } else if (symbol == 17) {
+      repeat = 3 + bits(3);
+    } else {
+      repeat = 11 + bits(7);
+    }
+    if (index + repeat > literal_count + distance_count) {
+      _error = true;
+      return false;
+    }
+    while (repeat--) {
+      lengths[index++] = value;
+    }
+  }
+  
+  // The end-of-block code must be present
+  if (lengths[256] == 0 ||
+      !build(_lengths, lengths, literal_count) ||
+      !build(_distances, lengths + literal_count, distance_count)) {
+    _error = true;
+    return false;
+  }
+  return codes();
+}
+
+bool Inflater::codes() {
+  for (;;) {
+    int symbol = decode(_lengths);
+    if (_error) {
+      return false;
+    }
+    if (symbol < 256) {
+      put(symbol);
+    } else if (symbol == 256) {
+      return !_error;
+    } else {
+      symbol -= 257;
+      if (symbol >= 29) {
+        _error = true;
+        return false;
+      }
+      size_t length = LENGTH_BASE[symbol] + bits(LENGTH_EXTRA[symbol]);
+      
+      int distance_symbol = decode(_distances);
+      if (_error || distance_symbol >= 30) {
+        _error = true;
+        return false;
+      }
+      size_t distance = DISTANCE_BASE[distance_symbol] + bits(DISTANCE_EXTRA[distance_symbol]);
+      if (distance > _history) {
+        // Further back than the window (or before the start of the stream)
+        _error = true;
+        return false;
+      }
+      
+      while (length-- && !_error) {
+        put(_window[(_pos - distance) & _mask]);
+      }
+    }
+    if (_error) {
+      return false;
+    }
+  }
+}
+
+void Inflater::put(uint8_t value) {
+  if (_produced == _max_output) {
+    _error = true;
+    return;
+  }
+  _window[_pos] = value;
+  _pos = (_pos + 1) & _mask;
+  _produced++;
+  _pending++;
+  if (_history <= _mask) {
+    _history++;
+  }
+  
+  // Append each stretch of the window before it is overwritten
+  if (_pos == 0) {
+    flush();
+  }
+}
+
+void Inflater::flush() {
+  if (_pending > 0) {
+    size_t start = (_pos - _pending) & _mask;
+    _out->concat(reinterpret_cast<const char*>(_window + start), _pending);
+    _pending = 0;
+  }
+}
@@ -0,0 +1,220 @@
+#include "LoopMonitor.h"
+#include <ArduinoLog.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+
+// Upper half of rtc_loop_blocked while it holds a section
+#define LOOP_BLOCKED_MAGIC 0x4C4D0000  // "LM"
+
+namespace {
+
+const uint32_t BUCKET_LIMITS_MS[LOOP_HISTOGRAM_BUCKETS - 1] = {
+  1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+};
+
+struct SectionInfo {
+  const char* name;
+  uint32_t budget_ms;   // 0: not checked
+};
+
+// Budgets leave room for normal work (a TLS connect, a frame upload) but
+// catch delay() calls and stalls
+const SectionInfo SECTIONS[LOOP_SECTION_COUNT] = {
+  { "websocket", 500 },
+  { "web_server", 100 },
+  { "timers", 250 },
+  { "display", 1000 },
+  { "portal", 100 },
+  { "idle", 0 },
+};
+
+}  // namespace
+
+// Section the watchdog found over budget, kept across resets (not power loss)
+RTC_NOINIT_ATTR uint32_t rtc_loop_blocked;
+
+LoopMonitor loop_monitor;
+
+LoopMonitor::LoopMonitor()
+  : _depth(0),
+    _iteration_start_us(0),
+    _iteration_idle_us(0),
+    _watchdog(nullptr),
+    _armed_section(LOOP_SECTION_COUNT),
+    _blocked_section(LOOP_SECTION_COUNT) {
+  memset(&_stats, 0, sizeof(_stats));
+  _stats.last_overrun_section = LOOP_SECTION_COUNT;
+  _stats.reset_section = LOOP_SECTION_COUNT;
+}
+
+void LoopMonitor::begin() {
+  if ((rtc_loop_blocked & 0xFFFF0000) == LOOP_BLOCKED_MAGIC) {
+    uint8_t section = rtc_loop_blocked & 0xFF;
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (section < LOOP_SECTION_COUNT &&
+        (reason == ESP_RST_TASK_WDT || reason == ESP_RST_INT_WDT || reason == ESP_RST_WDT ||
+         reason == ESP_RST_PANIC)) {
+      _stats.reset_section = section;
+      Log.warningln("Reset while loop() was blocked in %s", SECTIONS[section].name);
+    }
+  }
+  rtc_loop_blocked = 0;
+
+  if (_watchdog) {
+    return;
+  }
+
+  esp_timer_create_args_t args = {};
+  args.callback = watchdog_callback;
+  args.arg = this;
+  args.name = "loop_watchdog";
+  if (esp_timer_create(&args, &_watchdog) != ESP_OK) {
+    _watchdog = nullptr;
+    Log.warningln("Loop watchdog timer unavailable");
+  }
+}
+
+void LoopMonitor::begin_iteration() {
+  int64_t now = esp_timer_get_time();
+  if (_iteration_start_us != 0) {
+    int64_t busy_us = now - _iteration_start_us - _iteration_idle_us;
+    record_iteration(busy_us > 0 ? busy_us / 1000 : 0);
+  }
+  _iteration_start_us = now;
+  _iteration_idle_us = 0;
+  _depth = 0;
+  disarm();
+  clear_blocked();
+}
+
+void LoopMonitor::record_iteration(uint32_t elapsed_ms) {
+  _stats.iterations++;
+  if (elapsed_ms > _stats.max_ms) {
+    _stats.max_ms = elapsed_ms;
+  }
+
+  uint8_t bucket = 0;
+  while (bucket < LOOP_HISTOGRAM_BUCKETS - 1 && elapsed_ms >= BUCKET_LIMITS_MS[bucket]) {
+    bucket++;
+  }
+  _stats.histogram[bucket]++;
+}
+
+void LoopMonitor::begin_section(LoopSection section) {
+  if (_depth >= MAX_DEPTH) {
+    // Too deep to attribute; the time stays with the enclosing section
+    _depth++;
+    return;
+  }
+
+  _frames[_depth] = { section, esp_timer_get_time(), 0 };
+  _depth++;
+  arm(section);
+}
+
+void LoopMonitor::end_section() {
+  if (_depth == 0) {
+    return;
+  }
+  _depth--;
+  if (_depth >= MAX_DEPTH) {
+    return;
+  }
+
+  // The section returned after all; an overrun is counted and logged below
+  disarm();
+  clear_blocked();
+
+  const Frame& frame = _frames[_depth];
+  int64_t elapsed_us = esp_timer_get_time() - frame.start_us;
+  uint32_t own_ms = (elapsed_us - frame.child_us) / 1000;
+
+  if (_depth > 0) {
+    // Watch the enclosing section again, with a fresh budget from here
+    _frames[_depth - 1].child_us += elapsed_us;
+    arm(_frames[_depth - 1].section);
+  }
+
+  if (frame.section == LOOP_IDLE) {
+    _iteration_idle_us += elapsed_us;
+  }
+
+  LoopSectionStats& stats = _stats.sections[frame.section];
+  stats.total_ms += own_ms;
+  if (own_ms > stats.max_ms) {
+    stats.max_ms = own_ms;
+  }
+
+  uint32_t budget_ms = SECTIONS[frame.section].budget_ms;
+  if (budget_ms > 0 && own_ms > budget_ms) {
+    stats.overruns++;
+    _stats.last_overrun_section = frame.section;
+    _stats.last_overrun_ms = own_ms;
+    Log.warningln("Loop section %s took %lu ms (budget %lu ms)", SECTIONS[frame.section].name,
+                  (unsigned long)own_ms, (unsigned long)budget_ms);
+  }
+}
+
+// One-shot for the section's budget; idle and other unbudgeted sections stay unwatched
+void LoopMonitor::arm(uint8_t section) {
+  disarm();
+  uint32_t budget_ms = SECTIONS[section].budget_ms;
+  if (!_watchdog || budget_ms == 0) {
+    return;
+  }
+  _armed_section = section;
+  esp_timer_start_once(_watchdog, (uint64_t)budget_ms * 1000);
+}
+
+void LoopMonitor::disarm() {
+  if (_watchdog && _armed_section < LOOP_SECTION_COUNT) {
+    esp_timer_stop(_watchdog);
+  }
+  _armed_section = LOOP_SECTION_COUNT;
+}
+
+void LoopMonitor::clear_blocked() {
+  if (_blocked_section < LOOP_SECTION_COUNT) {
+    _blocked_section = LOOP_SECTION_COUNT;
+    rtc_loop_blocked = 0;
+  }
+}
+
+// Runs on the esp_timer task, so it only records; loop() does the reporting
+void LoopMonitor::watchdog_callback(void* monitor) {
+  LoopMonitor* self = static_cast<LoopMonitor*>(monitor);
+  uint8_t section = self->_armed_section;
+  if (section >= LOOP_SECTION_COUNT) {
+    return;
+  }
+  self->_blocked_section = section;
+  rtc_loop_blocked = LOOP_BLOCKED_MAGIC | section;
+}
+
+uint32_t LoopMonitor::percentile_ms(const LoopStats& stats, uint8_t percent) {
+  if (stats.iterations == 0) {
+    return 0;
+  }
+
+  uint64_t target = ((uint64_t)stats.iterations * percent + 99) / 100;
+  uint64_t seen = 0;
+  for (uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS - 1; bucket++) {
+    seen += stats.histogram[bucket];
+    if (seen >= target) {
+      return min(BUCKET_LIMITS_MS[bucket], stats.max_ms);
+    }
+  }
+  return stats.max_ms;
+}
+
+uint32_t LoopMonitor::bucket_limit_ms(uint8_t bucket) {
+  return bucket < LOOP_HISTOGRAM_BUCKETS - 1 ? BUCKET_LIMITS_MS[bucket] : 0;
+}
+
+const char* LoopMonitor::section_name(uint8_t section) {
+  return section < LOOP_SECTION_COUNT ? SECTIONS[section].name : "none";
+}
+
+uint32_t LoopMonitor::section_budget_ms(uint8_t section) {
+  return section < LOOP_SECTION_COUNT ? SECTIONS[section].budget_ms : 0;
+}
@@ -0,0 +1,54 @@
+#include "MonoRaster.h"
+
+MonoRaster::MonoRaster(uint16_t width, uint16_t height)
+  : GFXcanvas1(width, height), _plane(getBuffer(), width, height) {
+}
+
+void MonoRaster::fill_span(int16_t x, int16_t y, int16_t width, uint16_t color) {
+  fillRect(x, y, width, 1, color);
+}
+
+void MonoRaster::draw_bitmap(int16_t x, int16_t y, const uint8_t* bitmap, int16_t width, int16_t height, uint16_t color) {
+  _plane.blit_bits(getRotation(), x, y, bitmap, ((width + 7) / 8) * 8, width, height, color);
+}
+
+void MonoRaster::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  _plane.fill_rect(getRotation(), x, y, w, h, color);
+}
+
+void MonoRaster::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void MonoRaster::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+size_t MonoRaster::write(uint8_t c) {
+  if (!gfxFont || textsize_x != 1 || textsize_y != 1) {
+    return GFXcanvas1::write(c);
+  }
+
+  // Same cursor handling as Adafruit_GFX::write for custom fonts
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += gfxFont->yAdvance;
+    return 1;
+  }
+  if (c == '\r' || c < gfxFont->first || c > gfxFont->last) {
+    return 1;
+  }
+
+  const GFXglyph& glyph = gfxFont->glyph[c - gfxFont->first];
+  if (glyph.width > 0 && glyph.height > 0) {
+    if (wrap && cursor_x + glyph.xOffset + glyph.width > _width) {
+      cursor_x = 0;
+      cursor_y += gfxFont->yAdvance;
+    }
+    // Glyph bitmaps are packed without row padding
+    _plane.blit_bits(getRotation(), cursor_x + glyph.xOffset, cursor_y + glyph.yOffset,
+                     gfxFont->bitmap + glyph.bitmapOffset, glyph.width, glyph.width, glyph.height, textcolor);
+  }
+  cursor_x += glyph.xAdvance;
+  return 1;
+}
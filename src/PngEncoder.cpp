@@ -0,0 +1,247 @@
+#include "PngEncoder.h"
+#include <esp_rom_crc.h>
+
+namespace {
+
+// Deflate length and distance code tables (RFC 1951, 3.2.5)
+const uint16_t LENGTH_BASE[] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t LENGTH_EXTRA[] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const uint16_t DISTANCE_BASE[] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193
+};
+const uint8_t DISTANCE_EXTRA[] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6
+};
+
+const size_t MIN_MATCH = 3;
+const size_t MAX_MATCH = 258;
+
+const uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+// Spread the 8 bits of value to the even bit positions of a 16-bit word
+uint16_t spread_bits(uint8_t value) {
+  uint16_t x = value;
+  x = (x | (x << 4)) & 0x0F0F;
+  x = (x | (x << 2)) & 0x3333;
+  x = (x | (x << 1)) & 0x5555;
+  return x;
+}
+
+void put_be32(uint8_t* out, uint32_t value) {
+  out[0] = value >> 24;
+  out[1] = value >> 16;
+  out[2] = value >> 8;
+  out[3] = value;
+}
+
+}  // namespace
+
+PngEncoder::PngEncoder(Writer writer)
+  : _writer(writer), _failed(false), _bit_buffer(0), _bit_count(0), _idat_length(0) {
+}
+
+bool PngEncoder::encode_mono(const uint8_t* bitmap, int width, int height) {
+  size_t row_bytes = (width + 7) / 8;
+
+  // PNG gray 0 is black, so invert
+  return encode(width, height, 1, row_bytes, [bitmap, row_bytes](int y, uint8_t* row) {
+    const uint8_t* source = bitmap + y * row_bytes;
+    for (size_t x = 0; x < row_bytes; x++) {
+      row[x] = ~source[x];
+    }
+  });
+}
+
+bool PngEncoder::encode_gray2(const uint8_t* plane0, const uint8_t* plane1, int width, int height) {
+  size_t plane_row_bytes = (width + 7) / 8;
+
+  // Interleave the planes into 2-bit pixels and invert (PNG gray 3 is white)
+  return encode(width, height, 2, (width + 3) / 4, [=](int y, uint8_t* row) {
+    const uint8_t* low = plane0 + y * plane_row_bytes;
+    const uint8_t* high = plane1 + y * plane_row_bytes;
+    for (size_t x = 0; x < plane_row_bytes; x++) {
+      uint16_t pixels = ~(spread_bits(high[x]) << 1 | spread_bits(low[x]));
+      row[2 * x] = pixels >> 8;
+      if (2 * x + 1 < (size_t)(width + 3) / 4) {
+        row[2 * x + 1] = pixels;
+      }
+    }
+  });
+}
+
+bool PngEncoder::encode(int width, int height, uint8_t bit_depth, size_t row_bytes, const RowSource& source) {
+  if (row_bytes > MAX_ROW_BYTES) {
+    return false;
+  }
+
+  if (!_writer(PNG_SIGNATURE, sizeof(PNG_SIGNATURE))) {
+    return false;
+  }
+
+  // Grayscale, no interlace
+  uint8_t header[13];
+  put_be32(header, width);
+  put_be32(header + 4, height);
+  header[8] = bit_depth;
+  header[9] = 0;   // Color type: grayscale
+  header[10] = 0;  // Compression
+  header[11] = 0;  // Filter method
+  header[12] = 0;  // No interlace
+  if (!write_chunk("IHDR", header, sizeof(header))) {
+    return false;
+  }
+
+  // zlib header: deflate, 32K window, no dictionary, fastest
+  write_byte(0x78);
+  write_byte(0x01);
+
+  // Rows are filter byte 0 followed by pixels
+  uint8_t rows[2][MAX_ROW_BYTES + 1];
+  uint32_t adler_a = 1, adler_b = 0;
+  for (int y = 0; y < height && !_failed; y++) {
+    uint8_t* row = rows[y & 1];
+    const uint8_t* previous = y > 0 ? rows[(y - 1) & 1] : nullptr;
+    row[0] = 0;
+    source(y, row + 1);
+
+    for (size_t i = 0; i <= row_bytes; i++) {
+      adler_a = (adler_a + row[i]) % 65521;
+      adler_b = (adler_b + adler_a) % 65521;
+    }
+
+    deflate_row(row, previous, row_bytes + 1, y == height - 1);
+  }
+
+  // Pad the final deflate byte, then the zlib checksum
+  if (_bit_count > 0) {
+    write_byte(_bit_buffer);
+    _bit_buffer = 0;
+    _bit_count = 0;
+  }
+  uint32_t adler = (adler_b << 16) | adler_a;
+  write_byte(adler >> 24);
+  write_byte(adler >> 16);
+  write_byte(adler >> 8);
+  write_byte(adler);
+
+  return flush_idat() && write_chunk("IEND", nullptr, 0);
+}
+
+void PngEncoder::deflate_row(const uint8_t* row, const uint8_t* previous, size_t length, bool last) {
+  // Block header: BFINAL, BTYPE = 01 (fixed Huffman)
+  write_bits(last ? 1 : 0, 1);
+  write_bits(1, 2);
+
+  size_t i = 0;
+  while (i < length) {
+    // Match against the row above (distance = one row of the uncompressed stream)
+    size_t up_length = 0;
+    if (previous) {
+      while (i + up_length < length && up_length < MAX_MATCH && row[i + up_length] == previous[i + up_length]) {
+        up_length++;
+      }
+    }
+
+    // Run of the previous byte (distance 1)
+    size_t run_length = 0;
+    if (i > 0) {
+      while (i + run_length < length && run_length < MAX_MATCH && row[i + run_length] == row[i - 1]) {
+        run_length++;
+      }
+    }
+
+    if (up_length >= MIN_MATCH && up_length >= run_length) {
+      write_match(up_length, length);
+      i += up_length;
+    } else if (run_length >= MIN_MATCH) {
+      write_match(run_length, 1);
+      i += run_length;
+    } else {
+      write_literal(row[i]);
+      i++;
+    }
+  }
+
+  // End of block
+  write_huffman(0, 7);
+}
+
+void PngEncoder::write_literal(uint8_t value) {
+  if (value < 144) {
+    write_huffman(0x30 + value, 8);
+  } else {
+    write_huffman(0x190 + (value - 144), 9);
+  }
+}
+
+void PngEncoder::write_match(size_t length, size_t distance) {
+  uint8_t code = 0;
+  while (code < 28 && LENGTH_BASE[code + 1] <= length) {
+    code++;
+  }
+  uint16_t symbol = 257 + code;
+  if (symbol < 280) {
+    write_huffman(symbol - 256, 7);
+  } else {
+    write_huffman(0xc0 + (symbol - 280), 8);
+  }
+  write_bits(length - LENGTH_BASE[code], LENGTH_EXTRA[code]);
+
+  uint8_t distance_code = 0;
+  while (distance_code < 15 && DISTANCE_BASE[distance_code + 1] <= distance) {
+    distance_code++;
+  }
+  write_huffman(distance_code, 5);
+  write_bits(distance - DISTANCE_BASE[distance_code], DISTANCE_EXTRA[distance_code]);
+}
+
+void PngEncoder::write_huffman(uint16_t code, uint8_t length) {
+  // Huffman codes are packed starting with the most significant bit
+  uint16_t reversed = 0;
+  for (uint8_t i = 0; i < length; i++) {
+    reversed = (reversed << 1) | ((code >> i) & 1);
+  }
+  write_bits(reversed, length);
+}
+
+void PngEncoder::write_bits(uint32_t value, uint8_t count) {
+  _bit_buffer |= value << _bit_count;
+  _bit_count += count;
+  while (_bit_count >= 8) {
+    write_byte(_bit_buffer & 0xff);
+    _bit_buffer >>= 8;
+    _bit_count -= 8;
+  }
+}
+
+void PngEncoder::write_byte(uint8_t value) {
+  _chunk[8 + _idat_length++] = value;
+  if (_idat_length == IDAT_SIZE) {
+    flush_idat();
+  }
+}
+
+bool PngEncoder::flush_idat() {
+  if (_idat_length > 0 && !_failed) {
+    _failed = !write_chunk("IDAT", nullptr, _idat_length);
+  }
+  _idat_length = 0;
+  return !_failed;
+}
+
+bool PngEncoder::write_chunk(const char* type, const uint8_t* data, size_t length) {
+  // IDAT payloads are already in place; other chunks are small and copied in
+  if (data) {
+    memcpy(_chunk + 8, data, length);
+  }
+  put_be32(_chunk, length);
+  memcpy(_chunk + 4, type, 4);
+  put_be32(_chunk + 8 + length, esp_rom_crc32_le(0, _chunk + 4, length + 4));
+  return _writer(_chunk, length + 12);
+}
@@ -0,0 +1,182 @@
+#include "RasterPlane.h"
+
+RasterPlane::RasterPlane(uint8_t* buffer, int16_t width, int16_t height)
+  : _buffer(buffer), _width(width), _height(height), _stride((width + 7) / 8) {
+}
+
+void RasterPlane::fill_rect(uint8_t rotation, int16_t x, int16_t y, int16_t w, int16_t h, bool color) {
+  if (to_raw_rect(rotation, x, y, w, h)) {
+    fill_raw_rect(x, y, w, h, color);
+  }
+}
+
+bool RasterPlane::to_raw_rect(uint8_t rotation, int16_t& x, int16_t& y, int16_t& w, int16_t& h) const {
+  if (w < 0) {
+    x += w + 1;
+    w = -w;
+  }
+  if (h < 0) {
+    y += h + 1;
+    h = -h;
+  }
+
+  // Same mapping as GFXcanvas1::drawPixel, applied to the corners
+  int16_t t;
+  switch (rotation) {
+    case 1:
+      t = x;
+      x = _width - y - h;
+      y = t;
+      t = w;
+      w = h;
+      h = t;
+      break;
+    case 2:
+      x = _width - x - w;
+      y = _height - y - h;
+      break;
+    case 3:
+      t = x;
+      x = y;
+      y = _height - t - w;
+      t = w;
+      w = h;
+      h = t;
+      break;
+  }
+
+  // Clip to the buffer
+  if (x < 0) {
+    w += x;
+    x = 0;
+  }
+  if (y < 0) {
+    h += y;
+    y = 0;
+  }
+  if (x + w > _width) {
+    w = _width - x;
+  }
+  if (y + h > _height) {
+    h = _height - y;
+  }
+  return w > 0 && h > 0;
+}
+
+void RasterPlane::fill_raw_rect(int16_t x, int16_t y, int16_t w, int16_t h, bool color) {
+  uint8_t* row = _buffer + y * _stride;
+  int16_t end = x + w - 1;  // Inclusive
+  int16_t first_byte = x / 8;
+  int16_t last_byte = end / 8;
+  uint8_t first_mask = 0xFF >> (x & 7);
+  uint8_t last_mask = 0xFF << (7 - (end & 7));
+  uint8_t fill = color ? 0xFF : 0x00;
+  uint32_t fill_word = color ? 0xFFFFFFFF : 0;
+
+  if (first_byte == last_byte) {
+    // Narrow rectangle (e.g. a vertical line): one masked byte per row
+    uint8_t mask = first_mask & last_mask;
+    for (int16_t r = 0; r < h; r++, row += _stride) {
+      row[first_byte] = color ? (row[first_byte] | mask) : (row[first_byte] & ~mask);
+    }
+    return;
+  }
+
+  for (int16_t r = 0; r < h; r++, row += _stride) {
+    uint8_t* p = row + first_byte;
+    uint8_t* last = row + last_byte;
+    *p = color ? (*p | first_mask) : (*p & ~first_mask);
+    p++;
+
+    // Whole bytes up to a word boundary, then whole words, then the rest
+    while (p < last && (reinterpret_cast<uintptr_t>(p) & 3)) {
+      *p++ = fill;
+    }
+    while (last - p >= 4) {
+      *reinterpret_cast<uint32_t*>(p) = fill_word;
+      p += 4;
+    }
+    while (p < last) {
+      *p++ = fill;
+    }
+
+    *last = color ? (*last | last_mask) : (*last & ~last_mask);
+  }
+}
+
+void RasterPlane::blit_bits(uint8_t rotation, int16_t x, int16_t y, const uint8_t* bits, uint32_t row_bits,
+                            int16_t w, int16_t h, bool color) {
+  if (rotation == 0) {
+    // Unrotated: shift source bytes into place, eight pixels per step
+    int16_t first_column = x < 0 ? -x : 0;
+    int16_t end_column = x + w > _width ? _width - x : w;
+    for (int16_t r = 0; r < h; r++) {
+      int16_t row = y + r;
+      if (row < 0 || row >= _height) continue;
+      uint8_t* dest = _buffer + row * _stride;
+      uint32_t row_start = r * row_bits;
+
+      for (int16_t c = first_column; c < end_column; c += 8) {
+        uint32_t position = row_start + c;
+        const uint8_t* source = bits + position / 8;
+        uint8_t offset = position & 7;
+        int16_t remaining = end_column - c;
+
+        // Next eight source pixels, without reading past the last needed byte
+        uint8_t value = source[0] << offset;
+        if (offset && remaining > 8 - offset) {
+          value |= source[1] >> (8 - offset);
+        }
+        if (remaining < 8) {
+          value &= 0xFF << (8 - remaining);
+        }
+        if (!value) continue;
+
+        int16_t column = x + c;
+        uint8_t shift = column & 7;
+        uint8_t* target = dest + column / 8;
+        uint8_t high = value >> shift;
+        uint8_t low = shift ? value << (8 - shift) : 0;
+        if (color) {
+          target[0] |= high;
+          if (low) target[1] |= low;
+        } else {
+          target[0] &= ~high;
+          if (low) target[1] &= ~low;
+        }
+      }
+    }
+    return;
+  }
+
+  // Rotated: work out where the origin lands and which way the source rows and
+  // columns run in the buffer once, then step through the pixels
+  int16_t origin_x, origin_y, column_dx, column_dy, row_dx, row_dy;
+  switch (rotation) {
+    case 1:
+      origin_x = _width - 1 - y; origin_y = x;
+      column_dx = 0; column_dy = 1; row_dx = -1; row_dy = 0;
+      break;
+    case 2:
+      origin_x = _width - 1 - x; origin_y = _height - 1 - y;
+      column_dx = -1; column_dy = 0; row_dx = 0; row_dy = -1;
+      break;
+    default:
+      origin_x = y; origin_y = _height - 1 - x;
+      column_dx = 0; column_dy = -1; row_dx = 1; row_dy = 0;
+      break;
+  }
+
+  for (int16_t r = 0; r < h; r++) {
+    uint32_t position = r * row_bits;
+    int16_t px = origin_x + r * row_dx;
+    int16_t py = origin_y + r * row_dy;
+    for (int16_t c = 0; c < w; c++, position++, px += column_dx, py += column_dy) {
+      if (!(bits[position / 8] & (0x80 >> (position & 7)))) continue;
+      if (px < 0 || px >= _width || py < 0 || py >= _height) continue;
+      uint8_t* target = _buffer + py * _stride + px / 8;
+      uint8_t mask = 0x80 >> (px & 7);
+      *target = color ? (*target | mask) : (*target & ~mask);
+    }
+  }
+}
@@ -0,0 +1,97 @@
+#include "SleepScheduler.h"
+#include <ArduinoLog.h>
+#include <esp_sleep.h>
+
+// Volatility scaling: no changes doubles the interval, changes on half or more
+// of recent wakes halves it
+#define STABLE_FACTOR 2.0f
+#define VOLATILE_FACTOR 0.5f
+#define VOLATILE_THRESHOLD 0.5f
+
+// Battery scaling starts below this charge level and is capped at MAX_BATTERY_FACTOR
+#define BATTERY_SCALE_PERCENT 50.0f
+#define MAX_BATTERY_FACTOR 4.0f
+
+// Wakes needed before volatility is trusted
+#define MIN_HISTORY_SAMPLES 3
+
+// Per data point change history, newest wake in bit 0
+struct SleepHistory {
+  uint8_t changes[SleepScheduler::MAX_DATA_POINTS];
+  uint8_t samples;
+};
+RTC_DATA_ATTR SleepHistory rtc_sleep_history;
+
+void SleepScheduler::record_wake(uint8_t changed_mask) {
+  // History is only meaningful across deep sleep wakes
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED && rtc_sleep_history.samples > 0) {
+    memset(&rtc_sleep_history, 0, sizeof(rtc_sleep_history));
+  }
+
+  for (uint8_t i = 0; i < MAX_DATA_POINTS; i++) {
+    rtc_sleep_history.changes[i] = (rtc_sleep_history.changes[i] << 1) | ((changed_mask >> i) & 1);
+  }
+  if (rtc_sleep_history.samples < HISTORY_LENGTH) {
+    rtc_sleep_history.samples++;
+  }
+}
+
+float SleepScheduler::volatility() const {
+  if (rtc_sleep_history.samples == 0) {
+    return 0;
+  }
+
+  uint8_t any_changed = 0;
+  for (uint8_t i = 0; i < MAX_DATA_POINTS; i++) {
+    any_changed |= rtc_sleep_history.changes[i];
+  }
+
+  uint8_t window_mask = (1 << rtc_sleep_history.samples) - 1;
+  return (float)__builtin_popcount(any_changed & window_mask) / rtc_sleep_history.samples;
+}
+
+uint32_t SleepScheduler::next_interval_seconds(const ConfigData& config, float battery_percent) {
+  uint32_t base_seconds = config.sleep_duration_minutes * 60;
+  if (!config.adaptive_sleep) {
+    snprintf(_reason, sizeof(_reason), "fixed");
+    return base_seconds;
+  }
+
+  // Scale by how often values changed recently
+  float volatility_factor = 1.0f;
+  const char* volatility_label = "warming up";
+  if (rtc_sleep_history.samples >= MIN_HISTORY_SAMPLES) {
+    float rate = volatility();
+    if (rate >= VOLATILE_THRESHOLD) {
+      volatility_factor = VOLATILE_FACTOR;
+      volatility_label = "volatile";
+    } else {
+      // Linear from STABLE_FACTOR at no changes to 1.0 just below the threshold
+      volatility_factor = STABLE_FACTOR - (STABLE_FACTOR - 1.0f) * (rate / VOLATILE_THRESHOLD);
+      volatility_label = rate == 0 ? "stable" : "mixed";
+    }
+  }
+
+  // Stretch the interval as the battery runs down
+  float battery_factor = 1.0f;
+  if (battery_percent >= 0 && battery_percent < BATTERY_SCALE_PERCENT) {
+    battery_factor = BATTERY_SCALE_PERCENT / max(battery_percent, BATTERY_SCALE_PERCENT / MAX_BATTERY_FACTOR);
+  }
+
+  uint32_t seconds = base_seconds * volatility_factor * battery_factor;
+  uint32_t min_seconds = config.sleep_min_minutes * 60;
+  uint32_t max_seconds = max(config.sleep_max_minutes, config.sleep_min_minutes) * 60;
+  const char* clamp_label = "";
+  if (seconds < min_seconds) {
+    seconds = min_seconds;
+    clamp_label = ", min";
+  } else if (seconds > max_seconds) {
+    seconds = max_seconds;
+    clamp_label = ", max";
+  }
+
+  snprintf(_reason, sizeof(_reason), "%s x%.2f, battery x%.2f%s",
+           volatility_label, volatility_factor, battery_factor, clamp_label);
+  Log.verboseln("Adaptive sleep: %d s (%s)", seconds, _reason);
+  return seconds;
+}
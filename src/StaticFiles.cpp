@@ -0,0 +1,76 @@
+#include "StaticFiles.h"
+#include <ArduinoLog.h>
+#include <esp_rom_crc.h>
+
+// Number of files whose ETag is remembered, and read size while hashing
+#define ETAG_CACHE_SIZE 8
+#define HASH_CHUNK_SIZE 512
+
+// Files on LittleFS only change when a new filesystem image is uploaded, which
+// restarts the device, so hashes stay valid for the life of the process
+struct ETagCacheEntry {
+  char path[32];
+  char etag[20];
+};
+static ETagCacheEntry etag_cache[ETAG_CACHE_SIZE];
+static uint8_t etag_cache_count = 0;
+
+bool StaticFiles::serve(HttpRequest& request, const String& path, const char* content_type) {
+  String file_path = path;
+  String gzip_path = path + ".gz";
+  if (request.header("Accept-Encoding").indexOf("gzip") >= 0 && LittleFS.exists(gzip_path)) {
+    file_path = gzip_path;
+  } else if (!LittleFS.exists(path)) {
+    return false;
+  }
+
+  File file = LittleFS.open(file_path, "r");
+  if (!file) {
+    return false;
+  }
+
+  String etag = etag_for(file_path, file);
+  request.send_header("ETag", etag);
+  // Not fingerprinted, so always revalidate; a match costs only a 304
+  request.send_header("Cache-Control", "no-cache");
+  request.send_header("Vary", "Accept-Encoding");
+
+  if (request.header("If-None-Match") == etag) {
+    file.close();
+    request.send(304);
+    return true;
+  }
+
+  // send_file adds Content-Encoding: gzip for files ending in .gz
+  request.send_file(file, content_type);
+  file.close();
+  return true;
+}
+
+String StaticFiles::etag_for(const String& path, File& file) {
+  for (uint8_t i = 0; i < etag_cache_count; i++) {
+    if (path == etag_cache[i].path) {
+      return etag_cache[i].etag;
+    }
+  }
+
+  uint8_t buffer[HASH_CHUNK_SIZE];
+  uint32_t crc = 0;
+  size_t length;
+  while ((length = file.read(buffer, sizeof(buffer))) > 0) {
+    crc = esp_rom_crc32_le(crc, buffer, length);
+  }
+  file.seek(0);
+
+  char etag[20];
+  snprintf(etag, sizeof(etag), "\"%08x-%x\"", crc, (unsigned)file.size());
+
+  if (etag_cache_count < ETAG_CACHE_SIZE && path.length() < sizeof(etag_cache[0].path)) {
+    ETagCacheEntry& entry = etag_cache[etag_cache_count++];
+    strlcpy(entry.path, path.c_str(), sizeof(entry.path));
+    strlcpy(entry.etag, etag, sizeof(entry.etag));
+  } else {
+    Log.verboseln("ETag cache full, hashing %s on every request", path.c_str());
+  }
+  return etag;
+}
@@ -0,0 +1,161 @@
+#include "TimerScheduler.h"
+
+TimerScheduler::TimerScheduler() : _count(0), _heap_size(0) {
+  memset(_timers, 0, sizeof(_timers));
+  for (uint8_t i = 0; i < MAX_TIMERS; i++) {
+    _heap[i] = INVALID_TIMER;
+    _position[i] = -1;
+  }
+}
+
+TimerScheduler::TimerId TimerScheduler::add(Callback callback, uint32_t interval_ms, uint16_t repeats) {
+  if (_count >= MAX_TIMERS || !callback) {
+    return INVALID_TIMER;
+  }
+
+  TimerId id = _count++;
+  _timers[id] = { callback, interval_ms, 0, repeats, 0 };
+  return id;
+}
+
+void TimerScheduler::start(TimerId id) {
+  if (!valid(id)) {
+    return;
+  }
+
+  Timer& timer = _timers[id];
+  timer.remaining = timer.repeats;
+  schedule(id, millis() + timer.interval_ms);
+}
+
+void TimerScheduler::stop(TimerId id) {
+  if (valid(id)) {
+    unschedule(id);
+  }
+}
+
+bool TimerScheduler::running(TimerId id) const {
+  return valid(id) && _position[id] >= 0;
+}
+
+void TimerScheduler::set_interval(TimerId id, uint32_t interval_ms) {
+  if (valid(id)) {
+    _timers[id].interval_ms = interval_ms;
+  }
+}
+
+void TimerScheduler::update() {
+  uint32_t now = millis();
+
+  // Callbacks may start or stop timers, so re-check the top after each one.
+  // A timer rescheduled by its own callback is due after now at the earliest.
+  while (_heap_size > 0 && (int32_t)(now - _timers[_heap[0]].deadline_ms) >= 0) {
+    TimerId id = _heap[0];
+    Timer& timer = _timers[id];
+
+    bool last_run = timer.repeats > 0 && --timer.remaining == 0;
+    if (last_run) {
+      unschedule(id);
+    } else {
+      schedule(id, now + max(timer.interval_ms, (uint32_t)1));
+    }
+
+    timer.callback();
+  }
+}
+
+bool TimerScheduler::next_deadline(uint32_t& deadline_ms) const {
+  if (_heap_size == 0) {
+    return false;
+  }
+  deadline_ms = _timers[_heap[0]].deadline_ms;
+  return true;
+}
+
+uint32_t TimerScheduler::ms_until_next(uint32_t limit_ms) const {
+  uint32_t deadline_ms;
+  if (!next_deadline(deadline_ms)) {
+    return limit_ms;
+  }
+
+  int32_t remaining_ms = (int32_t)(deadline_ms - millis());
+  if (remaining_ms <= 0) {
+    return 0;
+  }
+  return min((uint32_t)remaining_ms, limit_ms);
+}
+
+bool TimerScheduler::earlier(TimerId a, TimerId b) const {
+  return (int32_t)(_timers[a].deadline_ms - _timers[b].deadline_ms) < 0;
+}
+
+void TimerScheduler::schedule(TimerId id, uint32_t deadline_ms) {
+  _timers[id].deadline_ms = deadline_ms;
+
+  if (_position[id] < 0) {
+    place(_heap_size++, id);
+    sift_up(_position[id]);
+  } else {
+    // Moved either way; only one of these does anything
+    sift_up(_position[id]);
+    sift_down(_position[id]);
+  }
+}
+
+void TimerScheduler::unschedule(TimerId id) {
+  int8_t index = _position[id];
+  if (index < 0) {
+    return;
+  }
+
+  _position[id] = -1;
+  _heap_size--;
+  if (index == _heap_size) {
+    _heap[index] = INVALID_TIMER;
+    return;
+  }
+
+  // Fill the hole with the last entry and restore the heap order around it
+  TimerId moved = _heap[_heap_size];
+  _heap[_heap_size] = INVALID_TIMER;
+  place(index, moved);
+  sift_up(index);
+  sift_down(_position[moved]);
+}
+
+void TimerScheduler::place(uint8_t index, TimerId id) {
+  _heap[index] = id;
+  _position[id] = index;
+}
+
+void TimerScheduler::sift_up(uint8_t index) {
+  TimerId id = _heap[index];
+  while (index > 0) {
+    uint8_t parent = (index - 1) / 2;
+    if (!earlier(id, _heap[parent])) {
+      break;
+    }
+    place(index, _heap[parent]);
+    index = parent;
+  }
+  place(index, id);
+}
+
+void TimerScheduler::sift_down(uint8_t index) {
+  TimerId id = _heap[index];
+  while (true) {
+    uint8_t child = index * 2 + 1;
+    if (child >= _heap_size) {
+      break;
+    }
+    if (child + 1 < _heap_size && earlier(_heap[child + 1], _heap[child])) {
+      child++;
+    }
+    if (!earlier(_heap[child], id)) {
+      break;
+    }
+    place(index, _heap[child]);
+    index = child;
+  }
+  place(index, id);
+}
@@ -0,0 +1,400 @@
+#include "TlsClient.h"
+#include <ArduinoLog.h>
+#include <LittleFS.h>
+#include <esp_rom_crc.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/version.h>
+#include <mbedtls/x509_crt.h>
+
+// CA certificates used when no fingerprint is pinned
+#define TLS_CA_PATH "/ca.pem"
+
+// Largest serialized session kept across deep sleep. With the peer certificate
+// kept in the session (the IDF default) a typical session is 1-1.8 KB.
+#define TLS_SESSION_MAX_BYTES 2048
+
+#define TLS_MASTER_SECRET_BYTES 48
+
+// mbedtls 3 made the session fields private
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+#define TLS_SESSION_MASTER(session) ((session).MBEDTLS_PRIVATE(master))
+#else
+#define TLS_SESSION_MASTER(session) ((session).master)
+#endif
+
+struct TlsClient::Context {
+  mbedtls_ssl_context ssl;
+  mbedtls_ssl_config config;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_entropy_context entropy;
+  mbedtls_x509_crt ca;
+  uint32_t trust;                                     // CRC of the pin or CA file in use
+  unsigned char offered_master[TLS_MASTER_SECRET_BYTES];
+
+  Context() {
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&config);
+    mbedtls_ctr_drbg_init(&drbg);
+    mbedtls_entropy_init(&entropy);
+    mbedtls_x509_crt_init(&ca);
+    trust = 0;
+  }
+
+  ~Context() {
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&config);
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropy);
+    mbedtls_x509_crt_free(&ca);
+    memset(offered_master, 0, sizeof(offered_master));
+  }
+};
+
+// Session from the last handshake. Only resumed with the same server and the
+// same pin or CA file, since a resumed handshake skips certificate checks.
+struct TlsSessionCache {
+  char host[64];
+  uint16_t port;
+  uint16_t length;   // 0 when empty
+  uint32_t trust;
+  uint8_t data[TLS_SESSION_MAX_BYTES];
+};
+
+RTC_DATA_ATTR TlsSessionCache rtc_tls_session;
+
+TlsClient::TlsClient(WiFiClient& tcp)
+  : _tcp(tcp),
+    _context(nullptr),
+    _pinned(false),
+    _peer_closed(false),
+    _timeout_ms(5000),
+    _handshake_ms(0),
+    _resumed(false) {
+  memset(_fingerprint, 0, sizeof(_fingerprint));
+}
+
+TlsClient::~TlsClient() {
+  stop();
+}
+
+bool TlsClient::set_fingerprint(const String& fingerprint) {
+  _pinned = false;
+  size_t digits = 0;
+  for (size_t i = 0; i < fingerprint.length(); i++) {
+    char c = fingerprint[i];
+    if (c == ':' || c == ' ') {
+      continue;
+    }
+    int value = isdigit(c) ? c - '0' : (isxdigit(c) ? (tolower(c) - 'a' + 10) : -1);
+    if (value < 0 || digits >= 64) {
+      Log.errorln("Invalid certificate fingerprint (expected 64 hex digits)");
+      return false;
+    }
+    _fingerprint[digits / 2] = (digits & 1) ? (_fingerprint[digits / 2] | value) : (value << 4);
+    digits++;
+  }
+
+  if (digits != 0 && digits != 64) {
+    Log.errorln("Invalid certificate fingerprint (expected 64 hex digits)");
+    return false;
+  }
+  _pinned = digits == 64;
+  return true;
+}
+
+bool TlsClient::connect(const char* host, const IPAddress& address, uint16_t port, uint32_t timeout_ms) {
+  stop();
+  _timeout_ms = timeout_ms;
+  _handshake_ms = 0;
+  _resumed = false;
+  _peer_closed = false;
+
+  if (!_tcp.connect(address, port)) {
+    Log.errorln("TLS: TCP connection to %s:%d failed", host, port);
+    return false;
+  }
+  _tcp.setNoDelay(true);
+
+  unsigned long start = millis();
+  _context = new Context();
+  if (!configure(host)) {
+    stop();
+    return false;
+  }
+  bool offered = restore_session(host, port);
+
+  int ret;
+  while ((ret = mbedtls_ssl_handshake(&_context->ssl)) != 0) {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      Log.errorln("TLS handshake with %s:%d failed: -0x%04x", host, port, -ret);
+      // A stale or rejected session must not poison the next attempt
+      if (offered) {
+        forget_session();
+      }
+      stop();
+      return false;
+    }
+    if (millis() - start > _timeout_ms) {
+      Log.errorln("TLS handshake with %s:%d timed out", host, port);
+      stop();
+      return false;
+    }
+    delay(1);
+  }
+  _handshake_ms = millis() - start;
+
+  // A resumed session carries the master secret it was created with
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  if (mbedtls_ssl_get_session(&_context->ssl, &session) == 0 && offered) {
+    _resumed = memcmp(TLS_SESSION_MASTER(session), _context->offered_master, TLS_MASTER_SECRET_BYTES) == 0;
+  }
+  mbedtls_ssl_session_free(&session);
+
+  // The certificate was checked when the resumed session was first established
+  if (!_resumed && _pinned && !verify_pin()) {
+    forget_session();
+    stop();
+    return false;
+  }
+
+  save_session(host, port);
+  Log.infoln("TLS %s handshake with %s:%d in %lu ms (%s)", _resumed ? "resumed" : "full", host, port,
+             (unsigned long)_handshake_ms, mbedtls_ssl_get_ciphersuite(&_context->ssl));
+  return true;
+}
+
+bool TlsClient::configure(const char* host) {
+  Context& context = *_context;
+  const char* personalization = "hass-epaper-tls";
+  int ret = mbedtls_ctr_drbg_seed(&context.drbg, mbedtls_entropy_func, &context.entropy,
+                                  reinterpret_cast<const unsigned char*>(personalization), strlen(personalization));
+  if (ret == 0) {
+    ret = mbedtls_ssl_config_defaults(&context.config, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if (ret != 0) {
+    Log.errorln("TLS setup failed: -0x%04x", -ret);
+    return false;
+  }
+  mbedtls_ssl_conf_rng(&context.config, mbedtls_ctr_drbg_random, &context.drbg);
+
+  // Sessions are stored in the TLS 1.2 format
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+  mbedtls_ssl_conf_max_tls_version(&context.config, MBEDTLS_SSL_VERSION_TLS1_2);
+#else
+  mbedtls_ssl_conf_max_version(&context.config, MBEDTLS_SSL_MAJOR_VERSION_3, MBEDTLS_SSL_MINOR_VERSION_3);
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&context.config, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+  if (_pinned) {
+    // The pin replaces chain validation, so self-signed certificates work
+    mbedtls_ssl_conf_authmode(&context.config, MBEDTLS_SSL_VERIFY_NONE);
+    context.trust = esp_rom_crc32_le(0, _fingerprint, sizeof(_fingerprint));
+  } else {
+    File file = LittleFS.open(TLS_CA_PATH, "r");
+    if (!file) {
+      Log.errorln("wss:// needs a certificate fingerprint or CA certificates in %s", TLS_CA_PATH);
+      return false;
+    }
+    String pem = file.readString();
+    file.close();
+
+    // PEM input must include the terminating NUL
+    ret = mbedtls_x509_crt_parse(&context.ca, reinterpret_cast<const unsigned char*>(pem.c_str()), pem.length() + 1);
+    if (ret < 0) {
+      Log.errorln("Failed to parse %s: -0x%04x", TLS_CA_PATH, -ret);
+      return false;
+    }
+    if (ret > 0) {
+      Log.warningln("Skipped %d unreadable certificates in %s", ret, TLS_CA_PATH);
+    }
+    mbedtls_ssl_conf_authmode(&context.config, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_ca_chain(&context.config, &context.ca, nullptr);
+    context.trust = esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(pem.c_str()), pem.length());
+  }
+
+  ret = mbedtls_ssl_setup(&context.ssl, &context.config);
+  if (ret == 0) {
+    // Server name for SNI and, with a CA chain, the certificate hostname check
+    ret = mbedtls_ssl_set_hostname(&context.ssl, host);
+  }
+  if (ret != 0) {
+    Log.errorln("TLS setup failed: -0x%04x", -ret);
+    return false;
+  }
+  mbedtls_ssl_set_bio(&context.ssl, this, send_callback, receive_callback, nullptr);
+  return true;
+}
+
+bool TlsClient::restore_session(const char* host, uint16_t port) {
+  const TlsSessionCache& cache = rtc_tls_session;
+  if (cache.length == 0 || cache.length > sizeof(cache.data) || cache.port != port ||
+      cache.trust != _context->trust || strncmp(cache.host, host, sizeof(cache.host)) != 0) {
+    return false;
+  }
+
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  int ret = mbedtls_ssl_session_load(&session, cache.data, cache.length);
+  if (ret == 0) {
+    ret = mbedtls_ssl_set_session(&_context->ssl, &session);
+  }
+  if (ret == 0) {
+    memcpy(_context->offered_master, TLS_SESSION_MASTER(session), TLS_MASTER_SECRET_BYTES);
+  } else {
+    Log.warningln("Stored TLS session not usable: -0x%04x", -ret);
+    forget_session();
+  }
+  mbedtls_ssl_session_free(&session);
+  return ret == 0;
+}
+
+void TlsClient::save_session(const char* host, uint16_t port) {
+  TlsSessionCache& cache = rtc_tls_session;
+  if (strlen(host) >= sizeof(cache.host)) {
+    return;
+  }
+
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  size_t length = 0;
+  int ret = mbedtls_ssl_get_session(&_context->ssl, &session);
+  if (ret == 0) {
+    ret = mbedtls_ssl_session_save(&session, cache.data, sizeof(cache.data), &length);
+  }
+  mbedtls_ssl_session_free(&session);
+
+  if (ret != 0) {
+    Log.warningln("TLS session not stored (-0x%04x, %u bytes)", -ret, (unsigned)length);
+    forget_session();
+    return;
+  }
+  strncpy(cache.host, host, sizeof(cache.host));
+  cache.port = port;
+  cache.trust = _context->trust;
+  cache.length = length;
+}
+
+void TlsClient::forget_session() {
+  rtc_tls_session.length = 0;
+  memset(rtc_tls_session.data, 0, sizeof(rtc_tls_session.data));
+}
+
+bool TlsClient::verify_pin() {
+  const mbedtls_x509_crt* certificate = mbedtls_ssl_get_peer_cert(&_context->ssl);
+  if (!certificate) {
+    Log.errorln("TLS: server sent no certificate");
+    return false;
+  }
+
+  uint8_t digest[32];
+#if MBEDTLS_VERSION_NUMBER < 0x03000000
+  mbedtls_sha256_ret(certificate->raw.p, certificate->raw.len, digest, 0);
+#else
+  mbedtls_sha256(certificate->raw.p, certificate->raw.len, digest, 0);
+#endif
+  if (memcmp(digest, _fingerprint, sizeof(digest)) != 0) {
+    Log.errorln("TLS: server certificate does not match the pinned fingerprint");
+    return false;
+  }
+  return true;
+}
+
+size_t TlsClient::write(const uint8_t* data, size_t length) {
+  if (!_context) {
+    return 0;
+  }
+
+  size_t sent = 0;
+  unsigned long start = millis();
+  while (sent < length) {
+    int ret = mbedtls_ssl_write(&_context->ssl, data + sent, length - sent);
+    if (ret > 0) {
+      sent += ret;
+      continue;
+    }
+    if ((ret != MBEDTLS_ERR_SSL_WANT_WRITE && ret != MBEDTLS_ERR_SSL_WANT_READ) || millis() - start > _timeout_ms) {
+      _peer_closed = true;
+      break;
+    }
+    delay(1);
+  }
+  return sent;
+}
+
+int TlsClient::read(uint8_t* buffer, size_t length) {
+  if (!_context) {
+    return -1;
+  }
+
+  int ret = mbedtls_ssl_read(&_context->ssl, buffer, length);
+  if (ret > 0) {
+    return ret;
+  }
+  if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+    // Close notify, EOF or a fatal alert
+    _peer_closed = true;
+  }
+  return -1;
+}
+
+int TlsClient::available() {
+  if (!_context) {
+    return 0;
+  }
+
+  int pending = mbedtls_ssl_get_bytes_avail(&_context->ssl);
+  if (pending == 0 && _tcp.available() > 0) {
+    // Decrypt the next record without consuming any of it
+    int ret = mbedtls_ssl_read(&_context->ssl, nullptr, 0);
+    if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      _peer_closed = true;
+    }
+    pending = mbedtls_ssl_get_bytes_avail(&_context->ssl);
+  }
+  return pending;
+}
+
+bool TlsClient::connected() {
+  if (!_context || _peer_closed) {
+    return false;
+  }
+  return _tcp.connected() || mbedtls_ssl_get_bytes_avail(&_context->ssl) > 0;
+}
+
+void TlsClient::stop() {
+  if (_context) {
+    if (!_peer_closed && _tcp.connected()) {
+      mbedtls_ssl_close_notify(&_context->ssl);
+    }
+    delete _context;
+    _context = nullptr;
+  }
+  _tcp.stop();
+}
+
+int TlsClient::send_callback(void* client, const unsigned char* data, size_t length) {
+  WiFiClient& tcp = static_cast<TlsClient*>(client)->_tcp;
+  if (!tcp.connected()) {
+    return MBEDTLS_ERR_NET_CONN_RESET;
+  }
+  size_t written = tcp.write(data, length);
+  return written > 0 ? (int)written : MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+int TlsClient::receive_callback(void* client, unsigned char* buffer, size_t length) {
+  WiFiClient& tcp = static_cast<TlsClient*>(client)->_tcp;
+  if (tcp.available() <= 0) {
+    // 0 tells mbedtls the connection ended
+    return tcp.connected() ? MBEDTLS_ERR_SSL_WANT_READ : 0;
+  }
+  int count = tcp.read(buffer, length);
+  return count > 0 ? count : MBEDTLS_ERR_SSL_WANT_READ;
+}
@@ -0,0 +1,248 @@
+#include "WakeMetrics.h"
+#include <ArduinoLog.h>
+#include <esp_sleep.h>
+
+#define WAKE_METRICS_MAGIC 0x574B4D31  // "WKM1"
+
+// Initialize the global metrics instance
+WakeMetrics wake_metrics;
+
+// Previous wake cycle, kept across deep sleep
+RTC_DATA_ATTR uint32_t rtc_previous_metrics_magic = 0;
+RTC_DATA_ATTR WakeMetricsData rtc_previous_metrics;
+
+WakeMetrics::WakeMetrics() : _lock(nullptr) {
+  memset(&current, 0, sizeof(current));
+  current.battery_percent = -1;
+  current.loop.last_overrun_section = LOOP_SECTION_COUNT;
+  current.loop.reset_section = LOOP_SECTION_COUNT;
+  _published = current;
+}
+
+void WakeMetrics::begin(uint32_t boot_count) {
+  if (!_lock) {
+    _lock = xSemaphoreCreateMutex();
+  }
+
+  memset(&current, 0, sizeof(current));
+  current.boot_count = boot_count;
+  current.battery_percent = -1;
+  current.loop.last_overrun_section = LOOP_SECTION_COUNT;
+  current.loop.reset_section = LOOP_SECTION_COUNT;
+
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED) {
+    rtc_previous_metrics_magic = 0;
+  }
+  publish();
+}
+
+void WakeMetrics::finish() {
+  current.awake_ms = millis();
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  rtc_previous_metrics = current;
+  rtc_previous_metrics_magic = WAKE_METRICS_MAGIC;
+  _published = current;
+  xSemaphoreGive(_lock);
+}
+
+void WakeMetrics::publish() {
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  _published = current;
+  xSemaphoreGive(_lock);
+}
+
+void WakeMetrics::to_json(JsonDocument& doc) const {
+  // Copy under the lock and serialise the copies, so the loop is never held up
+  // by JSON building
+  WakeMetricsData published, previous;
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  published = _published;
+  bool has_previous = rtc_previous_metrics_magic == WAKE_METRICS_MAGIC;
+  if (has_previous) {
+    previous = rtc_previous_metrics;
+  }
+  xSemaphoreGive(_lock);
+
+  JsonObject current_object = doc["current"].to<JsonObject>();
+  data_to_json(published, current_object);
+  current_object["awake_ms"] = millis();
+
+  if (has_previous) {
+    data_to_json(previous, doc["previous"].to<JsonObject>());
+  }
+}
+
+void WakeMetrics::record_event(uint32_t latency_ms) {
+  current.events_received++;
+  current.event_latency_total_ms += latency_ms;
+  if (latency_ms > current.event_latency_max_ms) {
+    current.event_latency_max_ms = latency_ms;
+  }
+}
+
+void WakeMetrics::record_websocket(const WebsocketStats& stats) {
+  current.websocket = stats;
+}
+
+void WakeMetrics::record_connection(const HassConnectionStats& stats) {
+  current.connection = stats;
+}
+
+void WakeMetrics::record_loop(const LoopStats& stats) {
+  current.loop = stats;
+}
+
+void WakeMetrics::boot_stage_begin(BootStage stage) {
+  if (current.boot[stage].start_ms == 0) {
+    // millis() may still be 0 this early; 1 keeps "started" distinguishable
+    current.boot[stage].start_ms = max(millis(), 1UL);
+  }
+}
+
+void WakeMetrics::boot_stage_end(BootStage stage) {
+  if (current.boot[stage].start_ms != 0 && current.boot[stage].end_ms == 0) {
+    current.boot[stage].end_ms = max(millis(), (unsigned long)current.boot[stage].start_ms);
+  }
+}
+
+void WakeMetrics::boot_complete() {
+  current.boot_ms = millis();
+}
+
+void WakeMetrics::log_summary() const {
+  Log.infoln("Wake %d: awake %d ms, next sleep %d s (%s)",
+             current.boot_count, millis(), current.sleep_interval_s, current.sleep_reason);
+}
+
+void WakeMetrics::data_to_json(const WakeMetricsData& data, JsonObject object) {
+  object["boot_count"] = data.boot_count;
+  object["awake_ms"] = data.awake_ms;
+
+  JsonObject sleep = object["sleep"].to<JsonObject>();
+  sleep["interval_s"] = data.sleep_interval_s;
+  sleep["reason"] = data.sleep_reason;
+  sleep["data_volatility"] = data.data_volatility;
+  if (data.battery_percent >= 0) {
+    sleep["battery_percent"] = data.battery_percent;
+  }
+
+  JsonObject power = object["power"].to<JsonObject>();
+  power["mode"] = data.power_mode;
+  power["idle_ms"] = data.idle_ms;
+  power["events"] = data.events_received;
+  power["event_latency_max_ms"] = data.event_latency_max_ms;
+  if (data.events_received > 0) {
+    power["event_latency_avg_ms"] = data.event_latency_total_ms / data.events_received;
+  }
+  if (data.battery_percent >= 0) {
+    // Negative while discharging; compare across modes as a proxy for average current
+    power["battery_rate_percent_per_hour"] = data.battery_rate_percent_per_hour;
+  }
+
+  JsonObject websocket = object["websocket"].to<JsonObject>();
+  websocket["deflate"] = data.websocket.deflate;
+  websocket["messages"] = data.websocket.messages;
+  websocket["wire_bytes"] = data.websocket.wire_bytes;
+  websocket["payload_bytes"] = data.websocket.payload_bytes;
+  websocket["sent_bytes"] = data.websocket.sent_bytes;
+  websocket["inflate_us"] = data.websocket.inflate_us;
+  websocket["inflate_max_us"] = data.websocket.inflate_max_us;
+  if (data.websocket.messages > 0) {
+    websocket["inflate_avg_us"] = data.websocket.inflate_us / data.websocket.messages;
+  }
+  websocket["resolve_ms"] = data.websocket.resolve_ms;
+  websocket["resolve_cached"] = data.websocket.resolve_cached;
+  // Compare tls_handshake_ms of a cold boot (full) with a deep sleep wake (resumed)
+  if (data.websocket.tls) {
+    websocket["tls_resumed"] = data.websocket.tls_resumed;
+    websocket["tls_handshake_ms"] = data.websocket.tls_handshake_ms;
+  }
+
+  JsonObject connection = object["connection"].to<JsonObject>();
+  connection["auth_ms"] = data.connection.auth_ms;
+  connection["first_data_ms"] = data.connection.first_data_ms;
+  connection["queued_requests"] = data.connection.queued;
+  connection["failed_requests"] = data.connection.failed;
+  connection["messages"] = data.connection.dispatched;
+
+  JsonObject loop = object["loop"].to<JsonObject>();
+  loop["iterations"] = data.loop.iterations;
+  loop["max_ms"] = data.loop.max_ms;
+  loop["p50_ms"] = LoopMonitor::percentile_ms(data.loop, 50);
+  loop["p90_ms"] = LoopMonitor::percentile_ms(data.loop, 90);
+  loop["p99_ms"] = LoopMonitor::percentile_ms(data.loop, 99);
+  // Bucket i counts iterations shorter than bucket_limits_ms[i]; the last one is open
+  JsonArray limits = loop["bucket_limits_ms"].to<JsonArray>();
+  JsonArray histogram = loop["histogram"].to<JsonArray>();
+  for (uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; bucket++) {
+    if (bucket < LOOP_HISTOGRAM_BUCKETS - 1) {
+      limits.add(LoopMonitor::bucket_limit_ms(bucket));
+    }
+    histogram.add(data.loop.histogram[bucket]);
+  }
+  JsonObject sections = loop["sections"].to<JsonObject>();
+  for (uint8_t section = 0; section < LOOP_SECTION_COUNT; section++) {
+    const LoopSectionStats& stats = data.loop.sections[section];
+    JsonObject entry = sections[LoopMonitor::section_name(section)].to<JsonObject>();
+    entry["budget_ms"] = LoopMonitor::section_budget_ms(section);
+    entry["max_ms"] = stats.max_ms;
+    entry["total_ms"] = stats.total_ms;
+    entry["overruns"] = stats.overruns;
+  }
+  if (data.loop.last_overrun_section < LOOP_SECTION_COUNT) {
+    loop["last_overrun_section"] = LoopMonitor::section_name(data.loop.last_overrun_section);
+    loop["last_overrun_ms"] = data.loop.last_overrun_ms;
+  }
+  if (data.loop.reset_section < LOOP_SECTION_COUNT) {
+    loop["reset_while_blocked_in"] = LoopMonitor::section_name(data.loop.reset_section);
+  }
+
+  boot_to_json(data, object["boot"].to<JsonObject>());
+}
+
+// Each finished stage with its start and duration. overlap_ms is how much of
+// the stages' summed duration was hidden by running them concurrently.
+void WakeMetrics::boot_to_json(const WakeMetricsData& data, JsonObject object) {
+  static const char* const STAGE_NAMES[BOOT_STAGE_COUNT] = {
+    "config", "filesystem", "wifi", "battery", "display", "data_points"
+  };
+
+  object["total_ms"] = data.boot_ms;
+
+  // Finished stages, sorted by start time
+  BootStageTiming finished[BOOT_STAGE_COUNT];
+  uint8_t count = 0;
+  uint32_t sequential_ms = 0;
+  JsonObject stages = object["stages"].to<JsonObject>();
+  for (uint8_t stage = 0; stage < BOOT_STAGE_COUNT; stage++) {
+    const BootStageTiming& timing = data.boot[stage];
+    if (timing.start_ms == 0 || timing.end_ms == 0) {
+      continue;
+    }
+    JsonObject entry = stages[STAGE_NAMES[stage]].to<JsonObject>();
+    entry["start_ms"] = timing.start_ms;
+    entry["ms"] = timing.end_ms - timing.start_ms;
+    sequential_ms += timing.end_ms - timing.start_ms;
+
+    uint8_t i = count++;
+    while (i > 0 && finished[i - 1].start_ms > timing.start_ms) {
+      finished[i] = finished[i - 1];
+      i--;
+    }
+    finished[i] = timing;
+  }
+
+  // Wall time covered by at least one stage
+  uint32_t covered_ms = 0;
+  uint32_t covered_until_ms = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    uint32_t start_ms = max(finished[i].start_ms, covered_until_ms);
+    if (finished[i].end_ms > start_ms) {
+      covered_ms += finished[i].end_ms - start_ms;
+      covered_until_ms = finished[i].end_ms;
+    }
+  }
+
+  object["sequential_ms"] = sequential_ms;
+  object["overlap_ms"] = sequential_ms - covered_ms;
+}
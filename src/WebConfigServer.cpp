@@ -1,211 +1,322 @@
 #include "WebConfigServer.h"
-#include <functional>  // For std::bind
+#include "ConfigSchema.h"
+#include "PngEncoder.h"
+#include "StaticFiles.h"
+#include "WakeMetrics.h"
 
-WebConfigServer::WebConfigServer(ConfigManager& config_manager, int port)
-  : _config_manager(config_manager), _server(port), _restart_requested(false) {
+// How long a config update waits for the main loop to save it
+#define CONFIG_SAVE_TIMEOUT_MS 10000
+
+// Encoded /api/screen image: initial allocation and hard limit. Even
+// incompressible rows of the 250 px gray panel stay under the limit.
+#define SCREEN_PNG_RESERVE_BYTES 2048
+#define SCREEN_PNG_MAX_BYTES 12288
+
+WebConfigServer::WebConfigServer(ConfigManager& config_manager, DisplayManager* display, int port)
+  : _config_manager(config_manager), _display(display), _port(port), _restart_requested(false),
+    _has_staged_config(false), _staged_sequence(0), _saved_sequence(0), _save_succeeded(false) {
+  _lock = xSemaphoreCreateMutex();
+  _saved_signal = xSemaphoreCreateBinary();
 }
 
 void WebConfigServer::begin() {
   setup_routes();
-  _server.begin();
-  Log.infoln("Web configuration server started.");
-}
-
-void WebConfigServer::handle_client() {
-  _server.handleClient();
+  if (_server.begin(_port)) {
+    Log.infoln("Web configuration server started.");
+  }
 }
 
 bool WebConfigServer::should_restart() const {
   return _restart_requested;
 }
 
+uint8_t WebConfigServer::take_pending_changes() {
+  if (!_has_staged_config) {
+    return CONFIG_APPLY_NONE;
+  }
+
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  ConfigData previous = _config_manager;
+  *static_cast<ConfigData*>(&_config_manager) = _staged_config;
+  _has_staged_config = false;
+  uint32_t sequence = _staged_sequence;
+  xSemaphoreGive(_lock);
+
+  // Persist here rather than on the HTTP task: save_config() also rewrites the
+  // RTC copy that store_to_rtc() and deep sleep use
+  bool saved = _config_manager.save_config();
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  _saved_sequence = sequence;
+  _save_succeeded = saved;
+  xSemaphoreGive(_lock);
+  xSemaphoreGive(_saved_signal);
+
+  return _config_manager.changes_since(previous);
+}
+
+bool WebConfigServer::wait_for_save(uint32_t sequence, bool& saved) {
+  unsigned long start = millis();
+  while (true) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool done = (int32_t)(_saved_sequence - sequence) >= 0;
+    saved = _save_succeeded;
+    xSemaphoreGive(_lock);
+
+    unsigned long elapsed = millis() - start;
+    if (done || elapsed >= CONFIG_SAVE_TIMEOUT_MS) {
+      return done;
+    }
+    // Signalled after every save; a stale signal only costs another check
+    xSemaphoreTake(_saved_signal, pdMS_TO_TICKS(CONFIG_SAVE_TIMEOUT_MS - elapsed));
+  }
+}
+
 bool WebConfigServer::is_client_connected() {
-  // Check if there are any connected clients
-  return _server.client();
+  // Idle keep-alive connections don't count, so an open browser tab doesn't block sleep forever
+  return _server.is_client_active();
 }
 
 void WebConfigServer::setup_routes() {
-  // Create static function callbacks that call the appropriate instance methods
-  // This is a common pattern for ESP32 WebServer
-  
   // Root handler - serve index.html
-  _server.on("/", [this]() {
-    handle_root();
+  _server.on("/", HTTP_GET, [this](HttpRequest& request) {
+    handle_root(request);
   });
-  
+
   // Static files handler - CSS and JavaScript
-  _server.on("/styles.css", [this]() {
-    serve_file_from_fs("/www/styles.css", "text/css");
-  });
-  
-  _server.on("/script.js", [this]() {
-    serve_file_from_fs("/www/script.js", "application/javascript");
+  _server.on("/styles.css", HTTP_GET, [this](HttpRequest& request) {
+    serve_file_from_fs(request, "/www/styles.css", "text/css");
   });
-  
-  // Handle preflight OPTIONS requests
-  _server.on("/api/config", HTTP_OPTIONS, [this]() {
-    _server.sendHeader("Access-Control-Allow-Origin", "*");
-    _server.sendHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
-    _server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-    _server.send(200);
+
+  _server.on("/script.js", HTTP_GET, [this](HttpRequest& request) {
+    serve_file_from_fs(request, "/www/script.js", "application/javascript");
   });
-  
+
   // API endpoints
-  _server.on("/api/config", [this]() {
-    if (_server.method() == HTTP_GET) {
-      handle_get_config();
-    } else if (_server.method() == HTTP_POST) {
-      handle_update_config();
-    }
+  _server.on("/api/config", HTTP_GET, [this](HttpRequest& request) {
+    handle_get_config(request);
+  });
+
+  _server.on("/api/config", HTTP_POST, [this](HttpRequest& request) {
+    handle_update_config(request);
   });
-  
+
   // Handle preflight OPTIONS requests
-  _server.on("/api/restart", HTTP_OPTIONS, [this]() {
-    _server.sendHeader("Access-Control-Allow-Origin", "*");
-    _server.sendHeader("Access-Control-Allow-Methods", "POST, OPTIONS");
-    _server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-    _server.send(200);
+  _server.on("/api/config", HTTP_OPTIONS, [this](HttpRequest& request) {
+    handle_options(request, "GET, POST, OPTIONS");
   });
-  
-  _server.on("/api/restart", [this]() {
-    if (_server.method() == HTTP_POST) {
-      handle_restart();
-    }
+
+  // Field descriptions (types and bounds) generated from the config schema
+  _server.on("/api/schema", HTTP_GET, [this](HttpRequest& request) {
+    handle_get_schema(request);
+  });
+
+  // Wake cycle metrics (sleep scheduling, timings) and HTTP server statistics
+  _server.on("/api/metrics", HTTP_GET, [this](HttpRequest& request) {
+    handle_get_metrics(request);
   });
-  
+
+  // What the panel currently shows, as a PNG
+  _server.on("/api/screen", HTTP_GET, [this](HttpRequest& request) {
+    handle_get_screen(request);
+  });
+
+  _server.on("/api/restart", HTTP_POST, [this](HttpRequest& request) {
+    handle_restart(request);
+  });
+
+  // Handle preflight OPTIONS requests
+  _server.on("/api/restart", HTTP_OPTIONS, [this](HttpRequest& request) {
+    handle_options(request, "POST, OPTIONS");
+  });
+
   // 404 Not Found handler
-  _server.onNotFound([this]() {
-    handle_not_found();
+  _server.on_not_found([this](HttpRequest& request) {
+    handle_not_found(request);
   });
 }
 
-void WebConfigServer::handle_root() {
-  serve_file_from_fs("/www/index.html", "text/html");
+void WebConfigServer::handle_root(HttpRequest& request) {
+  serve_file_from_fs(request, "/www/index.html", "text/html");
 }
 
-bool WebConfigServer::serve_file_from_fs(const String& path, const String& content_type) {
-  if (LittleFS.exists(path)) {
-    File file = LittleFS.open(path, "r");
-    if (file) {
-      _server.streamFile(file, content_type);
-      file.close();
-      return true;
-    }
+bool WebConfigServer::serve_file_from_fs(HttpRequest& request, const String& path, const char* content_type) {
+  if (StaticFiles::serve(request, path, content_type)) {
+    return true;
   }
-  
+
   Log.warningln("File not found: %s", path.c_str());
-  _server.send(404, "text/plain", "File Not Found");
+  request.send(404, "text/plain", "File Not Found");
   return false;
 }
 
-void WebConfigServer::handle_get_config() {
+void WebConfigServer::send_cors_headers(HttpRequest& request) {
+  // Set CORS headers for browser compatibility
+  request.send_header("Access-Control-Allow-Origin", "*");
+  request.send_header("Access-Control-Allow-Methods", "GET, POST");
+  request.send_header("Access-Control-Allow-Headers", "Content-Type");
+}
+
+void WebConfigServer::handle_options(HttpRequest& request, const char* methods) {
+  request.send_header("Access-Control-Allow-Origin", "*");
+  request.send_header("Access-Control-Allow-Methods", methods);
+  request.send_header("Access-Control-Allow-Headers", "Content-Type");
+  request.send(200);
+}
+
+void WebConfigServer::handle_get_config(HttpRequest& request) {
+  // Report posted values even if the main loop has not applied them yet
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  ConfigManager current = _config_manager;
+  if (_has_staged_config) {
+    *static_cast<ConfigData*>(&current) = _staged_config;
+  }
+  xSemaphoreGive(_lock);
+
   JsonDocument doc;
-  
-  // WiFi settings
-  doc["wifi_ssid"] = _config_manager.wifi_ssid;
-  doc["wifi_password"] = _config_manager.wifi_password;
-  
-  // Home Assistant settings
-  doc["hass_url"] = _config_manager.hass_url;
-  doc["hass_token"] = _config_manager.hass_token;
-  
-  // Data refresh settings
-  doc["data_refresh_seconds"] = _config_manager.data_refresh_seconds;
-  doc["data_wait_ms"] = _config_manager.data_wait_ms;
-  
-  // Entity IDs
-  doc["weather_entity_id"] = _config_manager.weather_entity_id;
-  doc["alarm_entity_id"] = _config_manager.alarm_entity_id;
-  doc["temperature_unit"] = _config_manager.temperature_unit;
-  
-  // Feature flags
-  doc["listen_for_events"] = _config_manager.listen_for_events;
-  doc["wait_for_serial"] = _config_manager.wait_for_serial;
-  
-  // Power management settings
-  doc["enable_deep_sleep"] = _config_manager.enable_deep_sleep;
-  doc["sleep_duration_minutes"] = _config_manager.sleep_duration_minutes;
-  doc["disable_wifi_between_updates"] = _config_manager.disable_wifi_between_updates;
-  
+  current.to_json(doc);
+
   String response;
   serializeJson(doc, response);
-  
-  // Set CORS headers for browser compatibility
-  _server.sendHeader("Access-Control-Allow-Origin", "*");
-  _server.sendHeader("Access-Control-Allow-Methods", "GET, POST");
-  _server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-  
-  _server.send(200, "application/json", response);
+
+  send_cors_headers(request);
+  request.send(200, "application/json", response);
+}
+
+void WebConfigServer::handle_get_schema(HttpRequest& request) {
+  JsonDocument doc;
+  ConfigManager::schema_json(doc);
+
+  String response;
+  serializeJson(doc, response);
+
+  request.send_header("Access-Control-Allow-Origin", "*");
+  request.send(200, "application/json", response);
 }
 
-void WebConfigServer::handle_update_config() {
+void WebConfigServer::handle_get_metrics(HttpRequest& request) {
+  // to_json() serialises the snapshot the loop last published
+  JsonDocument doc;
+  wake_metrics.to_json(doc);
+  _server.metrics_json(doc["http"].to<JsonObject>());
+
+  String response;
+  serializeJson(doc, response);
+
+  request.send_header("Access-Control-Allow-Origin", "*");
+  request.send(200, "application/json", response);
+}
+
+void WebConfigServer::handle_get_screen(HttpRequest& request) {
+  // The panel will not refresh while the displayed frame is pinned, so only
+  // CPU work happens under the pin: no copy of the frame and no network I/O
+  uint32_t hash = 0;
+  const uint8_t* frame = _display ? _display->acquire_screen(hash) : nullptr;
+  if (!frame) {
+    request.send(503, "text/plain", "Screen contents not available yet");
+    return;
+  }
+
+  // The frame hash identifies the image, so an unchanged screen costs a 304
+  char etag[12];
+  snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)hash);
+  request.send_header("ETag", etag);
+  request.send_header("Cache-Control", "no-cache");
+  request.send_header("Access-Control-Allow-Origin", "*");
+
+  if (request.header("If-None-Match") == etag) {
+    _display->release_screen();
+    request.send(304);
+    return;
+  }
+
+  // Encode into memory, one row at a time; an e-paper UI compresses to a few KB
+  String png;
+  png.reserve(SCREEN_PNG_RESERVE_BYTES);
+  PngEncoder encoder([&png](const uint8_t* data, size_t length) {
+    if (png.length() + length > SCREEN_PNG_MAX_BYTES) {
+      return false;
+    }
+    return png.concat(reinterpret_cast<const char*>(data), length);
+  });
+  int width = _display->width(), height = _display->height();
+  bool encoded = _display->gray_levels() == 4
+    ? encoder.encode_gray2(frame, frame + ((width + 7) / 8) * height, width, height)
+    : encoder.encode_mono(frame, width, height);
+  _display->release_screen();
+
+  if (!encoded) {
+    request.send(503, "text/plain", "Screen image too large");
+    return;
+  }
+  request.send(200, "image/png", png);
+}
+
+void WebConfigServer::handle_update_config(HttpRequest& request) {
   // Check if we have a valid JSON body
-  if (!_server.hasArg("plain")) {
-    _server.send(400, "text/plain", "Missing request body");
+  const String& body = request.body();
+  if (request.sent()) {
     return;
   }
-  
-  String body = _server.arg("plain");
+  if (body.length() == 0) {
+    request.send(400, "text/plain", "Missing request body");
+    return;
+  }
+
   JsonDocument doc;
   DeserializationError error = deserializeJson(doc, body);
-  
+
   if (error) {
-    _server.send(400, "text/plain", "Invalid JSON: " + String(error.c_str()));
+    request.send(400, "text/plain", "Invalid JSON: " + String(error.c_str()));
     return;
   }
-  
-  // Update config values if they exist in the request
-  if (doc["wifi_ssd"].is<String>()) _config_manager.wifi_ssid = doc["wifi_ssid"].as<String>();
-  if (doc["wifi_password"].is<String>()) _config_manager.wifi_password = doc["wifi_password"].as<String>();
-  
-  if (doc.containsKey("hass_url")) _config_manager.hass_url = doc["hass_url"].as<String>();
-  if (doc.containsKey("hass_token")) _config_manager.hass_token = doc["hass_token"].as<String>();
-  
-  if (doc.containsKey("data_refresh_seconds")) _config_manager.data_refresh_seconds = doc["data_refresh_seconds"].as<int>();
-  if (doc.containsKey("data_wait_ms")) _config_manager.data_wait_ms = doc["data_wait_ms"].as<int>();
-  
-  if (doc.containsKey("weather_entity_id")) _config_manager.weather_entity_id = doc["weather_entity_id"].as<String>();
-  if (doc.containsKey("alarm_entity_id")) _config_manager.alarm_entity_id = doc["alarm_entity_id"].as<String>();
-  if (doc.containsKey("temperature_unit")) _config_manager.temperature_unit = doc["temperature_unit"].as<String>();
-  
-  if (doc.containsKey("listen_for_events")) _config_manager.listen_for_events = doc["listen_for_events"].as<bool>();
-  if (doc.containsKey("wait_for_serial")) _config_manager.wait_for_serial = doc["wait_for_serial"].as<bool>();
-  
-  // Power management settings
-  if (doc.containsKey("enable_deep_sleep")) _config_manager.enable_deep_sleep = doc["enable_deep_sleep"].as<bool>();
-  if (doc.containsKey("sleep_duration_minutes")) _config_manager.sleep_duration_minutes = doc["sleep_duration_minutes"].as<int>();
-  if (doc.containsKey("disable_wifi_between_updates")) _config_manager.disable_wifi_between_updates = doc["disable_wifi_between_updates"].as<bool>();
-  
-  // Save the updated configuration
-  bool success = _config_manager.save_config();
-  
-  // Set CORS headers for browser compatibility
-  _server.sendHeader("Access-Control-Allow-Origin", "*");
-  _server.sendHeader("Access-Control-Allow-Methods", "GET, POST");
-  _server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-  
-  if (success) {
-    _server.send(200, "application/json", "{\"status\":\"success\",\"message\":\"Configuration updated successfully\"}");
+
+  // Build on the live values plus any earlier update the main loop has not applied yet
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  ConfigManager staged = _config_manager;
+  if (_has_staged_config) {
+    *static_cast<ConfigData*>(&staged) = _staged_config;
+  }
+
+  // Validate and apply the fields present in the request against the schema
+  const char* invalid_field = staged.from_json(doc);
+  uint8_t changes = CONFIG_APPLY_NONE;
+  uint32_t sequence = 0;
+  if (!invalid_field) {
+    // Hand the updated configuration to the main loop, which saves it and
+    // reconfigures affected subsystems in place
+    changes = staged.changes_since(_config_manager);
+    _staged_config = staged;
+    _has_staged_config = true;
+    sequence = ++_staged_sequence;
+  }
+  xSemaphoreGive(_lock);
+
+  // Only answer once the loop has written it, so a following restart keeps it
+  bool success = false;
+  bool acknowledged = !invalid_field && wait_for_save(sequence, success);
+
+  send_cors_headers(request);
+
+  if (invalid_field) {
+    request.send(400, "application/json", String("{\"status\":\"error\",\"message\":\"Invalid value for ") + invalid_field + "\"}");
+  } else if (!acknowledged) {
+    request.send(503, "application/json", "{\"status\":\"error\",\"message\":\"Timed out waiting for the configuration to be saved\"}");
+  } else if (success) {
+    bool restart_required = (changes & CONFIG_APPLY_REBOOT) != 0;
+    request.send(200, "application/json", String("{\"status\":\"success\",\"message\":\"Configuration updated successfully\",\"restart_required\":") +
+                 (restart_required ? "true" : "false") + "}");
   } else {
-    _server.send(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to save configuration\"}");
+    request.send(500, "application/json", "{\"status\":\"error\",\"message\":\"Failed to save configuration\"}");
   }
 }
 
-void WebConfigServer::handle_restart() {
-  // Set CORS headers for browser compatibility
-  _server.sendHeader("Access-Control-Allow-Origin", "*");
-  _server.sendHeader("Access-Control-Allow-Methods", "GET, POST");
-  _server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-  
-  _server.send(200, "application/json", "{\"status\":\"success\",\"message\":\"Device will restart shortly\"}");
+void WebConfigServer::handle_restart(HttpRequest& request) {
+  send_cors_headers(request);
+  request.send(200, "application/json", "{\"status\":\"success\",\"message\":\"Device will restart shortly\"}");
   _restart_requested = true;
 }
 
-void WebConfigServer::handle_not_found() {
-  // Set CORS headers for browser compatibility
-  _server.sendHeader("Access-Control-Allow-Origin", "*");
-  _server.sendHeader("Access-Control-Allow-Methods", "GET, POST");
-  _server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
-  
-  _server.send(404, "text/plain", "404: Not found");
+void WebConfigServer::handle_not_found(HttpRequest& request) {
+  send_cors_headers(request);
+  request.send(404, "text/plain", "404: Not found");
 }
@@ -0,0 +1,592 @@
+#include "WebsocketClient.h"
+#include <ArduinoLog.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/version.h>
+#include <sys/select.h>
+
+// How long a handshake or a partly received frame may stall
+#define WS_TIMEOUT_MS 5000
+
+// Largest message accepted by default, before and after inflating
+#define WS_MAX_MESSAGE_BYTES 16384
+
+// Largest deflate window the server may use, as log2: a 4 KB inflate window
+#define WS_INFLATE_WINDOW_BITS 12
+
+// Appended to the handshake key before hashing (RFC 6455)
+#define WS_ACCEPT_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+#define WS_OPCODE_CONTINUATION 0x0
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_BINARY 0x2
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_PING 0x9
+#define WS_OPCODE_PONG 0xA
+
+#define WS_CLOSE_NORMAL 1000
+#define WS_CLOSE_PROTOCOL_ERROR 1002
+#define WS_CLOSE_INVALID_DATA 1007
+#define WS_CLOSE_TOO_BIG 1009
+
+WebsocketClient::WebsocketClient()
+  : _tls(_tcp),
+    _secure(false),
+    _open(false),
+    _offer_deflate(true),
+    _no_context_takeover(false),
+    _inflater(nullptr),
+    _max_message_bytes(WS_MAX_MESSAGE_BYTES),
+    _message_too_big(false),
+    _receiving(false),
+    _compressed(false),
+    _message_wire_bytes(0) {
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+WebsocketClient::~WebsocketClient() {
+  delete _inflater;
+}
+
+void WebsocketClient::on_message(MessageCallback callback) {
+  _on_message = callback;
+}
+
+void WebsocketClient::on_event(EventCallback callback) {
+  _on_event = callback;
+}
+
+void WebsocketClient::set_deflate(bool offer) {
+  _offer_deflate = offer;
+}
+
+void WebsocketClient::set_max_message_bytes(size_t bytes) {
+  _max_message_bytes = bytes;
+}
+
+bool WebsocketClient::set_fingerprint(const String& fingerprint) {
+  return _tls.set_fingerprint(fingerprint);
+}
+
+bool WebsocketClient::connect(const String& url) {
+  bool secure = url.startsWith("wss://");
+  if (!secure && !url.startsWith("ws://")) {
+    Log.errorln("Unsupported websocket URL (ws:// or wss:// only): %s", url.c_str());
+    return false;
+  }
+  
+  // ws[s]://host[:port][/path]
+  String rest = url.substring(secure ? 6 : 5);
+  int slash = rest.indexOf('/');
+  String authority = slash < 0 ? rest : rest.substring(0, slash);
+  String path = slash < 0 ? String("/") : rest.substring(slash);
+  String host = authority;
+  uint16_t port = secure ? 443 : 80;
+  int colon = authority.lastIndexOf(':');
+  if (colon >= 0) {
+    host = authority.substring(0, colon);
+    port = authority.substring(colon + 1).toInt();
+  }
+  
+  _secure = secure;
+  _message_too_big = false;
+  _stats.tls = secure;
+  _stats.tls_resumed = false;
+  _stats.tls_handshake_ms = 0;
+  
+  IPAddress address;
+  bool resolved = _dns.resolve(host, address);
+  _stats.resolve_ms = _dns.resolve_ms();
+  _stats.resolve_cached = _dns.cached();
+  bool connected = resolved && open_transport(host, address, port);
+  if (!connected && _dns.cached()) {
+    // The host may have a new address; look it up again and retry once
+    Log.warningln("Cached address for %s failed, resolving again", host.c_str());
+    _dns.invalidate();
+    connected = _dns.resolve(host, address) && open_transport(host, address, port);
+    _stats.resolve_ms += _dns.resolve_ms();
+    _stats.resolve_cached = false;
+  }
+  if (!connected) {
+    return false;
+  }
+  
+  if (!handshake(host, port, path)) {
+    transport_stop();
+    delete _inflater;
+    _inflater = nullptr;
+    return false;
+  }
+  
+  _open = true;
+  _receiving = false;
+  if (_on_event) {
+    _on_event(WebsocketEvent::Opened);
+  }
+  return true;
+}
+
+bool WebsocketClient::open_transport(const String& host, const IPAddress& address, uint16_t port) {
+  if (_secure) {
+    if (!_tls.connect(host.c_str(), address, port, WS_TIMEOUT_MS)) {
+      return false;
+    }
+    _stats.tls_resumed = _tls.resumed();
+    _stats.tls_handshake_ms = _tls.handshake_ms();
+    return true;
+  }
+  
+  if (!_tcp.connect(address, port)) {
+    Log.errorln("Websocket TCP connection to %s:%d failed", host.c_str(), port);
+    return false;
+  }
+  _tcp.setNoDelay(true);
+  return true;
+}
+
+bool WebsocketClient::handshake(const String& host, uint16_t port, const String& path) {
+  uint8_t nonce[16];
+  for (size_t i = 0; i < sizeof(nonce); i += 4) {
+    uint32_t value = esp_random();
+    memcpy(nonce + i, &value, 4);
+  }
+  unsigned char key[25];
+  size_t key_length = 0;
+  mbedtls_base64_encode(key, sizeof(key), &key_length, nonce, sizeof(nonce));
+  
+  String request = "GET " + path + " HTTP/1.1\r\n"
+                   "Host: " + host + ":" + String(port) + "\r\n"
+                   "Upgrade: websocket\r\n"
+                   "Connection: Upgrade\r\n"
+                   "Sec-WebSocket-Key: " + String(reinterpret_cast<const char*>(key)) + "\r\n"
+                   "Sec-WebSocket-Version: 13\r\n";
+  if (_offer_deflate) {
+    // Bound the server's window so the inflate buffer has a known size
+    request += "Sec-WebSocket-Extensions: permessage-deflate; server_max_window_bits=" + String(WS_INFLATE_WINDOW_BITS) + "\r\n";
+  }
+  request += "\r\n";
+  transport_write(reinterpret_cast<const uint8_t*>(request.c_str()), request.length());
+  
+  // Expected Sec-WebSocket-Accept: base64(SHA-1(key + GUID))
+  String accept_source = String(reinterpret_cast<const char*>(key)) + WS_ACCEPT_GUID;
+  unsigned char digest[20];
+#if MBEDTLS_VERSION_NUMBER < 0x03000000
+  mbedtls_sha1_ret(reinterpret_cast<const unsigned char*>(accept_source.c_str()), accept_source.length(), digest);
+#else
+  mbedtls_sha1(reinterpret_cast<const unsigned char*>(accept_source.c_str()), accept_source.length(), digest);
+#endif
+  unsigned char expected_accept[29];
+  size_t accept_length = 0;
+  mbedtls_base64_encode(expected_accept, sizeof(expected_accept), &accept_length, digest, sizeof(digest));
+  
+  String line;
+  if (!read_line(line) || !line.startsWith("HTTP/1.1 101")) {
+    Log.errorln("Websocket handshake rejected: %s", line.c_str());
+    return false;
+  }
+  
+  bool accepted = false;
+  String extensions;
+  while (read_line(line) && line.length() > 0) {
+    int colon = line.indexOf(':');
+    if (colon < 0) {
+      continue;
+    }
+    String name = line.substring(0, colon);
+    String value = line.substring(colon + 1);
+    name.toLowerCase();
+    value.trim();
+    if (name == "sec-websocket-accept") {
+      accepted = value == reinterpret_cast<const char*>(expected_accept);
+    } else if (name == "sec-websocket-extensions") {
+      extensions = value;
+    }
+  }
+  if (!accepted) {
+    Log.errorln("Websocket handshake failed: bad Sec-WebSocket-Accept");
+    return false;
+  }
+  
+  _stats.deflate = false;
+  if (extensions.length() == 0) {
+    if (_offer_deflate) {
+      Log.infoln("Server declined permessage-deflate, messages are uncompressed");
+    }
+    return true;
+  }
+  
+  // Accepted parameters: the window must fit the buffer we asked for; the
+  // client_* parameters only concern compressing, which we never do
+  uint8_t window_bits = 15;
+  bool no_context_takeover = false;
+  bool valid = _offer_deflate && extensions.startsWith("permessage-deflate");
+  int start = extensions.indexOf(';');
+  while (valid && start >= 0) {
+    int end = extensions.indexOf(';', start + 1);
+    String parameter = extensions.substring(start + 1, end < 0 ? extensions.length() : end);
+    parameter.trim();
+    if (parameter.startsWith("server_max_window_bits=")) {
+      window_bits = parameter.substring(23).toInt();
+    } else if (parameter == "server_no_context_takeover") {
+      no_context_takeover = true;
+    } else if (!parameter.startsWith("client_max_window_bits") && parameter != "client_no_context_takeover") {
+      valid = false;
+    }
+    start = end;
+  }
+  if (!valid || window_bits < 8 || window_bits > WS_INFLATE_WINDOW_BITS) {
+    // Retry without the offer rather than accept an unbounded window
+    Log.warningln("Unusable websocket extension response '%s', reconnecting uncompressed", extensions.c_str());
+    _offer_deflate = false;
+    return false;
+  }
+  
+  delete _inflater;
+  _inflater = new Inflater(window_bits);
+  _no_context_takeover = no_context_takeover;
+  _stats.deflate = true;
+  Log.infoln("permessage-deflate active: %d byte window%s", _inflater->window_size(),
+             no_context_takeover ? ", no context takeover" : "");
+  return true;
+}
+
+bool WebsocketClient::send(const String& text) {
+  if (!_open) {
+    return false;
+  }
+  return send_frame(WS_OPCODE_TEXT, reinterpret_cast<const uint8_t*>(text.c_str()), text.length());
+}
+
+bool WebsocketClient::send_batch(const std::vector<String>& texts) {
+  if (!_open) {
+    return false;
+  }
+  for (const String& text : texts) {
+    append_frame(WS_OPCODE_TEXT, reinterpret_cast<const uint8_t*>(text.c_str()), text.length());
+  }
+  return flush_frames();
+}
+
+void WebsocketClient::close() {
+  if (!_open) {
+    return;
+  }
+  uint8_t code[2] = { WS_CLOSE_NORMAL >> 8, WS_CLOSE_NORMAL & 0xFF };
+  send_frame(WS_OPCODE_CLOSE, code, sizeof(code));
+  transport_stop();
+  closed();
+}
+
+bool WebsocketClient::available() {
+  return _open && transport_connected();
+}
+
+void WebsocketClient::poll() {
+  while (_open && transport_available() >= 2) {
+    if (!read_frame()) {
+      return;
+    }
+  }
+  
+  if (_open && !transport_connected()) {
+    fail(0, "connection lost");
+  }
+}
+
+bool WebsocketClient::wait_for_data(uint32_t timeout_ms) {
+  // Bytes already buffered by WiFiClient or decrypted by TLS don't wake select()
+  if (_open && transport_available() >= 2) {
+    return true;
+  }
+  
+  int fd = _open ? _tcp.fd() : -1;
+  if (fd >= 0) {
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(fd, &readable);
+    struct timeval timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+    int ready = select(fd + 1, &readable, nullptr, nullptr, &timeout);
+    if (ready >= 0) {
+      return ready > 0;
+    }
+  }
+  
+  delay(timeout_ms);
+  return false;
+}
+
+bool WebsocketClient::read_frame() {
+  uint8_t header[10];
+  if (!read_bytes(header, 2)) {
+    fail(0, "connection lost");
+    return false;
+  }
+  bool final = header[0] & 0x80;
+  bool compressed = header[0] & 0x40;
+  uint8_t opcode = header[0] & 0x0F;
+  size_t header_length = 2;
+  uint64_t length = header[1] & 0x7F;
+  
+  if ((header[0] & 0x30) || (header[1] & 0x80)) {
+    // RSV2/RSV3 are unused; servers must not mask
+    fail(WS_CLOSE_PROTOCOL_ERROR, "invalid frame header");
+    return false;
+  }
+  if (length >= 126) {
+    size_t extra = length == 126 ? 2 : 8;
+    if (!read_bytes(header + 2, extra)) {
+      fail(0, "connection lost");
+      return false;
+    }
+    length = 0;
+    for (size_t i = 0; i < extra; i++) {
+      length = (length << 8) | header[2 + i];
+    }
+    header_length += extra;
+  }
+  
+  // Control frames may arrive between the fragments of a message
+  if (opcode >= WS_OPCODE_CLOSE) {
+    uint8_t payload[125];
+    if (!final || compressed || length > sizeof(payload)) {
+      fail(WS_CLOSE_PROTOCOL_ERROR, "invalid control frame");
+      return false;
+    }
+    if (!read_bytes(payload, length)) {
+      fail(0, "connection lost");
+      return false;
+    }
+    _stats.wire_bytes += header_length + length;
+    
+    if (opcode == WS_OPCODE_PING) {
+      send_frame(WS_OPCODE_PONG, payload, length);
+    } else if (opcode == WS_OPCODE_CLOSE) {
+      Log.infoln("Websocket closed by server");
+      send_frame(WS_OPCODE_CLOSE, payload, length >= 2 ? 2 : 0);
+      transport_stop();
+      closed();
+      return false;
+    }
+    return true;
+  }
+  
+  if (opcode == WS_OPCODE_CONTINUATION) {
+    if (!_receiving || compressed) {
+      fail(WS_CLOSE_PROTOCOL_ERROR, "unexpected continuation frame");
+      return false;
+    }
+  } else if (opcode == WS_OPCODE_TEXT || opcode == WS_OPCODE_BINARY) {
+    if (_receiving || (compressed && !_inflater)) {
+      fail(WS_CLOSE_PROTOCOL_ERROR, "unexpected data frame");
+      return false;
+    }
+    _receiving = true;
+    _compressed = compressed;
+    _message = "";
+    _message_wire_bytes = 0;
+  } else {
+    fail(WS_CLOSE_PROTOCOL_ERROR, "unknown opcode");
+    return false;
+  }
+  
+  if (_message.length() + length > _max_message_bytes) {
+    _message_too_big = true;
+    fail(WS_CLOSE_TOO_BIG, "message too big");
+    return false;
+  }
+  
+  uint8_t chunk[256];
+  size_t remaining = length;
+  while (remaining > 0) {
+    size_t count = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+    if (!read_bytes(chunk, count)) {
+      fail(0, "connection lost");
+      return false;
+    }
+    _message.concat(reinterpret_cast<const char*>(chunk), count);
+    remaining -= count;
+  }
+  _message_wire_bytes += header_length + length;
+  _stats.wire_bytes += header_length + length;
+  
+  if (final) {
+    finish_message();
+  }
+  return true;
+}
+
+void WebsocketClient::finish_message() {
+  _receiving = false;
+  _stats.messages++;
+  
+  if (!_compressed) {
+    _stats.payload_bytes += _message.length();
+    Log.verboseln("WS message: %d bytes on the wire", _message_wire_bytes);
+    if (_on_message) {
+      _on_message(_message);
+    }
+    return;
+  }
+  
+  // The sender strips the empty stored block that ends each message; restore it
+  static const char FLUSH_TAIL[] = { 0x00, 0x00, (char)0xFF, (char)0xFF };
+  _message.concat(FLUSH_TAIL, sizeof(FLUSH_TAIL));
+  
+  String text;
+  unsigned long start = micros();
+  bool inflated = _inflater->inflate(reinterpret_cast<const uint8_t*>(_message.c_str()), _message.length(),
+                                     text, _max_message_bytes);
+  uint32_t elapsed = micros() - start;
+  if (_no_context_takeover) {
+    _inflater->reset();
+  }
+  _message = "";
+  
+  _stats.inflate_us += elapsed;
+  if (elapsed > _stats.inflate_max_us) {
+    _stats.inflate_max_us = elapsed;
+  }
+  if (!inflated && text.length() >= _max_message_bytes) {
+    _message_too_big = true;
+    fail(WS_CLOSE_TOO_BIG, "inflated message too big");
+    return;
+  }
+  if (!inflated) {
+    fail(WS_CLOSE_INVALID_DATA, "invalid compressed message");
+    return;
+  }
+  _stats.payload_bytes += text.length();
+  Log.verboseln("WS message: %d bytes on the wire, %d inflated in %d us",
+                _message_wire_bytes, text.length(), elapsed);
+  
+  if (_on_message) {
+    _on_message(text);
+  }
+}
+
+bool WebsocketClient::send_frame(uint8_t opcode, const uint8_t* data, size_t length) {
+  append_frame(opcode, data, length);
+  return flush_frames();
+}
+
+void WebsocketClient::append_frame(uint8_t opcode, const uint8_t* data, size_t length) {
+  uint8_t header[14];
+  size_t header_length = 2;
+  header[0] = 0x80 | opcode;
+  if (length < 126) {
+    header[1] = 0x80 | length;
+  } else if (length <= 0xFFFF) {
+    header[1] = 0x80 | 126;
+    header[2] = length >> 8;
+    header[3] = length & 0xFF;
+    header_length = 4;
+  } else {
+    header[1] = 0x80 | 127;
+    for (int i = 0; i < 8; i++) {
+      header[2 + i] = i < 4 ? 0 : (length >> ((7 - i) * 8)) & 0xFF;
+    }
+    header_length = 10;
+  }
+  
+  // Client frames are always masked
+  uint32_t mask_value = esp_random();
+  uint8_t* mask = header + header_length;
+  memcpy(mask, &mask_value, 4);
+  header_length += 4;
+  
+  _outgoing.reserve(_outgoing.size() + header_length + length);
+  _outgoing.insert(_outgoing.end(), header, header + header_length);
+  for (size_t i = 0; i < length; i++) {
+    _outgoing.push_back(data[i] ^ mask[i & 3]);
+  }
+}
+
+bool WebsocketClient::flush_frames() {
+  // One write, so a TLS connection wraps the frames in as few records as possible
+  size_t length = _outgoing.size();
+  bool written = length == 0 || transport_write(_outgoing.data(), length) == length;
+  if (written) {
+    _stats.sent_bytes += length;
+  }
+  _outgoing.clear();
+  return written;
+}
+
+bool WebsocketClient::read_line(String& line) {
+  line = "";
+  char c;
+  while (read_bytes(reinterpret_cast<uint8_t*>(&c), 1)) {
+    if (c == '\n') {
+      return true;
+    }
+    if (c != '\r' && line.length() < 512) {
+      line += c;
+    }
+  }
+  return false;
+}
+
+bool WebsocketClient::read_bytes(uint8_t* buffer, size_t length) {
+  unsigned long start = millis();
+  while (length > 0) {
+    int count = transport_read(buffer, length);
+    if (count > 0) {
+      buffer += count;
+      length -= count;
+      continue;
+    }
+    if (!transport_connected() || millis() - start > WS_TIMEOUT_MS) {
+      return false;
+    }
+    delay(1);
+  }
+  return true;
+}
+
+void WebsocketClient::fail(uint16_t code, const char* reason) {
+  Log.errorln("Websocket error: %s", reason);
+  if (code != 0) {
+    uint8_t payload[2] = { (uint8_t)(code >> 8), (uint8_t)(code & 0xFF) };
+    send_frame(WS_OPCODE_CLOSE, payload, sizeof(payload));
+  }
+  transport_stop();
+  closed();
+}
+
+void WebsocketClient::closed() {
+  _open = false;
+  _receiving = false;
+  _message = "";
+  delete _inflater;
+  _inflater = nullptr;
+  _stats.deflate = false;
+  if (_on_event) {
+    _on_event(WebsocketEvent::Closed);
+  }
+}
+
+size_t WebsocketClient::transport_write(const uint8_t* data, size_t length) {
+  return _secure ? _tls.write(data, length) : _tcp.write(data, length);
+}
+
+int WebsocketClient::transport_read(uint8_t* buffer, size_t length) {
+  return _secure ? _tls.read(buffer, length) : _tcp.read(buffer, length);
+}
+
+int WebsocketClient::transport_available() {
+  return _secure ? _tls.available() : _tcp.available();
+}
+
+bool WebsocketClient::transport_connected() {
+  return _secure ? _tls.connected() : _tcp.connected();
+}
+
+void WebsocketClient::transport_stop() {
+  if (_secure) {
+    _tls.stop();
+  } else {
+    _tcp.stop();
+  }
+}
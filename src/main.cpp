@@ -8,24 +8,30 @@
 #include <Adafruit_GFX.h>
 #include <WiFi.h>
 #include <esp_sleep.h>
+#include <esp_pm.h>
 #include <ArduinoJson.h>
 #include <ArduinoLog.h>
-#include <TickTwo.h>
 #include <array>
 #include "time.h"
 #include "ConfigManager.h"
+#include "ConfigSchema.h"
 #include "HassWebsocketManager.h"
 #include "RequestData.h"
 #include "FS.h"
 #include <LittleFS.h>
 #include "DisplayManager.h"
 #include "EPaper213MonoDisplayManager.h"
+#include "EPaper213GrayDisplayManager.h"
 #include "WebConfigServer.h"
 #include "CaptivePortal.h"
 #include <DNSServer.h>
 #include <Adafruit_NeoPixel.h>
 #include "Adafruit_MAX1704X.h"
 #include "DualLogger.h"
+#include "SleepScheduler.h"
+#include "WakeMetrics.h"
+#include "LoopMonitor.h"
+#include "TimerScheduler.h"
 
 // Forward declarations
 void refresh_data_points();
@@ -35,26 +41,40 @@ void start_captive_portal(const String& reason);
 void setLEDPower(bool power_on);
 void setLEDColor(uint8_t r, uint8_t g, uint8_t b);
 void setup_battery();
+void start_battery_probe();
+void wait_for_battery_probe();
 void setup_data_points();
-void register_for_events();
-void data_callback(int request_id, String type, JsonDocument& json_doc);
+void read_data_points_from_cache();
+void data_callback(int request_id, String type, JsonObjectConst json_doc);
+void error_callback(int request_id, String message);
 
-// Global timer pointers - will be initialized in setup() after loading config
-TickTwo* timer_refresh_data_ptr = nullptr;
-TickTwo* timer_update_display_ptr = nullptr;
+// Timers - added in setup() after loading config
+TimerScheduler timers;
+TimerScheduler::TimerId timer_refresh_data = TimerScheduler::INVALID_TIMER;
+TimerScheduler::TimerId timer_update_display = TimerScheduler::INVALID_TIMER;
+TimerScheduler::TimerId timer_ready_for_sleep = TimerScheduler::INVALID_TIMER;
 
 // Power management tracking
 unsigned long last_data_refresh_time = 0;
 bool data_cycle_complete = false;
 bool ready_for_sleep = false;
 
-int alarm_trigger_id = -1;
-
 // Define RTC memory data structure
 RTC_DATA_ATTR int bootCount = 0;
 
+// Picks the deep sleep interval from recent data changes and battery level
+SleepScheduler sleep_scheduler;
+
+// Data points that changed value during this wake (bit per data_points index)
+uint8_t wake_changed_mask = 0;
+
+// Time between the last two websocket polls - the upper bound on how long a
+// received event waited before being processed
+unsigned long last_websocket_poll_time = 0;
+uint32_t websocket_poll_gap_ms = 0;
+
 // Display manager will be initialized in setup()
-EPaper213MonoDisplayManager* display;
+DisplayManager* display;
 
 // Websocket Manager for HASS
 HassWebsocketManager websocket;
@@ -78,6 +98,19 @@ DualLogger dualLog;
 #define NUM_PIXELS 1
 Adafruit_NeoPixel pixel(NUM_PIXELS, PIN_NEOPIXEL);
 
+// Set when waking from deep sleep; the panel still shows the last data, so
+// progress messages would only cost full refreshes
+bool quiet_wake = false;
+
+// Show a progress message, unless this is a routine wake from deep sleep
+void show_status(const String& message, const String& second_line) {
+  if (quiet_wake) {
+    Log.verboseln("%s %s", message.c_str(), second_line.c_str());
+    return;
+  }
+  display->show_message(message, second_line);
+}
+
 // Start the captive portal for WiFi configuration
 void start_captive_portal(const String& reason) {
     Log.infoln("Starting captive portal: %s", reason.c_str());
@@ -102,17 +135,19 @@ void start_captive_portal(const String& reason) {
     captive_portal_mode = true;
 }
 
-void setup_wifi() {
-    // Check if WiFi SSID is defined - go straight to captive portal if not
-    setLEDColor(255, 0, 0); // Red - WiFi disconnected
-    if (config_manager.wifi_ssid.length() == 0 || config_manager.wifi_ssid == "") {
-        start_captive_portal("WiFi Not Configured");
-        return;
+// How long association may take, counted from WiFi.begin()
+#define WIFI_CONNECT_TIMEOUT_MS 20000
+
+unsigned long wifi_started_ms = 0;
+
+// Start associating with the configured network. The WiFi driver does the work
+// in the background; finish_wifi() waits for it. Returns false if no network
+// is configured.
+bool start_wifi() {
+    if (strlen(config_manager.wifi_ssid) == 0) {
+        return false;
     }
     
-    // Show connecting message
-    display->show_message("Connecting to WiFi", "" + config_manager.wifi_ssid);
-    
     // Disconnect if connected
     WiFi.disconnect();
     
@@ -120,21 +155,21 @@ void setup_wifi() {
     WiFi.mode(WIFI_STA);
     
     // Start WiFi connection
-    WiFi.begin(config_manager.wifi_ssid.c_str(), config_manager.wifi_password.c_str());
-    
-    // Wait some time to connect to WiFi
-    int connection_attempts = 0;
-    const int max_attempts = 20; // 20 seconds timeout
-    
-    while (WiFi.status() != WL_CONNECTED && connection_attempts < max_attempts) {
-        Serial.print(".");
-        delay(1000);
-        connection_attempts++;
+    WiFi.begin(config_manager.wifi_ssid, config_manager.wifi_password);
+    wifi_started_ms = millis();
+    return true;
+}
+
+// Wait for the association started by start_wifi(), opening the captive portal
+// if it doesn't complete in time
+void finish_wifi() {
+    while (WiFi.status() != WL_CONNECTED && millis() - wifi_started_ms < WIFI_CONNECT_TIMEOUT_MS) {
+        delay(50);
     }
 
     // Check if connected to WiFi
     if (WiFi.status() != WL_CONNECTED) {
-        Log.errorln("No WiFi Found: %s", config_manager.wifi_ssid.c_str());
+        Log.errorln("No WiFi Found: %s", config_manager.wifi_ssid);
         start_captive_portal("WiFi Failed");
         return;
     }
@@ -143,12 +178,45 @@ void setup_wifi() {
 
     // Successfully connected
     Log.infoln("WiFi connected! IP: %s", WiFi.localIP().toString().c_str());
-    display->show_message("WiFi Connected", WiFi.localIP().toString());
+    show_status("WiFi Connected", WiFi.localIP().toString());
+}
+
+void setup_wifi() {
+    // Check if WiFi SSID is defined - go straight to captive portal if not
+    setLEDColor(255, 0, 0); // Red - WiFi disconnected
+    if (!start_wifi()) {
+        start_captive_portal("WiFi Not Configured");
+        return;
+    }
+    
+    // Show connecting message
+    show_status("Connecting to WiFi", config_manager.wifi_ssid);
+    finish_wifi();
+}
+
+// Stop everything setup() started, show the error and sleep until reset: the
+// device can't run without its filesystem, and retrying would drain the battery
+void halt_on_error(const String& message, const String& second_line) {
+  Log.errorln("%s: %s", message.c_str(), second_line.c_str());
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+  wait_for_battery_probe();
+
+  display->show_message(message, second_line);
+  display->flush();
+  display->sleep();
+  setLEDPower(false);
+
+  // No wakeup source: only the reset button brings it back
+  esp_deep_sleep_start();
 }
 
 // Function declarations for power management
 void enter_deep_sleep();
 void begin_normal_operation();
+void apply_config_changes(uint8_t changes);
+void set_connected_low_power(bool enable);
+void idle_until_next_event();
 void wifi_disconnect_if_needed();
 
 // Primary initialization method when ESP32 boots
@@ -157,24 +225,50 @@ void setup() {
 
   // Increment boot count (for deep sleep wake tracking)
   bootCount++;
+  quiet_wake = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+  wake_metrics.begin(bootCount);
 
-  // Mount filesystem first
-  if(!LittleFS.begin(true)){
-      Serial.println("LittleFS Mount Failed");
-      return;
-  }
-  
   // Initialize logger with log level
   Log.begin(LOG_LEVEL_VERBOSE, &Serial);
   Log.infoln("Device booting (boot count: %d)", bootCount);
-  Log.verboseln("LittleFS Mounted Successfully");
+  loop_monitor.begin();
   
-  // Initialize configuration manager
+  // Boot runs as a small dependency graph rather than in sequence. Config comes
+  // first, since everything else needs it. WiFi association (the slowest
+  // step) then proceeds in the WiFi driver and the fuel gauge probe on its own
+  // task, while this task mounts the filesystem, starts the display and sets
+  // up the data points. Everything joins before normal operation.
+
+  // Initialize configuration manager first - it reads from RTC memory or NVS,
+  // so WiFi settings are available without touching the filesystem
+  wake_metrics.boot_stage_begin(BOOT_CONFIG);
   if (config_manager.begin()) {
-    Log.infoln("Configuration loaded from file");
+    Log.infoln("Configuration loaded");
   } else {
     Log.warningln("Using default configuration");
   }
+  wake_metrics.boot_stage_end(BOOT_CONFIG);
+
+  // Start associating now; the stage ends when an IP address is assigned, which
+  // can happen before start_wifi() returns, so it begins first
+  WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
+    wake_metrics.boot_stage_end(BOOT_WIFI);
+  }, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  if (strlen(config_manager.wifi_ssid) > 0) {
+    wake_metrics.boot_stage_begin(BOOT_WIFI);
+  }
+  bool wifi_started = start_wifi();
+
+  // Fuel gauge probe (I2C, retries for up to 10 s) runs on its own task
+  start_battery_probe();
+  
+  // Mount filesystem (weather icons). A failure is reported once the display is up.
+  wake_metrics.boot_stage_begin(BOOT_FILESYSTEM);
+  bool filesystem_mounted = LittleFS.begin(true);
+  if (filesystem_mounted) {
+    Log.verboseln("LittleFS Mounted Successfully");
+  }
+  wake_metrics.boot_stage_end(BOOT_FILESYSTEM);
   
   // Wait for serial if needed
   if (config_manager.wait_for_serial) {
@@ -193,24 +287,51 @@ void setup() {
   setLEDColor(255, 0, 0); // Start with red (disconnected)
   Log.verboseln("Neopixel set to red");
 #endif
-
-  setup_battery();
   
-  // Create display manager
+  // Create display manager (build with -D DISPLAY_GRAYSCALE for the 4-level panel)
+  wake_metrics.boot_stage_begin(BOOT_DISPLAY);
+#ifdef DISPLAY_GRAYSCALE
+  display = new EPaper213GrayDisplayManager();
+#else
   display = new EPaper213MonoDisplayManager();
+#endif
   
   // Initialize display
   display->begin();
+  wake_metrics.boot_stage_end(BOOT_DISPLAY);
+
+  if (!filesystem_mounted) {
+    halt_on_error("Storage Error", "LittleFS mount failed");
+  }
   
   // Initialize timers with config values
-  timer_refresh_data_ptr = new TickTwo([]() { refresh_data_points(); }, 
-                                    config_manager.data_refresh_seconds * 1000, 0, MILLIS);
-  timer_update_display_ptr = new TickTwo([]() { update_display(); }, 
-                                   config_manager.data_wait_ms, 1, MILLIS);
-    
-  display->show_message("Connecting...", "WiFi: " + config_manager.wifi_ssid);
+  timer_refresh_data = timers.add([]() { refresh_data_points(); },
+                                  config_manager.data_refresh_seconds * 1000, 0);
+  timer_update_display = timers.add([]() { update_display(); },
+                                    config_manager.data_wait_ms, 1);
+  // Gives pending work a moment to finish after a display update
+  timer_ready_for_sleep = timers.add([]() {
+    ready_for_sleep = true;
+    Log.verboseln("Device ready for sleep");
+  }, 5000, 1);
+
+  // Data points only need the config
+  wake_metrics.boot_stage_begin(BOOT_DATA_POINTS);
+  setup_data_points();
+  wake_metrics.boot_stage_end(BOOT_DATA_POINTS);
+
+  // The first display update shows the battery level
+  wait_for_battery_probe();
 
-  setup_wifi();
+  if (!wifi_started) {
+    start_captive_portal("WiFi Not Configured");
+    return;
+  }
+  // Association has often finished by now, saving this refresh
+  if (WiFi.status() != WL_CONNECTED) {
+    show_status("Connecting...", String("WiFi: ") + config_manager.wifi_ssid);
+  }
+  finish_wifi();
 
   Log.infoln("IP Address: %s", WiFi.localIP().toString().c_str());
 
@@ -218,76 +339,162 @@ void setup() {
   if (captive_portal_mode) {
     return;
   }
-  display->show_message("Waiting for data", "IP: " + WiFi.localIP().toString());
+  begin_normal_operation();
+  wake_metrics.boot_complete();
+}
 
-  // Setup data points
-  setup_data_points();
+// Connect to Home Assistant and start the data cycle. Runs after WiFi is connected,
+// either during setup() or when the captive portal hands over without a restart.
+void begin_normal_operation() {
+  show_status("Waiting for data", "IP: " + WiFi.localIP().toString());
 
   // Connect via WebSocket to HASS
   websocket.setMessageCallback(data_callback);
-  websocket.connect(config_manager.hass_url.c_str(), config_manager.hass_token.c_str());
+  websocket.setErrorCallback(error_callback);
+  websocket.set_certificate_fingerprint(config_manager.hass_cert_fingerprint);
+  websocket.connect(config_manager.hass_url, config_manager.hass_token);
+
+  // Stay connected at low power instead of deep sleeping if configured
+  set_connected_low_power(config_manager.connected_low_power);
 
   // Set color to Green when connected.
   setLEDColor(0, 255, 0);
   
   // Run the refresh_data action every X seconds (from config)
   refresh_data_points();
-  timer_refresh_data_ptr->start();
-
-  // Check to see if we should register for events
-  if (config_manager.listen_for_events) {
-    register_for_events();
-  }
+  timers.start(timer_refresh_data);
   
   // Initialize web configuration server
-  web_config_server = new WebConfigServer(config_manager);
-  web_config_server->begin();
+  if (!web_config_server) {
+    web_config_server = new WebConfigServer(config_manager, display);
+    web_config_server->begin();
+  }
 
   setLEDPower(false);
 }
 
+// Reconfigure the subsystems affected by a saved configuration change in place,
+// instead of paying for a full restart
+void apply_config_changes(uint8_t changes) {
+  if (changes == CONFIG_APPLY_NONE) {
+    return;
+  }
+  Log.infoln("Applying configuration changes (flags 0x%x)", changes);
+
+  if (changes & CONFIG_APPLY_REBOOT) {
+    Log.infoln("Some changes will take effect after the next restart");
+  }
+
+  if (changes & CONFIG_APPLY_TIMERS) {
+    timers.set_interval(timer_refresh_data, config_manager.data_refresh_seconds * 1000);
+    timers.set_interval(timer_update_display, config_manager.data_wait_ms);
+    Log.verboseln("Timers updated: refresh %d s, display delay %d ms",
+                  config_manager.data_refresh_seconds, config_manager.data_wait_ms);
+  }
+
+  if (changes & CONFIG_APPLY_WEBSOCKET) {
+    // Subscriptions don't survive a new connection, so re-request everything
+    websocket.disconnect();
+    websocket.set_certificate_fingerprint(config_manager.hass_cert_fingerprint);
+    websocket.connect(config_manager.hass_url, config_manager.hass_token);
+    changes |= CONFIG_APPLY_DATA_POINTS;
+  }
+
+  if (changes & CONFIG_APPLY_DATA_POINTS) {
+    setup_data_points();
+    refresh_data_points();
+  }
+
+  if (changes & CONFIG_APPLY_DISPLAY) {
+    update_display(true);
+  }
+
+  if (changes & CONFIG_APPLY_POWER_MODE) {
+    set_connected_low_power(config_manager.connected_low_power);
+  }
+}
+
 void loop() {
+  loop_monitor.begin_iteration();
+
   // Check if we're in captive portal mode
   if (captive_portal_mode) {
     // Process captive portal requests
     if (captive_portal) {
+      loop_monitor.begin_section(LOOP_PORTAL);
       captive_portal->handle_client();
       
-      // Check if WiFi configuration completed and restart requested
-      if (captive_portal->should_restart()) {
-        Log.infoln("WiFi configuration completed, restarting device...");
+      // Once WiFi is configured, hand over to normal operation without a restart
+      if (captive_portal->config_saved()) {
+        Log.infoln("WiFi configuration completed, connecting...");
+        if (display) {
+          display->show_message("Setup Complete", String("Connecting to: ") + config_manager.wifi_ssid);
+        }
         delay(1000); // Give time for the response to be sent
-        ESP.restart();
+        captive_portal->end();
+        delete captive_portal;
+        captive_portal = nullptr;
+        captive_portal_mode = false;
+
+        // setup_wifi() re-opens the portal if the new settings don't work
+        setup_wifi();
+        if (!captive_portal_mode) {
+          setup_data_points();
+          begin_normal_operation();
+        }
       }
+      loop_monitor.end_section();
     }
     
     return; // Skip the rest of the loop when in captive portal mode
   }
   
   // Normal operation mode
-  if (!websocket.available()) {
+  loop_monitor.begin_section(LOOP_WEBSOCKET);
+  if (!websocket.available() && !websocket.backing_off()) {
     Log.infoln("Websocket was not connected -- attempting to reconnect.");
-    websocket.connect(config_manager.hass_url.c_str(), config_manager.hass_token.c_str());
+    websocket.connect(config_manager.hass_url, config_manager.hass_token);
   }
 
+  unsigned long poll_time = millis();
+  websocket_poll_gap_ms = poll_time - last_websocket_poll_time;
+  last_websocket_poll_time = poll_time;
   websocket.loop();
+  loop_monitor.end_section();
+  wake_metrics.record_websocket(websocket.stats());
+  wake_metrics.record_connection(websocket.connection_stats());
+  wake_metrics.record_loop(loop_monitor.stats());
+  wake_metrics.publish();
 
-  // Handle web configuration requests
+  // Web configuration requests are served on the HTTP server task
   if (web_config_server) {
-    web_config_server->handle_client();
-    
+    loop_monitor.begin_section(LOOP_WEB_SERVER);
+    // Save and apply posted configuration changes in place
+    apply_config_changes(web_config_server->take_pending_changes());
+
     // Check if restart was requested
     if (web_config_server->should_restart()) {
       Log.infoln("Restart requested via web interface, restarting device...");
       display->show_message("Restarting...", "Config updated");
+      display->flush();
       delay(2000); // Give time for the response to be sent
       ESP.restart();
     }
+    loop_monitor.end_section();
   }
 
-  // Update timers if they exist
-  if (timer_refresh_data_ptr) timer_refresh_data_ptr->update();
-  if (timer_update_display_ptr) timer_update_display_ptr->update();
+  // Run due timers
+  loop_monitor.begin_section(LOOP_TIMERS);
+  timers.update();
+  loop_monitor.end_section();
+  
+  // Connected low-power mode keeps the websocket alive and idles until the next event
+  if (config_manager.connected_low_power) {
+    loop_monitor.begin_section(LOOP_IDLE);
+    idle_until_next_event();
+    loop_monitor.end_section();
+    return;
+  }
   
   // Power management - check if we should go to sleep
   if (config_manager.enable_deep_sleep && data_cycle_complete && ready_for_sleep) {
@@ -326,6 +533,42 @@ void setup_battery() {
   Log.warningln("Unable to find battery chip.");
 }
 
+// Signalled by the battery probe task when found_battery is set
+SemaphoreHandle_t battery_probe_done = nullptr;
+
+void battery_probe_task(void* parameter) {
+  setup_battery();
+  wake_metrics.boot_stage_end(BOOT_BATTERY);
+  xSemaphoreGive(battery_probe_done);
+  vTaskDelete(nullptr);
+}
+
+// Probe for the fuel gauge on a separate task, so boot doesn't wait on its retries
+void start_battery_probe() {
+  wake_metrics.boot_stage_begin(BOOT_BATTERY);
+  battery_probe_done = xSemaphoreCreateBinary();
+  if (battery_probe_done &&
+      xTaskCreate(battery_probe_task, "battery_probe", 4096, nullptr, 1, nullptr) == pdPASS) {
+    return;
+  }
+
+  Log.warningln("Battery probe task unavailable, probing inline");
+  setup_battery();
+  wake_metrics.boot_stage_end(BOOT_BATTERY);
+  if (battery_probe_done) {
+    xSemaphoreGive(battery_probe_done);
+  }
+}
+
+void wait_for_battery_probe() {
+  if (!battery_probe_done) {
+    return;
+  }
+  xSemaphoreTake(battery_probe_done, portMAX_DELAY);
+  vSemaphoreDelete(battery_probe_done);
+  battery_probe_done = nullptr;
+}
+
 void setLEDColor(uint8_t r, uint8_t g, uint8_t b) {
     pixel.setPixelColor(0, pixel.Color(r, g, b));
     pixel.show();
@@ -350,25 +593,78 @@ std::array<RequestData, 3> data_points;
 
 RequestData data_temperature, data_conditions, data_alarm_state;
 
+// Latest data point values, kept in RTC memory across deep sleep. Restoring them
+// on wake means unchanged values don't register as changes and trigger a refresh.
+struct PersistedDataPoint {
+  char name[16];
+  char value[48];
+};
+RTC_DATA_ATTR PersistedDataPoint rtc_data_points[3];
+
+// Save the latest values before entering deep sleep
+void persist_data_points() {
+  for (size_t i = 0; i < data_points.size(); i++) {
+    strlcpy(rtc_data_points[i].name, data_points[i].name.c_str(), sizeof(rtc_data_points[i].name));
+    strlcpy(rtc_data_points[i].value, data_points[i].latest_value.c_str(), sizeof(rtc_data_points[i].value));
+  }
+}
+
+// Seed data points with the values shown before deep sleep
+void restore_data_points() {
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED) {
+    return;
+  }
+
+  for (RequestData& data : data_points) {
+    for (const PersistedDataPoint& persisted : rtc_data_points) {
+      if (persisted.name[0] != '\0' && data.name == persisted.name) {
+        data.latest_value = persisted.value;
+        data.has_value_changed = false;
+        Log.verboseln("Restored %s = %s from RTC memory", persisted.name, persisted.value);
+      }
+    }
+  }
+}
+
 void setup_data_points() {
   data_temperature.name = DATA_TEMPERATURE;
-  data_temperature.templateStr = String("{{ state_attr('") + config_manager.weather_entity_id + String("', 'temperature') }}");
+  data_temperature.entity_id = config_manager.weather_entity_id;
+  data_temperature.attribute = "temperature";
 
   data_conditions.name = DATA_CONDITIONS;
-  data_conditions.templateStr = String("{{ states('") + config_manager.weather_entity_id + String("') }}");
+  data_conditions.entity_id = config_manager.weather_entity_id;
 
   // Only set up alarm data point if entity is configured
   data_alarm_state.name = DATA_ALARM;
-  if (config_manager.alarm_entity_id.length() > 0) {
-    data_alarm_state.templateStr = String("{{ states('") + config_manager.alarm_entity_id + String("') }}");
+  if (strlen(config_manager.alarm_entity_id) > 0) {
+    data_alarm_state.entity_id = config_manager.alarm_entity_id;
   } else {
-    // Empty template will result in no API request being made
-    data_alarm_state.templateStr = "";
+    // No entity means the value is never requested
+    data_alarm_state.entity_id = "";
     data_alarm_state.latest_value = "";
     Log.infoln("No alarm entity configured, skipping alarm data");
   }
 
   data_points = { data_temperature, data_conditions, data_alarm_state };
+
+  // Track exactly these values; the next refresh subscribes to the new set
+  EntityStateCache& cache = websocket.entity_cache();
+  cache.clear();
+  for (const RequestData& data : data_points) {
+    if (data.entity_id.length() > 0) {
+      cache.track(data.entity_id, data.attribute);
+    }
+  }
+  if (websocket.entities_subscription() > 0) {
+    websocket.subscribe_entities();
+  }
+
+  // Only the first setup after a wake restores values; later calls follow config changes
+  static bool restored = false;
+  if (!restored) {
+    restore_data_points();
+    restored = true;
+  }
 }
 
 void refresh_data_points() {
@@ -383,17 +679,19 @@ void refresh_data_points() {
     // Reconnect to Home Assistant WebSocket if needed
     if (!websocket.available()) {
       Log.infoln("Reconnecting WebSocket");
-      websocket.connect(config_manager.hass_url.c_str(), config_manager.hass_token.c_str());
+      websocket.connect(config_manager.hass_url, config_manager.hass_token);
       delay(1000); // Give some time to establish the connection
     }
   }
   
-  // Request data from Home Assistant
-  for (RequestData& data : data_points) {
-    // Only request data if template string is not empty
-    if (data.templateStr.length() > 0) {
-      data.pending_request_id = websocket.render_template(data.templateStr);
-    }
+  // Entity states arrive as subscribe_entities diffs, so there is nothing to
+  // poll once subscribed: a cold start costs one snapshot, later changes only
+  // small diffs. Re-read the cache so the display cycle still completes.
+  if (websocket.entities_subscription() < 0) {
+    websocket.subscribe_entities();
+  } else {
+    read_data_points_from_cache();
+    timers.start(timer_update_display);
   }
   
   // Record the time of this data refresh
@@ -401,6 +699,20 @@ void refresh_data_points() {
   data_cycle_complete = false;
 }
 
+// Copy the cached entity values into the data points
+void read_data_points_from_cache() {
+  const EntityStateCache& cache = websocket.entity_cache();
+  for (size_t i = 0; i < data_points.size(); i++) {
+    RequestData& data = data_points[i];
+    String value;
+    if (data.entity_id.length() > 0 && cache.get(data.entity_id, data.attribute, value)) {
+      if (data.update_value(value)) {
+        wake_changed_mask |= 1 << i;
+      }
+    }
+  }
+}
+
 String get_data_value(String name) {
     for (RequestData& data : data_points) {
         if (data.name == name) {
@@ -411,39 +723,33 @@ String get_data_value(String name) {
     return "---";
 }
 
-void data_callback(int request_id, String type, JsonDocument& json_doc) {
+void data_callback(int request_id, String type, JsonObjectConst json_doc) {
   if (type == "event") {
-    // Check if it matches a subscription
-    if (request_id == alarm_trigger_id) {
-      // Alarm state was changed.
-      String new_state = json_doc["event"]["variables"]["trigger"]["to_state"]["state"];
-      if (new_state.length() > 0) {
-        Log.verboseln("Alarm state changed to %s", new_state);
-        data_alarm_state.latest_value = new_state;
-
-        // Update screen after a short delay
-        if (timer_update_display_ptr) timer_update_display_ptr->start();
-      }
-      return;
-    }
+    wake_metrics.record_event(websocket_poll_gap_ms);
 
-    // Otherwise see if it matches a request we made
-    for (RequestData& data : data_points) {
-      if (request_id == data.pending_request_id) {
-        String new_value = json_doc["event"]["result"];
-        Log.infoln("Updating data %s with new value %s", data.name, new_value);
-        data.update_value(new_value);
+    // Entity snapshot or diff (the alarm included), already applied to the cache
+    if (request_id == websocket.entities_subscription()) {
+      read_data_points_from_cache();
 
-        // Triger an update within a delay
-        if (timer_update_display_ptr) timer_update_display_ptr->start();
-        return;
+      // Update the screen within a delay: always while a refresh is waiting
+      // for its data, and for changes pushed between refreshes if enabled
+      if (!data_cycle_complete || config_manager.listen_for_events) {
+        timers.start(timer_update_display);
       }
+      return;
     }
   }
 
   Log.warningln("Unprocessed data response: %d", request_id);
 }
 
+// A request failed: rejected by Home Assistant, or queued until auth_ok and
+// then dropped by auth_invalid or a lost connection
+// (A failed entity subscription is renewed by the next refresh.)
+void error_callback(int request_id, String message) {
+  Log.errorln("Home Assistant request %d failed: %s", request_id, message.c_str());
+}
+
 void update_display() {
   update_display(false);
 }
@@ -457,46 +763,50 @@ void update_display(bool force_refresh) {
       float battery_percent = maxlipo.cellPercent();
       if (battery_percent > 100.0) battery_percent = 100.0;
       battery_level = String(battery_percent, 1) + "%";
+      wake_metrics.current.battery_percent = battery_percent;
+      wake_metrics.current.battery_rate_percent_per_hour = maxlipo.chargeRate();
       Log.verboseln("Battery percentage: %s", battery_level);
     } else {
       Log.verboseln("No battery detected");
     }
+    loop_monitor.begin_section(LOOP_DISPLAY);
     display->update_display(data_points, force_refresh, battery_level);
+    loop_monitor.end_section();
     
     // Mark data cycle as complete after we've updated the display
     data_cycle_complete = true;
     
     // Set ready_for_sleep flag to true after a short delay
     // This gives time for any pending processes to complete
-    TickTwo* sleep_timer = new TickTwo([]() { 
-      ready_for_sleep = true; 
-      Log.verboseln("Device ready for sleep");
-    }, 5000, 1, MILLIS);
-    
-    sleep_timer->start();
+    ready_for_sleep = false;
+    timers.start(timer_ready_for_sleep);
   }
 }
 
-// Register to receive events from Home Assistant
-void register_for_events() {
-  // Only register for alarm state changes if an entity is configured
-  if (config_manager.alarm_entity_id.length() > 0) {
-    alarm_trigger_id = websocket.subscribe_to_trigger(String("{ \"platform\": \"state\", \"to\": null, \"entity_id\": \"") + config_manager.alarm_entity_id + String("\"}"));
-    Log.infoln("Registered for alarm state changes: %s", config_manager.alarm_entity_id.c_str());
-  } else {
-    Log.infoln("No alarm entity configured, skipping event registration");
-    alarm_trigger_id = -1;
-  }
-}
-
-
-
 // Power management functions
 
 // Enter deep sleep mode
 void enter_deep_sleep() {
+  // Pick the interval from how much the data has been changing and the battery level
+  float battery_percent = -1;
+  if (found_battery) {
+    battery_percent = min(maxlipo.cellPercent(), 100.0f);
+  }
+  sleep_scheduler.record_wake(wake_changed_mask);
+  uint32_t sleep_seconds = sleep_scheduler.next_interval_seconds(config_manager, battery_percent);
+
+  wake_metrics.current.sleep_interval_s = sleep_seconds;
+  wake_metrics.current.data_volatility = sleep_scheduler.volatility();
+  wake_metrics.current.battery_percent = battery_percent;
+  strlcpy(wake_metrics.current.sleep_reason, sleep_scheduler.reason(), sizeof(wake_metrics.current.sleep_reason));
+  wake_metrics.log_summary();
+  wake_metrics.finish();
+
   // Calculate sleep time in microseconds
-  uint64_t sleep_time_us = config_manager.sleep_duration_minutes * 60 * 1000000ULL;
+  uint64_t sleep_time_us = sleep_seconds * 1000000ULL;
+  
+  // Keep the latest values so the next wake can skip an unchanged refresh
+  persist_data_points();
   
   // Prepare display for sleep
   if (display) {
@@ -510,13 +820,60 @@ void enter_deep_sleep() {
   wifi_disconnect_if_needed();
   
   // Enable wake up timer
-  Log.infoln("Going to sleep for %d minutes...", config_manager.sleep_duration_minutes);
+  Log.infoln("Going to sleep for %d seconds...", sleep_seconds);
   esp_sleep_enable_timer_wakeup(sleep_time_us);
   
   // Enter deep sleep
   esp_deep_sleep_start();
 }
 
+// Name of the active power mode, reported in the wake metrics
+const char* power_mode_name() {
+  if (config_manager.connected_low_power) return "connected_low_power";
+  if (config_manager.enable_deep_sleep) return "deep_sleep";
+  return "always_on";
+}
+
+// Connected low-power mode: DTIM-based WiFi modem sleep keeps the Home Assistant
+// websocket alive, and automatic light sleep lets the chip sleep whenever loop()
+// blocks in idle_until_next_event(). Light sleep needs power management and
+// tickless idle in the framework build; without it only modem sleep applies.
+void set_connected_low_power(bool enable) {
+  strlcpy(wake_metrics.current.power_mode, power_mode_name(), sizeof(wake_metrics.current.power_mode));
+
+  if (enable) {
+    WiFi.setSleep(WIFI_PS_MIN_MODEM);
+  }
+
+  esp_pm_config_esp32s3_t pm_config;
+  pm_config.max_freq_mhz = getCpuFrequencyMhz();
+  pm_config.min_freq_mhz = enable ? getXtalFrequencyMhz() : pm_config.max_freq_mhz;
+  pm_config.light_sleep_enable = enable;
+  esp_err_t err = esp_pm_configure(&pm_config);
+  if (err != ESP_OK) {
+    Log.warningln("Automatic light sleep unavailable (%s), using modem sleep only", esp_err_to_name(err));
+  }
+
+  Log.infoln("Connected low-power mode %s", enable ? "enabled" : "disabled");
+}
+
+// Block until the next timer is due or Home Assistant sends something, bounded by
+// low_power_poll_ms (web requests are served on their own task). While blocked,
+// FreeRTOS idle can put the chip into automatic light sleep.
+void idle_until_next_event() {
+  uint32_t wait_ms = timers.ms_until_next(config_manager.low_power_poll_ms);
+  if (wait_ms == 0) {
+    return;
+  }
+
+  unsigned long start = millis();
+  if (websocket.wait_for_data(wait_ms)) {
+    // The data arrived just now, not when the socket was last polled
+    last_websocket_poll_time = millis();
+  }
+  wake_metrics.current.idle_ms += millis() - start;
+}
+
 // Disconnect from WiFi if connected
 void wifi_disconnect_if_needed() {
   if (WiFi.status() == WL_CONNECTED) {
@@ -0,0 +1,17 @@
+#ifndef TEST_SHIM_ARDUINO_H
+#define TEST_SHIM_ARDUINO_H
+
+// Minimal Arduino core for the native unit tests (env:native_test). millis()
+// only moves when a test sets fake_millis, so wrap-around can be tested.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using std::max;
+using std::min;
+
+inline uint32_t fake_millis = 0;
+inline unsigned long millis() { return fake_millis; }
+
+#endif // TEST_SHIM_ARDUINO_H
@@ -0,0 +1,16 @@
+#ifndef TEST_SHIM_ARDUINO_LOG_H
+#define TEST_SHIM_ARDUINO_LOG_H
+
+// Logging is compiled out of the unit tests
+
+class Logging {
+public:
+  template <class... Args> void errorln(Args...) {}
+  template <class... Args> void warningln(Args...) {}
+  template <class... Args> void infoln(Args...) {}
+  template <class... Args> void verboseln(Args...) {}
+};
+
+inline Logging Log;
+
+#endif // TEST_SHIM_ARDUINO_LOG_H
@@ -0,0 +1,8 @@
+#ifndef TEST_SHIM_ESP_ATTR_H
+#define TEST_SHIM_ESP_ATTR_H
+
+// Plain memory on the host; a "reset" is a new object in the same process
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+#endif // TEST_SHIM_ESP_ATTR_H
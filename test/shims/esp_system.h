@@ -0,0 +1,22 @@
+#ifndef TEST_SHIM_ESP_SYSTEM_H
+#define TEST_SHIM_ESP_SYSTEM_H
+
+// Reset reason set by the test to simulate the boot after a reset
+typedef enum {
+  ESP_RST_UNKNOWN,
+  ESP_RST_POWERON,
+  ESP_RST_EXT,
+  ESP_RST_SW,
+  ESP_RST_PANIC,
+  ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT,
+  ESP_RST_WDT,
+  ESP_RST_DEEPSLEEP,
+  ESP_RST_BROWNOUT,
+  ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+inline esp_reset_reason_t fake_reset_reason = ESP_RST_POWERON;
+inline esp_reset_reason_t esp_reset_reason() { return fake_reset_reason; }
+
+#endif // TEST_SHIM_ESP_SYSTEM_H
@@ -0,0 +1,73 @@
+#ifndef TEST_SHIM_ESP_TIMER_H
+#define TEST_SHIM_ESP_TIMER_H
+
+// Fake esp_timer: time only moves through fake_esp_timer.advance(), which
+// also fires the one-shot timer when its deadline passes. Starting a running
+// timer or stopping an idle one fails as on the device.
+
+#include <cstdint>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_ERR_INVALID_STATE 0x103
+
+typedef struct esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void* arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char* name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+struct FakeEspTimer {
+  int64_t now_us = 0;
+  esp_timer_cb_t callback = nullptr;
+  void* arg = nullptr;
+  bool armed = false;
+  int64_t deadline_us = 0;
+  uint32_t starts = 0;
+
+  void advance(int64_t us) {
+    now_us += us;
+    if (armed && now_us >= deadline_us) {
+      armed = false;
+      callback(arg);
+    }
+  }
+};
+
+inline FakeEspTimer fake_esp_timer;
+
+inline int64_t esp_timer_get_time() { return fake_esp_timer.now_us; }
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  fake_esp_timer.callback = args->callback;
+  fake_esp_timer.arg = args->arg;
+  fake_esp_timer.armed = false;
+  *handle = reinterpret_cast<esp_timer_handle_t>(&fake_esp_timer);
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t handle, uint64_t timeout_us) {
+  if (fake_esp_timer.armed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  fake_esp_timer.armed = true;
+  fake_esp_timer.deadline_us = fake_esp_timer.now_us + timeout_us;
+  fake_esp_timer.starts++;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_stop(esp_timer_handle_t handle) {
+  if (!fake_esp_timer.armed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  fake_esp_timer.armed = false;
+  return ESP_OK;
+}
+
+#endif // TEST_SHIM_ESP_TIMER_H
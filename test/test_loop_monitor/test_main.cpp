@@ -0,0 +1,167 @@
+// LoopMonitor against a fake esp_timer: the watchdog is armed per section with
+// that section's budget, re-armed for the parent when a nested section ends,
+// never armed while idle (so light sleep is not interrupted), and a section
+// still over budget when the chip resets is reported on the next boot.
+#include <unity.h>
+#include <esp_system.h>
+#include "LoopMonitor.h"
+
+extern uint32_t rtc_loop_blocked;
+
+namespace {
+
+const int64_t MS = 1000;
+
+}  // namespace
+
+void setUp() {
+  fake_esp_timer = FakeEspTimer();
+  fake_esp_timer.now_us = 1;
+  fake_reset_reason = ESP_RST_POWERON;
+  rtc_loop_blocked = 0;
+}
+
+void tearDown() {
+}
+
+void test_section_armed_with_its_budget() {
+  LoopMonitor monitor;
+  monitor.begin();
+  monitor.begin_iteration();
+
+  monitor.begin_section(LOOP_WEBSOCKET);
+  TEST_ASSERT_TRUE(fake_esp_timer.armed);
+  TEST_ASSERT_EQUAL_INT64(fake_esp_timer.now_us + LoopMonitor::section_budget_ms(LOOP_WEBSOCKET) * MS,
+                          fake_esp_timer.deadline_us);
+  fake_esp_timer.advance(10 * MS);
+  monitor.end_section();
+  TEST_ASSERT_FALSE(fake_esp_timer.armed);
+  TEST_ASSERT_EQUAL_UINT32(0, rtc_loop_blocked);
+}
+
+void test_idle_never_armed() {
+  LoopMonitor monitor;
+  monitor.begin();
+  monitor.begin_iteration();
+
+  monitor.begin_section(LOOP_IDLE);
+  TEST_ASSERT_FALSE(fake_esp_timer.armed);
+  fake_esp_timer.advance(60000 * MS);
+  monitor.end_section();
+  TEST_ASSERT_EQUAL_UINT32(0, fake_esp_timer.starts);
+  TEST_ASSERT_EQUAL_UINT32(0, rtc_loop_blocked);
+
+  // Idle inside a budgeted section stops the timer and the section is watched
+  // again, with a fresh budget, once idle ends
+  monitor.begin_section(LOOP_WEB_SERVER);
+  TEST_ASSERT_TRUE(fake_esp_timer.armed);
+  monitor.begin_section(LOOP_IDLE);
+  TEST_ASSERT_FALSE(fake_esp_timer.armed);
+  fake_esp_timer.advance(60000 * MS);
+  monitor.end_section();
+  TEST_ASSERT_TRUE(fake_esp_timer.armed);
+  TEST_ASSERT_EQUAL_INT64(fake_esp_timer.now_us + LoopMonitor::section_budget_ms(LOOP_WEB_SERVER) * MS,
+                          fake_esp_timer.deadline_us);
+  monitor.end_section();
+  TEST_ASSERT_FALSE(fake_esp_timer.armed);
+
+  // Idle time is not part of the iteration time
+  monitor.begin_iteration();
+  TEST_ASSERT_EQUAL_UINT32(0, monitor.stats().max_ms);
+}
+
+void test_nested_section_rearms_parent() {
+  LoopMonitor monitor;
+  monitor.begin();
+  monitor.begin_iteration();
+
+  monitor.begin_section(LOOP_TIMERS);
+  fake_esp_timer.advance(200 * MS);
+  monitor.begin_section(LOOP_DISPLAY);
+  TEST_ASSERT_EQUAL_INT64(fake_esp_timer.now_us + LoopMonitor::section_budget_ms(LOOP_DISPLAY) * MS,
+                          fake_esp_timer.deadline_us);
+
+  // The display section may take longer than the timers budget...
+  fake_esp_timer.advance(800 * MS);
+  monitor.end_section();
+  TEST_ASSERT_EQUAL_UINT32(0, rtc_loop_blocked);
+
+  // ...and the timers section gets a fresh budget from here
+  TEST_ASSERT_TRUE(fake_esp_timer.armed);
+  TEST_ASSERT_EQUAL_INT64(fake_esp_timer.now_us + LoopMonitor::section_budget_ms(LOOP_TIMERS) * MS,
+                          fake_esp_timer.deadline_us);
+  fake_esp_timer.advance(10 * MS);
+  monitor.end_section();
+
+  // Time in the nested section counts only towards it
+  const LoopStats& stats = monitor.stats();
+  TEST_ASSERT_EQUAL_UINT32(800, stats.sections[LOOP_DISPLAY].total_ms);
+  TEST_ASSERT_EQUAL_UINT32(210, stats.sections[LOOP_TIMERS].total_ms);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.sections[LOOP_TIMERS].overruns);
+}
+
+void test_overrun_marked_then_cleared() {
+  LoopMonitor monitor;
+  monitor.begin();
+  monitor.begin_iteration();
+
+  monitor.begin_section(LOOP_WEBSOCKET);
+  fake_esp_timer.advance(600 * MS);
+  TEST_ASSERT_EQUAL_UINT32(LOOP_WEBSOCKET, rtc_loop_blocked & 0xFF);
+  TEST_ASSERT_TRUE(rtc_loop_blocked != 0);
+
+  // The section returned after all: counted as an overrun, no longer blocked
+  monitor.end_section();
+  TEST_ASSERT_EQUAL_UINT32(0, rtc_loop_blocked);
+  TEST_ASSERT_EQUAL_UINT32(1, monitor.stats().sections[LOOP_WEBSOCKET].overruns);
+  TEST_ASSERT_EQUAL_UINT8(LOOP_WEBSOCKET, monitor.stats().last_overrun_section);
+  TEST_ASSERT_EQUAL_UINT32(600, monitor.stats().last_overrun_ms);
+}
+
+void test_blocked_section_reported_after_watchdog_reset() {
+  LoopMonitor monitor;
+  monitor.begin();
+  monitor.begin_iteration();
+  monitor.begin_section(LOOP_DISPLAY);
+  fake_esp_timer.advance(1500 * MS);
+
+  // The task watchdog resets the chip before the section returns
+  fake_reset_reason = ESP_RST_TASK_WDT;
+  LoopMonitor after_reset;
+  TEST_ASSERT_EQUAL_UINT8(LOOP_SECTION_COUNT, after_reset.stats().reset_section);
+  after_reset.begin();
+  TEST_ASSERT_EQUAL_UINT8(LOOP_DISPLAY, after_reset.stats().reset_section);
+  TEST_ASSERT_EQUAL_UINT32(0, rtc_loop_blocked);
+
+  // Reported once: the next boot starts clean
+  LoopMonitor next_boot;
+  next_boot.begin();
+  TEST_ASSERT_EQUAL_UINT8(LOOP_SECTION_COUNT, next_boot.stats().reset_section);
+}
+
+void test_blocked_section_ignored_after_other_resets() {
+  LoopMonitor monitor;
+  monitor.begin();
+  monitor.begin_iteration();
+  monitor.begin_section(LOOP_PORTAL);
+  fake_esp_timer.advance(500 * MS);
+  TEST_ASSERT_TRUE(rtc_loop_blocked != 0);
+
+  // A power cycle or deliberate restart is not the section's fault
+  fake_reset_reason = ESP_RST_SW;
+  LoopMonitor after_reset;
+  after_reset.begin();
+  TEST_ASSERT_EQUAL_UINT8(LOOP_SECTION_COUNT, after_reset.stats().reset_section);
+  TEST_ASSERT_EQUAL_UINT32(0, rtc_loop_blocked);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_section_armed_with_its_budget);
+  RUN_TEST(test_idle_never_armed);
+  RUN_TEST(test_nested_section_rearms_parent);
+  RUN_TEST(test_overrun_marked_then_cleared);
+  RUN_TEST(test_blocked_section_reported_after_watchdog_reset);
+  RUN_TEST(test_blocked_section_ignored_after_other_resets);
+  return UNITY_END();
+}
@@ -0,0 +1,196 @@
+// TimerScheduler against a fake millis(): firing, repeats, the 32-bit wrap,
+// and a randomized run checked against a brute-force model of the timers.
+#include <unity.h>
+#include <cstdlib>
+#include "TimerScheduler.h"
+
+namespace {
+
+uint32_t fired[TimerScheduler::MAX_TIMERS];
+
+void fire0() { fired[0]++; }
+void fire1() { fired[1]++; }
+void fire2() { fired[2]++; }
+void fire3() { fired[3]++; }
+
+const TimerScheduler::Callback CALLBACKS[TimerScheduler::MAX_TIMERS] = { fire0, fire1, fire2, fire3 };
+
+// Advance the fake clock one millisecond at a time, updating on each tick
+void run_for(TimerScheduler& timers, uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    fake_millis++;
+    timers.update();
+  }
+}
+
+}  // namespace
+
+void setUp() {
+  fake_millis = 1000;
+  memset(fired, 0, sizeof(fired));
+}
+
+void tearDown() {
+}
+
+void test_add_claims_fixed_slots() {
+  TimerScheduler timers;
+  for (uint8_t i = 0; i < TimerScheduler::MAX_TIMERS; i++) {
+    TEST_ASSERT_EQUAL(i, timers.add(CALLBACKS[i], 100, 0));
+  }
+  TEST_ASSERT_EQUAL(TimerScheduler::INVALID_TIMER, timers.add(fire0, 100, 0));
+  TEST_ASSERT_EQUAL(TimerScheduler::INVALID_TIMER, TimerScheduler().add(nullptr, 100, 0));
+
+  // Added timers stay stopped until start()
+  uint32_t deadline;
+  TEST_ASSERT_FALSE(timers.next_deadline(deadline));
+  TEST_ASSERT_FALSE(timers.running(0));
+  TEST_ASSERT_EQUAL_UINT32(5000, timers.ms_until_next(5000));
+}
+
+void test_repeats_then_stops() {
+  TimerScheduler timers;
+  TimerScheduler::TimerId once = timers.add(fire0, 50, 1);
+  TimerScheduler::TimerId three = timers.add(fire1, 20, 3);
+  TimerScheduler::TimerId forever = timers.add(fire2, 30, 0);
+  timers.start(once);
+  timers.start(three);
+  timers.start(forever);
+
+  run_for(timers, 49);
+  TEST_ASSERT_EQUAL_UINT32(0, fired[0]);
+  run_for(timers, 1);
+  TEST_ASSERT_EQUAL_UINT32(1, fired[0]);
+  TEST_ASSERT_FALSE(timers.running(once));
+
+  run_for(timers, 250);
+  TEST_ASSERT_EQUAL_UINT32(1, fired[0]);
+  TEST_ASSERT_EQUAL_UINT32(3, fired[1]);
+  TEST_ASSERT_FALSE(timers.running(three));
+  TEST_ASSERT_EQUAL_UINT32(10, fired[2]);
+  TEST_ASSERT_TRUE(timers.running(forever));
+
+  // start() restarts the countdown and the repeat count
+  timers.start(three);
+  run_for(timers, 100);
+  TEST_ASSERT_EQUAL_UINT32(6, fired[1]);
+
+  timers.stop(forever);
+  run_for(timers, 100);
+  TEST_ASSERT_EQUAL_UINT32(13, fired[2]);
+}
+
+void test_deadlines_across_millis_wrap() {
+  fake_millis = 0xFFFFFFFFu - 100;
+  TimerScheduler timers;
+  TimerScheduler::TimerId late = timers.add(fire0, 300, 1);
+  TimerScheduler::TimerId early = timers.add(fire1, 50, 0);
+  timers.start(late);
+  timers.start(early);
+
+  // The earlier deadline is still before the wrap, the later one after it
+  uint32_t deadline;
+  TEST_ASSERT_TRUE(timers.next_deadline(deadline));
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu - 50, deadline);
+  TEST_ASSERT_EQUAL_UINT32(50, timers.ms_until_next(1000));
+
+  run_for(timers, 150);
+  TEST_ASSERT_EQUAL_UINT32(49, fake_millis);
+  TEST_ASSERT_EQUAL_UINT32(3, fired[1]);
+  TEST_ASSERT_EQUAL_UINT32(0, fired[0]);
+  TEST_ASSERT_EQUAL_UINT32(50, timers.ms_until_next(1000));
+
+  timers.stop(early);
+  TEST_ASSERT_EQUAL_UINT32(150, timers.ms_until_next(1000));
+  run_for(timers, 149);
+  TEST_ASSERT_EQUAL_UINT32(0, fired[0]);
+  run_for(timers, 1);
+  TEST_ASSERT_EQUAL_UINT32(1, fired[0]);
+  TEST_ASSERT_FALSE(timers.next_deadline(deadline));
+}
+
+// Random start/stop/set_interval/update calls, with the clock starting just
+// before the wrap; after every call the heap must agree with a plain list
+void test_randomized_against_model() {
+  struct Model {
+    bool running;
+    uint32_t deadline;
+    uint32_t interval;
+    uint16_t repeats;
+    uint16_t remaining;
+    uint32_t fired;
+  };
+
+  srand(12345);
+  fake_millis = 0xFFFFFFFFu - 20000;
+  TimerScheduler timers;
+  Model model[TimerScheduler::MAX_TIMERS] = {};
+  for (uint8_t i = 0; i < TimerScheduler::MAX_TIMERS; i++) {
+    model[i].interval = 1 + rand() % 500;
+    model[i].repeats = rand() % 4;
+    TEST_ASSERT_EQUAL(i, timers.add(CALLBACKS[i], model[i].interval, model[i].repeats));
+  }
+
+  for (int step = 0; step < 20000; step++) {
+    TimerScheduler::TimerId id = rand() % TimerScheduler::MAX_TIMERS;
+    Model& timer = model[id];
+    switch (rand() % 6) {
+      case 0:
+        timers.start(id);
+        timer.running = true;
+        timer.remaining = timer.repeats;
+        timer.deadline = fake_millis + timer.interval;
+        break;
+      case 1:
+        timers.stop(id);
+        timer.running = false;
+        break;
+      case 2:
+        timer.interval = rand() % 500;
+        timers.set_interval(id, timer.interval);
+        break;
+      default: {
+        fake_millis += rand() % 300;
+        timers.update();
+        for (Model& due : model) {
+          if (!due.running || (int32_t)(fake_millis - due.deadline) < 0) {
+            continue;
+          }
+          due.fired++;
+          if (due.repeats > 0 && --due.remaining == 0) {
+            due.running = false;
+          } else {
+            due.deadline = fake_millis + max(due.interval, (uint32_t)1);
+          }
+        }
+        break;
+      }
+    }
+
+    // Brute-force minimum over the running timers
+    bool any = false;
+    uint32_t earliest = 0;
+    for (uint8_t i = 0; i < TimerScheduler::MAX_TIMERS; i++) {
+      TEST_ASSERT_EQUAL(model[i].running, timers.running(i));
+      TEST_ASSERT_EQUAL_UINT32(model[i].fired, fired[i]);
+      if (model[i].running && (!any || (int32_t)(model[i].deadline - earliest) < 0)) {
+        earliest = model[i].deadline;
+        any = true;
+      }
+    }
+    uint32_t deadline;
+    TEST_ASSERT_EQUAL(any, timers.next_deadline(deadline));
+    if (any) {
+      TEST_ASSERT_EQUAL_UINT32(earliest, deadline);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_add_claims_fixed_slots);
+  RUN_TEST(test_repeats_then_stops);
+  RUN_TEST(test_deadlines_across_millis_wrap);
+  RUN_TEST(test_randomized_against_model);
+  return UNITY_END();
+}